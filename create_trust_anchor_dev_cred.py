@@ -70,53 +70,68 @@ class TrustAnchor(object):
 		# Add '0x' at the very beginning
         self.pubkey_der_hexstring = '0x' + self.pubkey_der_hexstring
 		        
-    def create_c_file(self, filename):
-
-        # remove file (which may or may not exist)
-        try:
-            os.remove(filename)
-        except OSError:
-            pass
-
-        try:
-            self.c_file = open(filename, "wt")
-        except Exception as e:
-            raise Exception("Cannot open {}".format(c_file))
-
-        #write to c file
-        self.c_file.write("// ----------------------------------------------------------------------------\n")
-        self.c_file.write("//   The confidential and proprietary information contained in this file may\n")
-        self.c_file.write("//   only be used by a person authorized under and to the extent permitted\n")
-        self.c_file.write("//   by a subsisting licensing agreement from ARM Limited or its affiliates.\n")
-        self.c_file.write("//\n")
-        self.c_file.write("//          (C)COPYRIGHT 2018 ARM Limited or its affiliates.\n")
-        self.c_file.write("//              ALL RIGHTS RESERVED\n")
-        self.c_file.write("//\n")
-        self.c_file.write("//   This entire notice must be reproduced on all copies of this file\n")
-        self.c_file.write("//   and copies of this file may only be made by a person if such person is\n")
-        self.c_file.write("//   permitted to do so under the terms of a subsisting license agreement\n")
-        self.c_file.write("//   from ARM Limited or its affiliates.\n")
-        self.c_file.write("// ----------------------------------------------------------------------------\n")
-        self.c_file.write("\n")
-        self.c_file.write("#ifndef __" + filename.replace('.', '_').upper() + "__\n")
-        self.c_file.write("#define __" + filename.replace('.', '_').upper() + "__\n")
-        self.c_file.write("\n")
-        self.c_file.write("#include <inttypes.h>\n")
-        self.c_file.write("\n")
-        self.c_file.write("const uint8_t MBED_CLOUD_TRUST_ANCHOR_PK[] = {};\n".format("{\n\t" + '\n\t'.join(self.pubkey_der_hexstring[i:i+48] for i in xrange(0, len(self.pubkey_der_hexstring), 48)) + "\n}"))
-        self.c_file.write("const uint32_t MBED_CLOUD_TRUST_ANCHOR_PK_SIZE = sizeof(MBED_CLOUD_TRUST_ANCHOR_PK);\n")
-        self.c_file.write("\n")
-        self.c_file.write("const char MBED_CLOUD_TRUST_ANCHOR_PK_NAME[] = \"mbed.ta.{}\";\n".format(self.pubkey_name))
-        self.c_file.write("\n")
-        self.c_file.write("#endif // __" + filename.replace('.', '_').upper() + "__\n")
-        self.c_file.close()
+    def c_array(self, var_name):
+        return "const uint8_t {}[] = {};\n".format(var_name, "{\n\t" + '\n\t'.join(self.pubkey_der_hexstring[i:i+48] for i in xrange(0, len(self.pubkey_der_hexstring), 48)) + "\n}")
+
+
+def create_c_file(trust_anchors, filename):
+    """Writes the trust anchor set. The first trust anchor is also exported under the
+    single trust anchor names (MBED_CLOUD_TRUST_ANCHOR_PK, _SIZE and _NAME)."""
+
+    # remove file (which may or may not exist)
+    try:
+        os.remove(filename)
+    except OSError:
+        pass
+
+    try:
+        c_file = open(filename, "wt")
+    except Exception as e:
+        raise Exception("Cannot open {}".format(filename))
+
+    var_names = ["MBED_CLOUD_TRUST_ANCHOR_PK"] + ["MBED_CLOUD_TRUST_ANCHOR_PK_{}".format(i) for i in xrange(1, len(trust_anchors))]
+
+    #write to c file
+    c_file.write("// ----------------------------------------------------------------------------\n")
+    c_file.write("//   The confidential and proprietary information contained in this file may\n")
+    c_file.write("//   only be used by a person authorized under and to the extent permitted\n")
+    c_file.write("//   by a subsisting licensing agreement from ARM Limited or its affiliates.\n")
+    c_file.write("//\n")
+    c_file.write("//          (C)COPYRIGHT 2018 ARM Limited or its affiliates.\n")
+    c_file.write("//              ALL RIGHTS RESERVED\n")
+    c_file.write("//\n")
+    c_file.write("//   This entire notice must be reproduced on all copies of this file\n")
+    c_file.write("//   and copies of this file may only be made by a person if such person is\n")
+    c_file.write("//   permitted to do so under the terms of a subsisting license agreement\n")
+    c_file.write("//   from ARM Limited or its affiliates.\n")
+    c_file.write("// ----------------------------------------------------------------------------\n")
+    c_file.write("\n")
+    c_file.write("#ifndef __" + filename.replace('.', '_').upper() + "__\n")
+    c_file.write("#define __" + filename.replace('.', '_').upper() + "__\n")
+    c_file.write("\n")
+    c_file.write("#include <inttypes.h>\n")
+    c_file.write("\n")
+    for ta, var_name in zip(trust_anchors, var_names):
+        c_file.write("// mbed.ta.{}\n".format(ta.pubkey_name))
+        c_file.write(ta.c_array(var_name))
+        c_file.write("\n")
+    c_file.write("const uint32_t MBED_CLOUD_TRUST_ANCHOR_PK_SIZE = sizeof(MBED_CLOUD_TRUST_ANCHOR_PK);\n")
+    c_file.write("\n")
+    c_file.write("const char MBED_CLOUD_TRUST_ANCHOR_PK_NAME[] = \"mbed.ta.{}\";\n".format(trust_anchors[0].pubkey_name))
+    c_file.write("\n")
+    c_file.write("const uint8_t *const MBED_CLOUD_TRUST_ANCHOR_PKS[] = {{ {} }};\n".format(", ".join(var_names)))
+    c_file.write("const uint32_t MBED_CLOUD_TRUST_ANCHOR_PK_SIZES[] = {{ {} }};\n".format(", ".join("sizeof({})".format(var_name) for var_name in var_names)))
+    c_file.write("const uint32_t MBED_CLOUD_TRUST_ANCHOR_COUNT = {};\n".format(len(trust_anchors)))
+    c_file.write("\n")
+    c_file.write("#endif // __" + filename.replace('.', '_').upper() + "__\n")
+    c_file.close()
 
 def parse_arguments():
     parser = argparse.ArgumentParser(description = 'Generates "{}" file that contains the Trust Anchor name and key value (DER format)'.format(MBED_DEV_CREDENDIAL_FILENAME))
-    parser.add_argument('-t', '--ta_pem_pubkey', help='Trust Anchor public key in PEM format')
-    parser.epilog='Example of use: {} -t "{}"'.format(__file__, "-----BEGIN PUBLIC KEY-----MFkwEwYHKoZIzj0CAQYIKoZIzj0DAQcDQgAEbiRnZgdzoBpySFDPVPFp3J7yOmrOXJ09O5qVUMOD5knUjX4YbQVF0ueJWPy6tkTGbzORAwDzvRXYUA7vZpB+og==-----END PUBLIC KEY-----")
+    parser.add_argument('-t', '--ta_pem_pubkey', action='append', help='Trust Anchor public key in PEM format, repeat for every trust anchor accepted (e.g. old and new key during rotation)')
+    parser.epilog='Example of use: {} -t "{}" [-t <next Trust Anchor>]'.format(__file__, "-----BEGIN PUBLIC KEY-----MFkwEwYHKoZIzj0CAQYIKoZIzj0DAQcDQgAEbiRnZgdzoBpySFDPVPFp3J7yOmrOXJ09O5qVUMOD5knUjX4YbQVF0ueJWPy6tkTGbzORAwDzvRXYUA7vZpB+og==-----END PUBLIC KEY-----")
 
-    if (len(sys.argv)) != 3:
+    if (len(sys.argv) < 3) or (len(sys.argv) % 2 != 1):
         parser.print_help()
         exit(1)
 
@@ -127,9 +142,14 @@ def main():
     try:        
         args = parse_arguments()
     
-        ta = TrustAnchor(args.ta_pem_pubkey)
-        
-        ta.create_c_file(MBED_DEV_CREDENDIAL_FILENAME)
+        trust_anchors = []
+        for pubkey_pem in args.ta_pem_pubkey:
+            ta = TrustAnchor(pubkey_pem)
+            if ta.pubkey_name in [other.pubkey_name for other in trust_anchors]:
+                raise Exception("Trust Anchor mbed.ta.{} given more than once".format(ta.pubkey_name))
+            trust_anchors.append(ta)
+
+        create_c_file(trust_anchors, MBED_DEV_CREDENDIAL_FILENAME)
    
     except Exception, err:
         traceback.print_exc()
@@ -44,6 +44,13 @@ FtcdCommBase *sda_create_comm_interface(void);
 */
 void sda_destroy_comm_interface(void);
 
+/**
+* Brings the communication object back after wait_for_message() or send_response() failed
+* because the network went away. Only network transports implement it.
+* Returns true if the object can be used again.
+*/
+bool sda_recover_comm_interface(FtcdCommBase *comm);
+
 
 #ifdef __cplusplus
 }
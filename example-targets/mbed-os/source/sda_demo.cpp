@@ -20,6 +20,8 @@
 #include "mbed-trace/mbed_trace.h"
 #include "mbed-trace-helper.h"
 #include "mcc_common_setup.h"
+#include "sda_trace_event.h"
+#include "sda_mem_stats.h"
 
 /////////////////////// DEFINITIONS ///////////////////////
 
@@ -74,6 +76,8 @@ static void emulate_operation(const char* operation_name, uint32_t color, size_t
         tr_cmdline("proccess operation %s", operation_name);
     }
 
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_LED, (operation_name ? operation_name : "fault"));
+
     for (size_t i = 0; i < duration_in_sec * 2; i++)
     {
         set_led_color(LED_CL_BLACK);
@@ -83,6 +87,8 @@ static void emulate_operation(const char* operation_name, uint32_t color, size_t
     }
 
     set_led_color(prev_color);
+
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_LED, (operation_name ? operation_name : "fault"));
 }
 
 void demo_setup(void)
@@ -125,5 +131,19 @@ bool demo_callback_restart(void)
 bool demo_callback_diagnostics(void)
 {
     emulate_operation("read", LED_CL_PINK, 5);
+
+#if SDA_MEM_STATS_ENABLED
+    sda_mem_stats_print();
+#endif
+
+    mcc_platform_network_stats_print();
+
+#if (MBED_CONF_APP_TRACE_EVENTS == 1) && (SDA_TRACE_EVENT_STDOUT_IS_LINK != 1)
+    // The response to this request goes out on another channel than stdout
+    printf("%s\n", SDA_TRACE_EVENT_DUMP_BEGIN_MARKER);
+    sda_trace_event_dump(stdout);
+    printf("%s\n", SDA_TRACE_EVENT_DUMP_END_MARKER);
+#endif
+
     return true;
 }
@@ -0,0 +1,82 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_SDA_COAP == 1
+
+#include "mbed.h"
+#include "sda_comm_helper.h"
+#include "sda_comm_coap.h"
+#include "mcc_common_setup.h"
+#include "pal.h"
+#include "mbed-trace/mbed_trace.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP           "sdae"
+
+// How long recovery waits for the network to come back up
+#ifndef SDA_COAP_RECONNECT_TIMEOUT_MS
+#define SDA_COAP_RECONNECT_TIMEOUT_MS 30000
+#endif
+
+//////////////////////////////////////////////////////////
+
+FtcdCommBase *sda_create_comm_interface(void)
+{
+    const uint8_t msg_header_token[] = FTCD_MSG_HEADER_TOKEN_SDA;
+    uint32_t interface_index = 0;
+
+    // The CoAP socket needs the default network interface up and known to PAL
+    if (mcc_platform_init_connection() != 0) {
+        tr_error("Failed connecting the network interface");
+        return NULL;
+    }
+
+    if (pal_registerNetworkInterface(mcc_platform_get_network_interface(), &interface_index) != PAL_SUCCESS) {
+        tr_error("Failed registering the network interface");
+        mcc_platform_close_connection();
+        return NULL;
+    }
+
+    return new FtcdCommCoap(FTCD_COMM_NET_ENDIANNESS_BIG, msg_header_token, true, interface_index, SDA_COAP_PORT);
+}
+
+void sda_destroy_comm_interface(void)
+{
+    mcc_platform_close_connection();
+}
+
+bool sda_recover_comm_interface(FtcdCommBase *comm)
+{
+    Kernel::Clock::time_point start = Kernel::Clock::now();
+
+    tr_warn("SDA transport lost, waiting for the network");
+    if (mcc_platform_interface_wait_up(SDA_COAP_RECONNECT_TIMEOUT_MS) != 0) {
+        tr_error("Network interface did not come back up");
+        return false;
+    }
+
+    if (!static_cast<FtcdCommCoap *>(comm)->reconnect()) {
+        tr_error("Failed reopening the CoAP socket");
+        return false;
+    }
+
+    tr_info("SDA transport recovered in %u ms",
+            (unsigned)std::chrono::duration_cast<std::chrono::milliseconds>(Kernel::Clock::now() - start).count());
+    return true;
+}
+
+#endif // MBED_CONF_APP_SDA_COAP == 1
@@ -14,7 +14,7 @@
 // limitations under the License.
 // ----------------------------------------------------------------------------
 
-#ifdef SDA_SERIAL_INTERFACE
+#if defined(SDA_SERIAL_INTERFACE) && (MBED_CONF_APP_SERIAL_RING != 1) && (MBED_CONF_APP_SDA_COAP != 1)
 
 #include "sda_comm_helper.h"
 #include "ftcd_comm_serial.h"
@@ -29,4 +29,4 @@ void sda_destroy_comm_interface(void)
 {
 }
 
-#endif // SDA_SERIAL_INTERFACE
\ No newline at end of file
+#endif // SDA_SERIAL_INTERFACE && MBED_CONF_APP_SERIAL_RING != 1 && MBED_CONF_APP_SDA_COAP != 1
\ No newline at end of file
@@ -0,0 +1,359 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if defined(SDA_SERIAL_INTERFACE) && (MBED_CONF_APP_SERIAL_RING == 1) && (MBED_CONF_APP_SDA_COAP != 1)
+
+#include <string.h>
+
+#include "mbed.h"
+#include "sda_comm_helper.h"
+#include "sda_ring.h"
+#include "sda_link.h"
+#include "mbed-trace/mbed_trace.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP           "sdae"
+
+#define SERIAL_RING_RX_FLAG   0x1
+#define SERIAL_RING_RX_CHUNK  16    // bytes drained from the UART per interrupt at most
+#define SERIAL_RING_CHAR_BITS 10    // start, 8 data and stop bits
+
+// Characters the UART transmitter holds besides the data register
+#ifdef MBED_CONF_APP_SDA_SERIAL_TX_FIFO
+#define SERIAL_RING_TX_FIFO   MBED_CONF_APP_SDA_SERIAL_TX_FIFO
+#else
+#define SERIAL_RING_TX_FIFO   16
+#endif
+
+// A dedicated UART keeps SDA apart from trace output and may change its rate
+#if defined(MBED_CONF_APP_SDA_SERIAL_TX) && defined(MBED_CONF_APP_SDA_SERIAL_RX)
+#define SERIAL_RING_TX        MBED_CONF_APP_SDA_SERIAL_TX
+#define SERIAL_RING_RX        MBED_CONF_APP_SDA_SERIAL_RX
+#define SERIAL_RING_BAUD      SDA_LINK_BASE_BAUD
+#define SERIAL_RING_MAX_BAUD  SDA_LINK_MAX_BAUD
+#else
+#define SERIAL_RING_TX        CONSOLE_TX
+#define SERIAL_RING_RX        CONSOLE_RX
+#define SERIAL_RING_BAUD      MBED_CONF_PLATFORM_STDIO_BAUD_RATE
+#define SERIAL_RING_MAX_BAUD  MBED_CONF_PLATFORM_STDIO_BAUD_RATE
+#define SERIAL_RING_CONSOLE
+#endif
+
+/**
+* Serial transport fed from the UART RX interrupt.
+*
+* The interrupt drains the UART into a lock-free ring and wakes the reader once per
+* chunk, the reader finds the header token in place and copies the message fields
+* out of the ring in spans.
+*
+* On the console UART trace output keeps going to the same serial line as with
+* FtcdCommSerial. On a dedicated UART the host may negotiate a higher rate, see
+* sda_link.h, every proposal is answered with the base rate on the console.
+*/
+class FtcdCommSerialRing : public FtcdCommBase {
+
+public:
+    FtcdCommSerialRing(ftcd_comm_network_endianness_e network_endianness, const uint8_t *header_token, bool use_signature);
+
+    virtual ~FtcdCommSerialRing();
+
+    virtual bool init(void);
+
+    virtual void finish(void);
+
+    virtual ftcd_comm_status_e is_token_detected(void);
+
+    virtual uint32_t read_message_size(void);
+
+    virtual bool read_message(uint8_t *message_out, size_t message_size);
+
+    virtual bool read_message_signature(uint8_t *sig, size_t sig_size);
+
+    virtual bool send(const uint8_t *data, uint32_t data_size);
+
+private:
+    void _rx_irq(void);
+
+    bool _read(uint8_t *data, size_t data_size);
+
+    bool _wait_rx(void);
+
+    void _link_frame_process(void);
+
+    void _link_send(sda_link_type_e type, uint32_t baud);
+
+    void _baud_set(uint32_t baud);
+
+    void _link_fallback(const char *reason);
+
+    ftcd_comm_network_endianness_e _network_endianness;
+    uint32_t _baud;
+    bool _confirm_pending;                          // switched rate not confirmed by the host yet
+    Kernel::Clock::time_point _confirm_deadline;
+    uint8_t _header_token[FTCD_MSG_HEADER_TOKEN_SIZE];
+    EventFlags _rx_flags;
+    sda_ring_s _ring;
+    uint8_t _ring_buffer[SDA_RING_SIZE];
+    uint32_t _dropped_seen;                         // ring dropped count already reported
+};
+
+///////////////////////// GLOBALS /////////////////////////
+
+// Constructed before main() so it can serve as the console from the first trace on
+static UnbufferedSerial g_sda_serial(SERIAL_RING_TX, SERIAL_RING_RX, SERIAL_RING_BAUD);
+
+//////////////////////////////////////////////////////////
+
+#ifdef SERIAL_RING_CONSOLE
+// Traces and the SDA link share one UART, only this object touches it
+FileHandle *mbed::mbed_override_console(int fd)
+{
+    (void)fd;
+    return &g_sda_serial;
+}
+#endif
+
+FtcdCommSerialRing::FtcdCommSerialRing(ftcd_comm_network_endianness_e network_endianness, const uint8_t *header_token, bool use_signature)
+    : FtcdCommBase(network_endianness, header_token, use_signature), _network_endianness(network_endianness),
+      _baud(SERIAL_RING_BAUD), _confirm_pending(false), _dropped_seen(0)
+{
+    memcpy(_header_token, header_token, sizeof(_header_token));
+    sda_ring_init(&_ring, _ring_buffer, sizeof(_ring_buffer));
+}
+
+FtcdCommSerialRing::~FtcdCommSerialRing()
+{
+}
+
+bool FtcdCommSerialRing::init(void)
+{
+    g_sda_serial.attach(callback(this, &FtcdCommSerialRing::_rx_irq), SerialBase::RxIrq);
+    return FtcdCommBase::init();
+}
+
+void FtcdCommSerialRing::finish(void)
+{
+    g_sda_serial.attach(NULL, SerialBase::RxIrq);
+    FtcdCommBase::finish();
+}
+
+void FtcdCommSerialRing::_rx_irq(void)
+{
+    uint8_t chunk[SERIAL_RING_RX_CHUNK];
+    size_t chunk_size = 0;
+
+    // Empty the hardware FIFO, then publish everything at once
+    while ((chunk_size < sizeof(chunk)) && g_sda_serial.readable()) {
+        g_sda_serial.read(&chunk[chunk_size], 1);
+        chunk_size++;
+    }
+
+    sda_ring_push(&_ring, chunk, chunk_size);
+    _rx_flags.set(SERIAL_RING_RX_FLAG);
+}
+
+bool FtcdCommSerialRing::_read(uint8_t *data, size_t data_size)
+{
+    size_t read_size = 0;
+
+    while (read_size < data_size) {
+        read_size += sda_ring_read(&_ring, &data[read_size], data_size - read_size);
+        if ((read_size < data_size) && !_wait_rx()) {
+            return false;
+        }
+    }
+
+    uint32_t dropped = _ring.dropped;
+    if (dropped != _dropped_seen) {
+        tr_error("Serial RX ring overflow, %u bytes dropped", (unsigned)(dropped - _dropped_seen));
+        _dropped_seen = dropped;
+        return false;
+    }
+
+    return true;
+}
+
+// Waits for the next RX burst, "false" if the rate fell back meanwhile
+bool FtcdCommSerialRing::_wait_rx(void)
+{
+    Kernel::Clock::time_point now;
+
+    if (!_confirm_pending) {
+        _rx_flags.wait_any(SERIAL_RING_RX_FLAG);
+        return true;
+    }
+
+    now = Kernel::Clock::now();
+    if ((now >= _confirm_deadline) ||
+            (_rx_flags.wait_any_for(SERIAL_RING_RX_FLAG, std::chrono::duration_cast<Kernel::Clock::duration_u32>(_confirm_deadline - now)) & osFlagsError)) {
+        _link_fallback("not confirmed");
+        return false;
+    }
+    return true;
+}
+
+void FtcdCommSerialRing::_link_send(sda_link_type_e type, uint32_t baud)
+{
+    uint8_t frame[SDA_LINK_FRAME_SIZE];
+
+    sda_link_frame_write(type, baud, frame);
+    send(frame, sizeof(frame));
+}
+
+void FtcdCommSerialRing::_baud_set(uint32_t baud)
+{
+    // Mbed OS cannot tell when the transmitter is idle. Once the data register accepts a character,
+    // the FIFO and the shift register still hold at most SERIAL_RING_TX_FIFO + 1 characters,
+    // let them all leave at the old rate
+    while (!g_sda_serial.writeable()) {
+    }
+    wait_us((int)(((SERIAL_RING_TX_FIFO + 1) * SERIAL_RING_CHAR_BITS * 1000000ULL) / _baud));
+    g_sda_serial.baud((int)baud);
+    _baud = baud;
+}
+
+void FtcdCommSerialRing::_link_fallback(const char *reason)
+{
+    tr_warn("SDA link at %u baud %s, back to %u baud", (unsigned)_baud, reason, (unsigned)SERIAL_RING_BAUD);
+    _confirm_pending = false;
+    _baud_set(SERIAL_RING_BAUD);
+}
+
+void FtcdCommSerialRing::_link_frame_process(void)
+{
+    uint8_t body[SDA_LINK_BODY_SIZE];
+    sda_link_type_e type;
+    uint32_t baud;
+
+    if (!_read(body, sizeof(body)) || !sda_link_body_parse(body, &type, &baud)) {
+        return;
+    }
+
+    switch (type) {
+        case SDA_LINK_TYPE_PROPOSE:
+            baud = sda_link_baud_select(baud, SERIAL_RING_BAUD, SERIAL_RING_MAX_BAUD);
+            _link_send(SDA_LINK_TYPE_ACCEPT, baud);
+            if (baud != _baud) {
+                _baud_set(baud);
+            }
+            _confirm_pending = (baud != SERIAL_RING_BAUD);
+            _confirm_deadline = Kernel::Clock::now() + std::chrono::milliseconds(SDA_LINK_CONFIRM_TIMEOUT_MS);
+            tr_info("SDA link switched to %u baud", (unsigned)baud);
+            break;
+
+        case SDA_LINK_TYPE_CONFIRM:
+            if (baud == _baud) {
+                _confirm_pending = false;
+                _link_send(SDA_LINK_TYPE_CONFIRMED, _baud);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+ftcd_comm_status_e FtcdCommSerialRing::is_token_detected(void)
+{
+    const uint8_t link_token[] = SDA_LINK_TOKEN;
+    sda_ring_token_scan_s scans[2];
+    int found;
+
+    do {
+        sda_ring_token_scan_init(&scans[0], _header_token, sizeof(_header_token));
+        sda_ring_token_scan_init(&scans[1], link_token, sizeof(link_token));
+
+        while ((found = sda_ring_tokens_scan(&_ring, scans, 2)) < 0) {
+            // Framing errors at a negotiated rate leave bytes that never form a token
+            if ((_baud != SERIAL_RING_BAUD) && ((scans[0].consumed - scans[0].matched) > SDA_LINK_GARBAGE_LIMIT)) {
+                _link_fallback("unreadable");
+                sda_ring_token_scan_init(&scans[0], _header_token, sizeof(_header_token));
+                sda_ring_token_scan_init(&scans[1], link_token, sizeof(link_token));
+            }
+            _wait_rx();
+        }
+
+        if (found == 1) {
+            _link_frame_process();
+        }
+    } while (found != 0);
+
+    // An SDA message made it through at this rate
+    _confirm_pending = false;
+    return FTCD_COMM_STATUS_SUCCESS;
+}
+
+uint32_t FtcdCommSerialRing::read_message_size(void)
+{
+    uint8_t size_bytes[sizeof(uint32_t)];
+
+    if (!_read(size_bytes, sizeof(size_bytes))) {
+        return 0;
+    }
+
+    if (_network_endianness == FTCD_COMM_NET_ENDIANNESS_LITTLE) {
+        return ((uint32_t)size_bytes[3] << 24) | ((uint32_t)size_bytes[2] << 16) | ((uint32_t)size_bytes[1] << 8) | size_bytes[0];
+    }
+    return ((uint32_t)size_bytes[0] << 24) | ((uint32_t)size_bytes[1] << 16) | ((uint32_t)size_bytes[2] << 8) | size_bytes[3];
+}
+
+bool FtcdCommSerialRing::read_message(uint8_t *message_out, size_t message_size)
+{
+    if (message_out == NULL) {
+        return false;
+    }
+    return _read(message_out, message_size);
+}
+
+bool FtcdCommSerialRing::read_message_signature(uint8_t *sig, size_t sig_size)
+{
+    if (sig == NULL) {
+        return false;
+    }
+    return _read(sig, sig_size);
+}
+
+bool FtcdCommSerialRing::send(const uint8_t *data, uint32_t data_size)
+{
+    uint32_t sent = 0;
+
+    if (data == NULL) {
+        return false;
+    }
+
+    while (sent < data_size) {
+        ssize_t written = g_sda_serial.write(&data[sent], data_size - sent);
+
+        if (written <= 0) {
+            return false;
+        }
+        sent += (uint32_t)written;
+    }
+    return true;
+}
+
+FtcdCommBase *sda_create_comm_interface(void)
+{
+    const uint8_t msg_header_token[] = FTCD_MSG_HEADER_TOKEN_SDA;
+    return new FtcdCommSerialRing(FTCD_COMM_NET_ENDIANNESS_BIG, msg_header_token, true);
+}
+
+void sda_destroy_comm_interface(void)
+{
+}
+
+#endif // SDA_SERIAL_INTERFACE && MBED_CONF_APP_SERIAL_RING == 1 && MBED_CONF_APP_SDA_COAP != 1
@@ -29,5 +29,9 @@ const uint32_t MBED_CLOUD_TRUST_ANCHOR_PK_SIZE = sizeof(MBED_CLOUD_TRUST_ANCHOR_
 
 const char     MBED_CLOUD_TRUST_ANCHOR_PK_NAME[] = "";
 
+const uint8_t *const MBED_CLOUD_TRUST_ANCHOR_PKS[] = { MBED_CLOUD_TRUST_ANCHOR_PK };
+const uint32_t MBED_CLOUD_TRUST_ANCHOR_PK_SIZES[] = { sizeof(MBED_CLOUD_TRUST_ANCHOR_PK) };
+const uint32_t MBED_CLOUD_TRUST_ANCHOR_COUNT = 1;
+
 
 #endif //__MBED_CLOUD_TRUST_ANCHOR_CREDENTIALS_H__
@@ -0,0 +1,132 @@
+#!/usr/bin/env python
+# ----------------------------------------------------------------------------
+# Copyright 2021 ARM Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------------------------------------------------------
+
+# Benchmark regression gate.
+#
+# Extracts the Google Benchmark JSON report printed by an application built with
+# "benchmark" enabled from a serial log, and compares the median (p50) time of
+# every benchmark with a stored baseline. Exits with 1 when any benchmark got
+# slower than the baseline by more than the threshold.
+
+from __future__ import print_function
+
+import sys
+import json
+import argparse
+import traceback
+
+REPORT_BEGIN_MARKER = '---- sda-bench-json-begin ----'
+REPORT_END_MARKER = '---- sda-bench-json-end ----'
+DEFAULT_THRESHOLD_PERCENT = 10.0
+
+
+def extract_report(log_path):
+    with open(log_path, 'r') as log_file:
+        log = log_file.read()
+
+    begin = log.rfind(REPORT_BEGIN_MARKER)
+    if begin < 0:
+        # Already a plain JSON report
+        return json.loads(log)
+
+    end = log.find(REPORT_END_MARKER, begin)
+    if end < 0:
+        raise ValueError('Benchmark report in "{}" is truncated'.format(log_path))
+
+    return json.loads(log[begin + len(REPORT_BEGIN_MARKER):end])
+
+
+def medians(report):
+    """Returns {run_name: median real time in ns}.
+    Reports without repetitions only carry iteration entries, their time is used as is."""
+    result = {}
+    for bench in report['benchmarks']:
+        if bench.get('run_type') == 'aggregate':
+            if bench.get('aggregate_name') == 'median':
+                result[bench['run_name']] = float(bench['real_time'])
+        elif 'repetitions' not in bench or int(bench['repetitions']) <= 1:
+            result.setdefault(bench['run_name'], float(bench['real_time']))
+    return result
+
+
+def compare(baseline, current, threshold_percent):
+    failures = 0
+
+    print('{:<56} {:>14} {:>14} {:>9}'.format('benchmark', 'baseline(ns)', 'current(ns)', 'change'))
+    for name in sorted(baseline):
+        if name not in current:
+            print('{:<56} {:>14.3f} {:>14} {:>9}'.format(name, baseline[name], '-', 'MISSING'))
+            failures += 1
+            continue
+
+        base = baseline[name]
+        cur = current[name]
+        change = ((cur - base) * 100.0 / base) if base > 0 else 0.0
+        regressed = change > threshold_percent
+        if regressed:
+            failures += 1
+        print('{:<56} {:>14.3f} {:>14.3f} {:>+8.1f}%{}'.format(name, base, cur, change, '  REGRESSION' if regressed else ''))
+
+    for name in sorted(set(current) - set(baseline)):
+        print('{:<56} {:>14} {:>14.3f} {:>9}'.format(name, '-', current[name], 'NEW'))
+
+    return failures
+
+
+def parse_arguments():
+    parser = argparse.ArgumentParser(description='Compares on-target benchmark results against a baseline and fails on p50 regressions')
+    parser.add_argument('log', help='Serial log (or plain JSON report) of a "benchmark" enabled run')
+    parser.add_argument('-b', '--baseline', required=True, help='Baseline JSON report')
+    parser.add_argument('-t', '--threshold', type=float, default=DEFAULT_THRESHOLD_PERCENT,
+                        help='Allowed median slow down in percent (default: {})'.format(DEFAULT_THRESHOLD_PERCENT))
+    parser.add_argument('-w', '--write-baseline', action='store_true',
+                        help='Store the report of the log as the new baseline instead of comparing')
+    parser.epilog = 'Example of use: {} serial.log -b bench_baseline_K64F.json -t 5'.format(__file__)
+
+    return parser.parse_args()
+
+
+def main():
+    try:
+        args = parse_arguments()
+
+        report = extract_report(args.log)
+
+        if args.write_baseline:
+            with open(args.baseline, 'w') as baseline_file:
+                json.dump(report, baseline_file, indent=2)
+            print('Baseline with {} benchmarks written to "{}"'.format(len(medians(report)), args.baseline))
+            return 0
+
+        with open(args.baseline, 'r') as baseline_file:
+            baseline = medians(json.load(baseline_file))
+
+        failures = compare(baseline, medians(report), args.threshold)
+        if failures:
+            print('{} benchmark(s) regressed more than {}% or are missing'.format(failures, args.threshold))
+            return 1
+
+        print('No regression over {}%'.format(args.threshold))
+        return 0
+
+    except Exception:
+        traceback.print_exc()
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -17,8 +17,9 @@
 #ifndef MBED_CLOUD_CLIENT_USER_CONFIG_H
 #define MBED_CLOUD_CLIENT_USER_CONFIG_H
 
-// Defines to pass MbedCloudClientConfigCheck.h checks (the values are meaningless)
+// Defines to pass MbedCloudClientConfigCheck.h checks
 
+// Also the block size of the CoAP SDA transport, see sda_comm_coap.h
 #define SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE                             512
 
 #endif /* MBED_CLOUD_CLIENT_USER_CONFIG_H */
@@ -156,6 +156,11 @@ int mcc_platform_storage_init(void)
     return 0;
 }
 
+int mcc_platform_storage_wait(void)
+{
+    return 0;
+}
+
 
 int mcc_platform_init(void)
 {
@@ -194,3 +199,7 @@ void mcc_platform_reboot(void)
     pal_osReboot();
 }
 
+void mcc_platform_network_stats_print(void)
+{
+    // Link statistics are not available on this platform
+}
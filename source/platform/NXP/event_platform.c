@@ -30,11 +30,39 @@
 
 #ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
 #include "sdhc_config.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include "event_platform_stats.h"
+#if (configUSE_TICKLESS_IDLE == 2)
+#include "fsl_lptmr.h"
+#endif
 
 /*******************************************************************************
  * Definitons
  ******************************************************************************/
 
+/*! @brief An event, a binary semaphore given from the SDHC interrupt. */
+typedef SemaphoreHandle_t event_instance_t;
+
+#if (configUSE_TICKLESS_IDLE == 2)
+/*! @brief The low power timer counts the 1 kHz LPO, one count per millisecond. */
+#define EVENT_LPTMR_MAX_MILLISECONDS (0xFFFFU)
+
+/*! @brief Shorter idle periods are not worth stopping the tick for. */
+#define EVENT_LPTMR_MIN_MILLISECONDS (2U)
+
+/*! @brief SysTick clock, as the port configures it. */
+#ifdef configSYSTICK_CLOCK_HZ
+#define EVENT_SYSTICK_CLOCK_HZ ((uint64_t)configSYSTICK_CLOCK_HZ)
+#else
+#define EVENT_SYSTICK_CLOCK_HZ ((uint64_t)configCPU_CLOCK_HZ)
+#endif
+
+/*! @brief SysTick counts in one RTOS tick. */
+#define EVENT_SYSTICK_COUNTS_PER_TICK ((uint32_t)(EVENT_SYSTICK_CLOCK_HZ / configTICK_RATE_HZ))
+#endif
+
 /*******************************************************************************
  * Prototypes
  ******************************************************************************/
@@ -43,37 +71,182 @@
  * @param eventType The event type
  * @return The event instance's pointer.
  */
-static volatile uint32_t *EVENT_GetInstance(event_t eventType);
+static event_instance_t *EVENT_GetInstance(event_t eventType);
 
 /*******************************************************************************
  * Variables
  ******************************************************************************/
 /*! @brief Transfer complete event. */
-static volatile uint32_t g_eventTransferComplete;
+static event_instance_t g_eventTransferComplete;
 
 /*! @brief SD ready event */
-static volatile uint32_t g_eventSDReady;
+static event_instance_t g_eventSDReady;
 
-/*! @brief Time variable unites as milliseconds. */
-static volatile uint32_t g_timeMilliseconds;
+/*! @brief Time spent blocked in EVENT_Wait(). */
+static event_platform_stats_t g_eventStats;
+
+#if (configUSE_TICKLESS_IDLE == 2)
+/*! @brief The low power timer is set up, the tick may be suppressed. */
+static volatile bool g_lptmrReady;
+#endif
 
 /*******************************************************************************
  * Code
  ******************************************************************************/
 void EVENT_InitTimer(void)
 {
-    /* Set systick reload value to generate 1ms interrupt */
-    SysTick_Config(CLOCK_GetFreq(kCLOCK_CoreSysClk) / 1000U);
+    /* Timeouts are counted in RTOS ticks, SysTick belongs to the RTOS */
+#if (configUSE_TICKLESS_IDLE == 2)
+    lptmr_config_t lptmrConfig;
+
+    if (g_lptmrReady)
+    {
+        return;
+    }
+
+    /* One-shot wakeup for the idle periods the RTOS runs without its tick */
+    LPTMR_GetDefaultConfig(&lptmrConfig);
+    lptmrConfig.prescalerClockSource = kLPTMR_PrescalerClock_1;
+    lptmrConfig.bypassPrescaler = true;
+    LPTMR_Init(LPTMR0, &lptmrConfig);
+    LPTMR_EnableInterrupts(LPTMR0, kLPTMR_TimerInterruptEnable);
+    EnableIRQ(LPTMR0_IRQn);
+    g_lptmrReady = true;
+#endif
 }
 
-void SysTick_Handler(void)
+#if (configUSE_TICKLESS_IDLE == 2)
+void LPTMR0_IRQHandler(void)
 {
-    g_timeMilliseconds++;
+    /* The wakeup itself is all that is needed, vPortSuppressTicksAndSleep() accounts for it */
+    LPTMR_ClearStatusFlags(LPTMR0, kLPTMR_TimerCompareFlag);
 }
 
-static volatile uint32_t *EVENT_GetInstance(event_t eventType)
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
 {
-    volatile uint32_t *event;
+    TickType_t modifiableIdleTime;
+    TickType_t completeTicks;
+    uint64_t sleepCounts;
+    uint64_t elapsedCounts;
+    uint32_t countsLeft;
+    uint32_t sleepMilliseconds;
+    uint32_t sleptMilliseconds;
+
+    if (!g_lptmrReady || ((((uint64_t)xExpectedIdleTime * 1000U) / configTICK_RATE_HZ) < EVENT_LPTMR_MIN_MILLISECONDS))
+    {
+        return;
+    }
+
+    /* Follows the SysTick tickless idle of the FreeRTOS Cortex-M ports, with
+     * the low power timer ending the sleep instead of a long SysTick period. */
+    __disable_irq();
+    __DSB();
+    __ISB();
+
+    /* A task may have been readied since the idle task decided to sleep */
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+    {
+        /* Leave no wakeup behind for the next idle period */
+        LPTMR_StopTimer(LPTMR0);
+        NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+        __enable_irq();
+        return;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+    {
+        /* The tick ran out while being stopped, the RTOS takes it first */
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        __enable_irq();
+        return;
+    }
+
+    /* The rest of the running tick is carried over, not rounded away */
+    countsLeft = SysTick->VAL;
+    if (countsLeft == 0U)
+    {
+        countsLeft = EVENT_SYSTICK_COUNTS_PER_TICK;
+    }
+
+    /* The next timeout, an EVENT_Wait() one included, ends the idle period */
+    sleepCounts = countsLeft + ((uint64_t)EVENT_SYSTICK_COUNTS_PER_TICK * (xExpectedIdleTime - 1U));
+    sleepMilliseconds = (uint32_t)((sleepCounts * 1000U) / EVENT_SYSTICK_CLOCK_HZ);
+    if (sleepMilliseconds > EVENT_LPTMR_MAX_MILLISECONDS)
+    {
+        sleepMilliseconds = EVENT_LPTMR_MAX_MILLISECONDS;
+    }
+    if (sleepMilliseconds < EVENT_LPTMR_MIN_MILLISECONDS)
+    {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        __enable_irq();
+        return;
+    }
+
+    LPTMR_SetTimerPeriod(LPTMR0, sleepMilliseconds);
+    LPTMR_StartTimer(LPTMR0);
+
+    /* Any interrupt wakes the core, the SDHC one as well as the timer. With
+     * interrupts masked their handlers run only once the tick is restarted. */
+    modifiableIdleTime = xExpectedIdleTime;
+    configPRE_SLEEP_PROCESSING(modifiableIdleTime);
+    if (modifiableIdleTime > 0U)
+    {
+        __DSB();
+        __WFI();
+        __ISB();
+    }
+    configPOST_SLEEP_PROCESSING(xExpectedIdleTime);
+
+    if (LPTMR_GetStatusFlags(LPTMR0) & kLPTMR_TimerCompareFlag)
+    {
+        sleptMilliseconds = sleepMilliseconds;
+    }
+    else
+    {
+        sleptMilliseconds = LPTMR_GetCurrentTimerCount(LPTMR0);
+    }
+    /* Stopping clears the count and the compare flag */
+    LPTMR_StopTimer(LPTMR0);
+    NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+
+    elapsedCounts = ((uint64_t)sleptMilliseconds * EVENT_SYSTICK_CLOCK_HZ) / 1000U;
+    if (elapsedCounts < countsLeft)
+    {
+        completeTicks = 0U;
+        countsLeft -= (uint32_t)elapsedCounts;
+    }
+    else
+    {
+        elapsedCounts -= countsLeft;
+        completeTicks = (TickType_t)(1U + (elapsedCounts / EVENT_SYSTICK_COUNTS_PER_TICK));
+        countsLeft = EVENT_SYSTICK_COUNTS_PER_TICK - (uint32_t)(elapsedCounts % EVENT_SYSTICK_COUNTS_PER_TICK);
+    }
+
+    /* The tick handler takes the last expected tick, it unblocks the task */
+    if (completeTicks >= xExpectedIdleTime)
+    {
+        completeTicks = xExpectedIdleTime - 1U;
+        countsLeft = 2U;
+    }
+
+    /* Run the rest of the current tick, then full periods again */
+    SysTick->LOAD = countsLeft - 1U;
+    SysTick->VAL = 0U;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = EVENT_SYSTICK_COUNTS_PER_TICK - 1U;
+
+    vTaskStepTick(completeTicks);
+    g_eventStats.idle_periods++;
+    g_eventStats.idle_ms += sleptMilliseconds;
+
+    __enable_irq();
+}
+#endif
+
+static event_instance_t *EVENT_GetInstance(event_t eventType)
+{
+    event_instance_t *event;
 
     switch (eventType)
     {
@@ -93,12 +266,20 @@ static volatile uint32_t *EVENT_GetInstance(event_t eventType)
 
 bool EVENT_Create(event_t eventType)
 {
-    volatile uint32_t *event = EVENT_GetInstance(eventType);
+    event_instance_t *event = EVENT_GetInstance(eventType);
 
     if (event)
     {
-        *event = 0;
-        return true;
+        if (*event == NULL)
+        {
+            *event = xSemaphoreCreateBinary();
+        }
+        else
+        {
+            /* Drop a notification left over from an earlier transfer */
+            xSemaphoreTake(*event, 0);
+        }
+        return (*event != NULL);
     }
     else
     {
@@ -108,21 +289,40 @@ bool EVENT_Create(event_t eventType)
 
 bool EVENT_Wait(event_t eventType, uint32_t timeoutMilliseconds)
 {
-    uint32_t startTime;
-    uint32_t elapsedTime;
+    TickType_t startTicks;
+    TickType_t timeoutTicks;
+    BaseType_t taken;
 
-    volatile uint32_t *event = EVENT_GetInstance(eventType);
+    event_instance_t *event = EVENT_GetInstance(eventType);
 
-    if (timeoutMilliseconds && event)
+    if (timeoutMilliseconds && event && *event)
     {
-        startTime = g_timeMilliseconds;
-        do
+        if (timeoutMilliseconds == ~0U)
+        {
+            timeoutTicks = portMAX_DELAY;
+        }
+        else
+        {
+            /* At least one tick, a shorter wait would not block */
+            timeoutTicks = pdMS_TO_TICKS(timeoutMilliseconds);
+            if (timeoutTicks == 0U)
+            {
+                timeoutTicks = 1U;
+            }
+        }
+
+        /* The task sleeps until EVENT_Notify() or the timeout */
+        startTicks = xTaskGetTickCount();
+        taken = xSemaphoreTake(*event, timeoutTicks);
+
+        g_eventStats.waits++;
+        g_eventStats.blocked_ms += (uint32_t)(((uint64_t)(xTaskGetTickCount() - startTicks) * 1000U) / configTICK_RATE_HZ);
+        if (taken != pdTRUE)
         {
-            elapsedTime = (g_timeMilliseconds - startTime);
-        } while ((*event == 0U) && (elapsedTime < timeoutMilliseconds));
-        *event = 0U;
+            g_eventStats.timeouts++;
+        }
 
-        return ((elapsedTime < timeoutMilliseconds) ? true : false);
+        return ((taken == pdTRUE) ? true : false);
     }
     else
     {
@@ -132,11 +332,21 @@ bool EVENT_Wait(event_t eventType, uint32_t timeoutMilliseconds)
 
 bool EVENT_Notify(event_t eventType)
 {
-    volatile uint32_t *event = EVENT_GetInstance(eventType);
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    event_instance_t *event = EVENT_GetInstance(eventType);
 
-    if (event)
+    if (event && *event)
     {
-        *event = 1U;
+        /* Called from the SDHC interrupt handler as well as from tasks */
+        if (__get_IPSR() != 0U)
+        {
+            xSemaphoreGiveFromISR(*event, &xHigherPriorityTaskWoken);
+            portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        }
+        else
+        {
+            xSemaphoreGive(*event);
+        }
         return true;
     }
     else
@@ -147,11 +357,17 @@ bool EVENT_Notify(event_t eventType)
 
 void EVENT_Delete(event_t eventType)
 {
-    volatile uint32_t *event = EVENT_GetInstance(eventType);
+    event_instance_t *event = EVENT_GetInstance(eventType);
 
-    if (event)
+    if (event && *event)
     {
-        *event = 0U;
+        vSemaphoreDelete(*event);
+        *event = NULL;
     }
 }
+
+void EVENT_GetStats(event_platform_stats_t *stats)
+{
+    *stats = g_eventStats;
+}
 #endif // #ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
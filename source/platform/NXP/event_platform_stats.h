@@ -0,0 +1,53 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef EVENT_PLATFORM_STATS_H
+#define EVENT_PLATFORM_STATS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief Statistics of the SD card event waits.
+ * EVENT_Wait() used to spin for as long as it now blocks, so the difference
+ * of blocked_ms around a KCM read or write is the CPU time given back to
+ * other tasks. With configUSE_TICKLESS_IDLE set to 2 the idle counters show
+ * how long the core slept without the 1 ms tick interrupt.
+ * The counters are free running and wrap around. */
+typedef struct event_platform_stats {
+    uint32_t waits;             /* EVENT_Wait() calls that blocked */
+    uint32_t timeouts;          /* Waits that ended without a notification */
+    uint32_t blocked_ms;        /* Time spent blocked, in RTOS tick resolution */
+    uint32_t idle_periods;      /* Idle periods slept without the RTOS tick */
+    uint32_t idle_ms;           /* Time slept without the RTOS tick */
+} event_platform_stats_t;
+
+/*!
+ * @brief EVENT_GetStats - sample the event wait statistics
+ * @param stats - the sample
+ * @return void
+ */
+void EVENT_GetStats(event_platform_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_PLATFORM_STATS_H
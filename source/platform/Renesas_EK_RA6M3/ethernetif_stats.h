@@ -0,0 +1,84 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef ETHERNETIF_STATS_H
+#define ETHERNETIF_STATS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct netif;
+
+/*! @brief Link statistics of a netif driven by the RA Ethernet driver.
+ * The counters are free running and wrap around. */
+typedef struct ethernetif_stats {
+    uint32_t timestamp_ms;      /* When the sample was taken */
+    uint32_t rx_packets;        /* Frames passed up to lwIP */
+    uint32_t rx_octets;
+    uint32_t rx_drops;          /* Frames lost: no pbuf or rejected by lwIP input */
+    uint32_t rx_mem_errors;     /* pbuf allocation failures */
+    uint32_t rx_task_wakeups;   /* RX task wakeups by the EDMAC interrupt */
+    uint32_t rx_budget_exhausted; /* Times the RX task stopped draining at ETHERNETIF_RX_BUDGET frames */
+    uint32_t rx_copied;         /* Frames copied out of the descriptor buffer, the others went up as they were */
+    uint32_t tx_packets;
+    uint32_t tx_octets;
+    uint32_t tx_errors;         /* Link down or R_ETHER_Write failures */
+    uint32_t tx_linearized;     /* Frames copied into one buffer, the others went to the MAC as they were */
+} ethernetif_stats_t;
+
+/*! @brief Per second rates between two samples. */
+typedef struct ethernetif_stats_rate {
+    uint32_t interval_ms;
+    uint32_t rx_packets_per_sec;
+    uint32_t rx_octets_per_sec;
+    uint32_t rx_drops_per_sec;
+    uint32_t rx_mem_errors_per_sec;
+    uint32_t rx_task_wakeups_per_sec;
+    uint32_t rx_budget_exhausted_per_sec;
+    uint32_t rx_copied_per_sec;
+    uint32_t tx_packets_per_sec;
+    uint32_t tx_octets_per_sec;
+    uint32_t tx_errors_per_sec;
+    uint32_t tx_linearized_per_sec;
+} ethernetif_stats_rate_t;
+
+/*!
+ * @brief ethernetif_stats_get - sample the statistics of a netif
+ * @param netif - netif initialized with ethernetif_init()
+ * @param stats - the sample
+ * @return 0 on success, -1 if netif is not an ethernetif
+ */
+int ethernetif_stats_get(struct netif *netif, ethernetif_stats_t *stats);
+
+/*!
+ * @brief ethernetif_stats_rate - compute per second rates between two samples
+ * @param prev - the older sample
+ * @param cur - the newer sample
+ * @param rate - the rates, all zero if both samples were taken in the same millisecond
+ * @return void
+ */
+void ethernetif_stats_rate(const ethernetif_stats_t *prev, const ethernetif_stats_t *cur, ethernetif_stats_rate_t *rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ETHERNETIF_STATS_H
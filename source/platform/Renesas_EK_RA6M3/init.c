@@ -33,11 +33,29 @@
 #include "bsp_api.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "event_groups.h"
 #include "SEGGER_RTT.h"
 
 #include <stdio.h>
 
 #define MAX_SD_READ_RETRIES	5
+
+/*! @brief Storage readiness events */
+#define STORAGE_EVENT_MOUNTED       (1U << 0)   // partitions mounted
+#define STORAGE_EVENT_FAILED        (1U << 1)   // no card or mount failed
+
+/*! @brief How long a card may take to show up, the same as the retries used to allow */
+#define SD_CARD_DETECT_TIMEOUT_MS   (MAX_SD_READ_RETRIES * 500)
+
+/*! @brief The card detect pin has to stay active this long before the card is used */
+#define SD_CARD_DEBOUNCE_MS         100
+
+/*! @brief Card detect poll interval. The pin is only polled, the FSP project of
+ *  this example configures no external IRQ for it. */
+#define SD_CARD_POLL_MS             100
+
+/*! @brief Stack of the mount task (Unit: Words). */
+#define SD_MOUNT_TASK_STACK_SIZE    (4*1024/sizeof(int))
 #define configIP_ADDR0 0
 #define configIP_ADDR1 0
 #define configIP_ADDR2 0
@@ -74,8 +92,10 @@ volatile uint16_t rxIndex;    /* Index of the memory to save new arrived data. *
 /*! @brief System clock. */
 #define APP_DEBUG_UART_CLKSRC_NAME kCLOCK_CoreSysClk
 
-/*! @brief File System initialization flag, true if the filesystem has been initialized successfully */
-static bool fileSystemInit = false;
+#ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
+/*! @brief Storage readiness events, created when the mount starts */
+static EventGroupHandle_t storageEvents = NULL;
+#endif
 
 /*! @brief LWIP network interface structure */
 static struct netif netif0;
@@ -217,102 +237,186 @@ void* mcc_platform_GetNetWorkInterfaceContext()
     return (void *)&netif0;
 }
 
-int fileSystemMountDrive(void)
-{
 #ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
-    char folder1[PAL_MAX_FILE_AND_FOLDER_LENGTH] = {0};
-    char folder2[PAL_MAX_FILE_AND_FOLDER_LENGTH] = {0};
-    printf("fileSystemMountDrive, partitions: %d\n", PAL_NUMBER_OF_PARTITIONS);
-    FRESULT fatResult;
-    int count = 0;
-    palStatus_t status = PAL_SUCCESS;
+/*!
+ * @brief fileSystemCardInserted - read the card detect pin
+ * @param void
+ * @return true if a card is in the slot
+ */
+static bool fileSystemCardInserted(void)
+{
+    return GPIO_ReadPinInput(BOARD_SDHC_CD_GPIO_BASE, BOARD_SDHC_CD_GPIO_PIN) ? true : false;
+}
 
-    if (fileSystemInit == false)
-    {
-        //Detected SD card inserted
-        while (!(GPIO_ReadPinInput(BOARD_SDHC_CD_GPIO_BASE, BOARD_SDHC_CD_GPIO_PIN)))
-        {
-            vTaskDelay(pdMS_TO_TICKS(500));
-            if (count++ > MAX_SD_READ_RETRIES)
-            {
-                break;
-            }
+/*!
+ * @brief fileSystemCardWait - wait for a card to be inserted and settle
+ * @param void
+ * @return true if a card is in the slot
+ */
+static bool fileSystemCardWait(void)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(SD_CARD_DETECT_TIMEOUT_MS);
+    TickType_t elapsed;
+
+    while (!fileSystemCardInserted()) {
+        elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            return false;
         }
+        vTaskDelay(pdMS_TO_TICKS(SD_CARD_POLL_MS));
+    }
 
-        if (count < MAX_SD_READ_RETRIES)
-        {
-            // Delay some time to make card stable.
-            vTaskDelay(pdMS_TO_TICKS(1000));
+    // The contacts bounce while the card slides in, use it once the pin is steady
+    vTaskDelay(pdMS_TO_TICKS(SD_CARD_DEBOUNCE_MS));
+    return fileSystemCardInserted();
+}
+
+/*!
+ * @brief fileSystemMountPartitions - mount the partitions PAL uses
+ * @param void
+ * @return FR_OK if the last mount succeeded
+ */
+static FRESULT fileSystemMountPartitions(void)
+{
+    char folder1[PAL_MAX_FILE_AND_FOLDER_LENGTH] = {0};
+    char folder2[PAL_MAX_FILE_AND_FOLDER_LENGTH] = {0};
+    FRESULT fatResult = FR_NOT_READY;
+    palStatus_t status = PAL_SUCCESS;
 
 #if 0
-            // this code does not belong here, it needs a move to mcc_platform_reformat_storage(),
-            // but even then, there is no proper setup mechanism for the partition sizes.
-            // In any case, the code needs to be inside a ifdef _MULTI_PARTITION, as f_fdisk() function
-            // is also ifdeffed out on ff.c
+    // this code does not belong here, it needs a move to mcc_platform_reformat_storage(),
+    // but even then, there is no proper setup mechanism for the partition sizes.
+    // In any case, the code needs to be inside a ifdef _MULTI_PARTITION, as f_fdisk() function
+    // is also ifdeffed out on ff.c
 #ifdef PAL_EXAMPLE_GENERATE_PARTITION
 #if (PAL_NUMBER_OF_PARTITIONS == 1)
-            DWORD plist[] = {100,0,0,0};
+    DWORD plist[] = {100,0,0,0};
 #elif	(PAL_NUMBER_OF_PARTITIONS == 2) //else of (PAL_NUMBER_OF_PARTITIONS == 1)
-            DWORD plist[] = {50,50,0,0};
+    DWORD plist[] = {50,50,0,0};
 #endif //(PAL_NUMBER_OF_PARTITIONS == 1)
-            BYTE work[_MAX_SS];
+    BYTE work[_MAX_SS];
 
-            fatResult= f_fdisk(SDDISK,plist, work);
-            printf("f_fdisk fatResult=%d\r\n",fatResult);
-            if (FR_OK != fatResult)
-            {
-                printf("Failed to create partitions in disk\r\n");
-            }
+    fatResult= f_fdisk(SDDISK,plist, work);
+    printf("f_fdisk fatResult=%d\r\n",fatResult);
+    if (FR_OK != fatResult)
+    {
+        printf("Failed to create partitions in disk\r\n");
+    }
 #endif //PAL_EXAMPLE_GENERATE_PARTITION
 #endif
 
-            status = pal_fsGetMountPoint(PAL_FS_PARTITION_PRIMARY,PAL_MAX_FILE_AND_FOLDER_LENGTH,folder1);
-            if (PAL_SUCCESS == status)
-            {
-                fatResult = f_mount(&fileSystem[0], folder1, 1U);
-                if (FR_OK != fatResult)
-                {
-                    printf("Failed to mount partition %s in disk\r\n",folder1);
-                }
-            }
-            else
-            {
-                printf("Failed to get mount point for primary partition\r\n");
-            }
-
-            status = pal_fsGetMountPoint(PAL_FS_PARTITION_SECONDARY,PAL_MAX_FILE_AND_FOLDER_LENGTH,folder2);
-            if (PAL_SUCCESS == status)
-            {
-                //if there is a different root folder for partition 1 and 2, mount the 2nd partition
-                if (strncmp(folder1,folder2,PAL_MAX_FILE_AND_FOLDER_LENGTH))
-                {
-                    fatResult = f_mount(&fileSystem[1], folder2, 1U);
-                    if (FR_OK != fatResult)
-                    {
-                        printf("Failed to mount partition %s in disk\r\n",folder2);
-                    }
-                }
-            }
-            else
-            {
-                PRINTF("Failed to get mount point for secondary partition\r\n");
-            }
+    status = pal_fsGetMountPoint(PAL_FS_PARTITION_PRIMARY,PAL_MAX_FILE_AND_FOLDER_LENGTH,folder1);
+    if (PAL_SUCCESS == status)
+    {
+        fatResult = f_mount(&fileSystem[0], folder1, 1U);
+        if (FR_OK != fatResult)
+        {
+            printf("Failed to mount partition %s in disk\r\n",folder1);
+        }
+    }
+    else
+    {
+        printf("Failed to get mount point for primary partition\r\n");
+    }
 
-            if (fatResult == FR_OK)
+    status = pal_fsGetMountPoint(PAL_FS_PARTITION_SECONDARY,PAL_MAX_FILE_AND_FOLDER_LENGTH,folder2);
+    if (PAL_SUCCESS == status)
+    {
+        //if there is a different root folder for partition 1 and 2, mount the 2nd partition
+        if (strncmp(folder1,folder2,PAL_MAX_FILE_AND_FOLDER_LENGTH))
+        {
+            fatResult = f_mount(&fileSystem[1], folder2, 1U);
+            if (FR_OK != fatResult)
             {
-                fileSystemInit = true;
+                printf("Failed to mount partition %s in disk\r\n",folder2);
             }
         }
     }
+    else
+    {
+        PRINTF("Failed to get mount point for secondary partition\r\n");
+    }
 
-    if (fileSystemInit) {
-        printf("FileSystem setup successful\n");
-        status = 0;
+    return fatResult;
+}
+
+/*!
+ * @brief fileSystemMountTask - detect the card and mount it in the background
+ * @param arg - unused
+ * @return void
+ */
+static void fileSystemMountTask(void *arg)
+{
+    FRESULT fatResult = FR_NOT_READY;
+
+    (void)arg;
+    if (fileSystemCardWait()) {
+        fatResult = fileSystemMountPartitions();
     } else {
-        printf("FileSystem setup failed, status: %d, fat: %d\n", (int)status, (int)fatResult);
-        status = -1;
+        printf("No SD card detected\n");
+    }
+
+    if (fatResult == FR_OK) {
+        xEventGroupSetBits(storageEvents, STORAGE_EVENT_MOUNTED);
+    } else {
+        printf("FileSystem setup failed, fat: %d\n", (int)fatResult);
+        xEventGroupSetBits(storageEvents, STORAGE_EVENT_FAILED);
+    }
+
+    vTaskDelete(NULL);
+}
+#endif // #ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
+
+/*!
+ * Starts the card detection and mount, fileSystemWaitReady() tells the outcome.
+ */
+int fileSystemMountDrive(void)
+{
+#ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
+    printf("fileSystemMountDrive, partitions: %d\n", PAL_NUMBER_OF_PARTITIONS);
+
+    if (storageEvents != NULL) {
+        // Already started
+        return 0;
+    }
+
+    storageEvents = xEventGroupCreate();
+    if (storageEvents == NULL) {
+        printf("FileSystem setup failed, no memory for events\n");
+        return -1;
+    }
+
+    if (xTaskCreate(fileSystemMountTask, "_sdmount_", SD_MOUNT_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+        printf("FileSystem setup failed, no memory for the mount task\n");
+        // Nothing waits on the events yet, a later call starts over
+        vEventGroupDelete(storageEvents);
+        storageEvents = NULL;
+        return -1;
+    }
+#endif // #ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
+    return 0;
+}
+
+/*!
+ * Blocks until the mount started by fileSystemMountDrive() is done.
+ */
+int fileSystemWaitReady(void)
+{
+#ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
+    EventBits_t events;
+
+    if (storageEvents == NULL) {
+        return -1;
+    }
+
+    // The mount task always ends with one of these
+    events = xEventGroupWaitBits(storageEvents, STORAGE_EVENT_MOUNTED | STORAGE_EVENT_FAILED, pdFALSE, pdFALSE, portMAX_DELAY);
+    if (events & STORAGE_EVENT_MOUNTED) {
+        printf("FileSystem setup successful\n");
+        return 0;
     }
-    return status;
+    return -1;
 #else
     return 0;
 #endif // #ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
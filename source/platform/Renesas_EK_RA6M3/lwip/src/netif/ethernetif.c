@@ -56,6 +56,7 @@
 #include "lwip/snmp.h"
 #include "lwip/ethip6.h"
 #include "lwip/etharp.h"
+#include "lwip/timeouts.h"
 #include "netif/ppp/pppoe.h"
 
 // Headers for Renesas RA Ethernet API
@@ -67,12 +68,46 @@
 // Additional headers to enable Ethernet RX channel
 #include "FreeRTOS.h"
 #include "task.h"
+// Exported link statistics
+#include "ethernetif_stats.h"
 
 /* Define those to better describe your network interface. */
 #define IFNAME0 'e'
 #define IFNAME1 'n'
 
 #define ETHER_EDMAC_INTERRUPT_FACTOR_RECEPTION    (0x01070000)
+#define ETHER_MINIMUM_FRAME_LEN                   (60)
+
+/* Upper bound of the TX descriptors configured for g_ether0. */
+#ifndef ETHERNETIF_TX_QUEUE_LEN
+#define ETHERNETIF_TX_QUEUE_LEN                   (8)
+#endif
+/* How long low_level_output() waits for a TX descriptor, in ms. */
+#ifndef ETHERNETIF_TX_WAIT_MS
+#define ETHERNETIF_TX_WAIT_MS                     (10)
+#endif
+/* Period of the check for sent zero copy frames while TX is idle, in ms. */
+#ifndef ETHERNETIF_TX_RECLAIM_MS
+#define ETHERNETIF_TX_RECLAIM_MS                  (100)
+#endif
+#define ETHER_TD0_TACT                            (0x80000000UL)
+/* Receive buffers beyond the RX descriptors, lent to lwIP with zero copy RX. */
+#ifndef ETHERNETIF_RX_POOL_LEN
+#define ETHERNETIF_RX_POOL_LEN                    (8)
+#endif
+/* Upper bound of the RX buffer size configured for g_ether0. */
+#ifndef ETHERNETIF_RX_BUFFER_SIZE
+#define ETHERNETIF_RX_BUFFER_SIZE                 (1536)
+#endif
+/* Frames the RX task passes up before letting lower priority tasks run. */
+#ifndef ETHERNETIF_RX_BUDGET
+#define ETHERNETIF_RX_BUDGET                      (8)
+#endif
+/* Time the RX task lets further frames arrive after an interrupt, in ms,
+ * 0 drains the ring right away. */
+#ifndef ETHERNETIF_RX_COALESCE_MS
+#define ETHERNETIF_RX_COALESCE_MS                 (0)
+#endif
 // #define ETHER_DEBUG
 #ifdef ETHER_DEBUG
 #define ETHER_LOG_DEBUG configPRINTF
@@ -92,23 +127,69 @@ struct ethernetif {
   struct eth_addr *ethaddr;
   ether_ctrl_t *ra_ether0_ctrl;
   const ether_cfg_t *ra_ether0_cfg;
+  ethernetif_stats_t stats;
+  /* With zero copy TX the MAC reads frames straight from these pbufs, indexed
+   * like the TX descriptors. A pbuf is held until its descriptor is released. */
+  struct {
+    struct pbuf *p;
+    void *buffer;
+  } tx_inflight[ETHERNETIF_TX_QUEUE_LEN];
+  bool tx_reclaim_armed;
+  /* Copy RX: pbuf of a full receive buffer, kept across polls that find no frame. */
+  struct pbuf *rx_spare;
 };
 
+/**
+ * A receive buffer lent to lwIP as a custom pbuf. Receiving swaps buffers
+ * with the RX descriptor, the element takes the filled buffer up the stack and
+ * the descriptor gets the free buffer of the element in exchange. Buffers thus
+ * move between the descriptors and the elements, including the ones FSP
+ * configured, and every freed pbuf is a free buffer for the next frame.
+ */
+typedef struct ethernetif_rx_buffer {
+  struct pbuf_custom pc;            /* keep first, the pbuf is cast back */
+  struct ethernetif_rx_buffer *next_free;
+  uint8_t *data;
+} ethernetif_rx_buffer_t;
+
 static TaskHandle_t xRxHanderTaskHandle = NULL;
 
+static ethernetif_rx_buffer_t rx_buffers[ETHERNETIF_RX_POOL_LEN];
+static uint8_t rx_buffer_mem[ETHERNETIF_RX_POOL_LEN][ETHERNETIF_RX_BUFFER_SIZE] __attribute__((aligned(32)));
+static ethernetif_rx_buffer_t *rx_buffer_free_list = NULL;
+
 /* Forward declarations. */
-static void  ethernetif_input(struct netif *netif);
+static bool  ethernetif_input(struct netif *netif);
 err_t ethernetif_init(struct netif *netif);
 
 static void prvRXHandlerTask (void * pvParameters) {
     struct netif *netif = (struct netif *)pvParameters;
+    struct ethernetif *ethernetif = netif->state;
+    uint32_t frames;
 
     for ( ; ; )
     {
         /* Wait for the Ethernet MAC interrupt to indicate that another packet
-         * has been received.  */
-        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
-        ethernetif_input(netif);
+         * has been received. Interrupts raised while the ring is being drained
+         * add up to one more wakeup.  */
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        ethernetif->stats.rx_task_wakeups++;
+
+#if ETHERNETIF_RX_COALESCE_MS > 0
+        vTaskDelay(pdMS_TO_TICKS(ETHERNETIF_RX_COALESCE_MS));
+#endif
+
+        /* Drain the ring a budget at a time. This task runs above the tcpip
+         * thread, so a full budget blocks for a tick to let lwIP take the frames
+         * before its mailbox overflows. */
+        do {
+            for (frames = 0; (frames < ETHERNETIF_RX_BUDGET) && ethernetif_input(netif); frames++) {
+            }
+            if (frames == ETHERNETIF_RX_BUDGET) {
+                ethernetif->stats.rx_budget_exhausted++;
+                vTaskDelay(1);
+            }
+        } while (frames == ETHERNETIF_RX_BUDGET);
     }
 }
 
@@ -133,6 +214,46 @@ void vEtherISRCallback (ether_callback_args_t * p_args) {
     }
 }
 
+static void
+low_level_rx_buffer_init(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < ETHERNETIF_RX_POOL_LEN; i++) {
+    rx_buffers[i].data = rx_buffer_mem[i];
+    rx_buffers[i].next_free = rx_buffer_free_list;
+    rx_buffer_free_list = &rx_buffers[i];
+  }
+}
+
+/** Custom pbuf free function, lwIP may call it from any thread. */
+static void
+low_level_rx_buffer_free(struct pbuf *p)
+{
+  ethernetif_rx_buffer_t *rx_buffer = (ethernetif_rx_buffer_t *)p;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  SYS_ARCH_PROTECT(old_level);
+  rx_buffer->next_free = rx_buffer_free_list;
+  rx_buffer_free_list = rx_buffer;
+  SYS_ARCH_UNPROTECT(old_level);
+}
+
+static ethernetif_rx_buffer_t *
+low_level_rx_buffer_alloc(void)
+{
+  ethernetif_rx_buffer_t *rx_buffer;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  SYS_ARCH_PROTECT(old_level);
+  rx_buffer = rx_buffer_free_list;
+  if (rx_buffer != NULL) {
+    rx_buffer_free_list = rx_buffer->next_free;
+  }
+  SYS_ARCH_UNPROTECT(old_level);
+  return rx_buffer;
+}
+
 /**
  * In this function, the hardware should be initialized.
  * Called from ethernetif_init().
@@ -189,12 +310,134 @@ low_level_init(struct netif *netif)
   // The RA Ethernet global variable initialization function.
   ethernetif->ra_ether0_ctrl = g_ether0.p_ctrl;
   ethernetif->ra_ether0_cfg = g_ether0.p_cfg;
+  LWIP_ASSERT("too many TX descriptors", (ethernetif->ra_ether0_cfg->num_tx_descriptors <= ETHERNETIF_TX_QUEUE_LEN));
+  LWIP_ASSERT("RX buffers too large", (ethernetif->ra_ether0_cfg->ether_buffer_size <= ETHERNETIF_RX_BUFFER_SIZE));
+  low_level_rx_buffer_init();
   fsp_err_t err_ret = R_ETHER_Open(ethernetif->ra_ether0_ctrl, ethernetif->ra_ether0_cfg);
   LWIP_ASSERT("R_ETHER_Open failed!", (err_ret == FSP_SUCCESS));
   // Successfully opened network interface.
   netif->flags |= NETIF_FLAG_UP;
 }
 
+/**
+ * Copies a frame into one zero padded PBUF_RAM pbuf, for chains, for pbufs the
+ * MAC may not keep and for runts it would pad by reading past the end.
+ */
+static struct pbuf *
+low_level_linearize(struct pbuf *p)
+{
+  u16_t len = LWIP_MAX(p->tot_len, ETHER_MINIMUM_FRAME_LEN);
+  struct pbuf *q = pbuf_alloc(PBUF_RAW, len, PBUF_RAM);
+
+  if (q != NULL) {
+    pbuf_copy_partial(p, q->payload, p->tot_len, 0);
+    memset((u8_t *)q->payload + p->tot_len, 0, len - p->tot_len);
+  }
+  return q;
+}
+
+/**
+ * Whether the MAC may send straight from p while lwIP goes on. Only a single
+ * PBUF_RAM or PBUF_POOL pbuf owns its payload: PBUF_REF and PBUF_ROM point at
+ * memory the caller may reuse once the output returns, as does any pbuf marked
+ * PBUF_TYPE_FLAG_DATA_VOLATILE.
+ */
+static bool
+low_level_tx_can_lend(const struct pbuf *p)
+{
+  u8_t allocsrc = pbuf_get_allocsrc(p);
+
+  return (p->next == NULL) &&
+         ((allocsrc == PBUF_TYPE_ALLOC_SRC_MASK_STD_HEAP) || (allocsrc == PBUF_TYPE_ALLOC_SRC_MASK_STD_MEMP_PBUF_POOL)) &&
+         ((p->type_internal & PBUF_TYPE_FLAG_DATA_VOLATILE) == 0) &&
+         (p->len >= ETHER_MINIMUM_FRAME_LEN);
+}
+
+/** Releases the pbufs of the frames the MAC is done with. */
+static bool
+low_level_tx_reclaim(struct ethernetif *ethernetif)
+{
+  const ether_cfg_t *cfg = ethernetif->ra_ether0_cfg;
+  bool pending = false;
+  uint32_t i;
+
+  for (i = 0; i < cfg->num_tx_descriptors; i++) {
+    ether_instance_descriptor_t *desc = &cfg->p_tx_descriptors[i];
+
+    if (ethernetif->tx_inflight[i].p == NULL) {
+      continue;
+    }
+    /* Sent, or the descriptors were set up again after a link change */
+    if (((desc->status & ETHER_TD0_TACT) == 0) || (desc->p_buffer != ethernetif->tx_inflight[i].buffer)) {
+      pbuf_free(ethernetif->tx_inflight[i].p);
+      ethernetif->tx_inflight[i].p = NULL;
+    } else {
+      pending = true;
+    }
+  }
+  return pending;
+}
+
+static void
+low_level_tx_reclaim_timer(void *arg)
+{
+  struct ethernetif *ethernetif = ((struct netif *)arg)->state;
+
+  /* Held TCP segments are not retransmitted, so do not wait for the next frame */
+  ethernetif->tx_reclaim_armed = low_level_tx_reclaim(ethernetif);
+  if (ethernetif->tx_reclaim_armed) {
+    sys_timeout(ETHERNETIF_TX_RECLAIM_MS, low_level_tx_reclaim_timer, arg);
+  }
+}
+
+/** Holds q until the MAC has sent the frame R_ETHER_Write() just queued from buffer. */
+static void
+low_level_tx_hold(struct netif *netif, struct pbuf *q, void *buffer)
+{
+  struct ethernetif *ethernetif = netif->state;
+  const ether_cfg_t *cfg = ethernetif->ra_ether0_cfg;
+  uint32_t i;
+
+  for (i = 0; i < cfg->num_tx_descriptors; i++) {
+    ether_instance_descriptor_t *desc = &cfg->p_tx_descriptors[i];
+
+    if ((desc->p_buffer == buffer) && (desc->status & ETHER_TD0_TACT)) {
+      break;
+    }
+  }
+
+  if (i == cfg->num_tx_descriptors) {
+    /* Already sent */
+    pbuf_free(q);
+    return;
+  }
+
+  if (ethernetif->tx_inflight[i].p != NULL) {
+    pbuf_free(ethernetif->tx_inflight[i].p);
+  }
+  ethernetif->tx_inflight[i].p = q;
+  ethernetif->tx_inflight[i].buffer = buffer;
+
+  if (!ethernetif->tx_reclaim_armed) {
+    ethernetif->tx_reclaim_armed = true;
+    sys_timeout(ETHERNETIF_TX_RECLAIM_MS, low_level_tx_reclaim_timer, netif);
+  }
+}
+
+/** R_ETHER_Write() retrying while all TX descriptors are still owned by the MAC. */
+static fsp_err_t
+low_level_write(struct ethernetif *ethernetif, void *buffer, uint32_t len)
+{
+  TickType_t start = xTaskGetTickCount();
+  fsp_err_t fsp_err;
+
+  while (((fsp_err = R_ETHER_Write(ethernetif->ra_ether0_ctrl, buffer, len)) == FSP_ERR_ETHER_ERROR_TRANSMIT_BUFFER_FULL) &&
+         ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(ETHERNETIF_TX_WAIT_MS))) {
+    vTaskDelay(1);
+  }
+  return fsp_err;
+}
+
 /**
  * This function should do the actual transmission of the packet. The packet is
  * contained in the pbuf that is passed to the function. This pbuf
@@ -210,40 +453,64 @@ low_level_init(struct netif *netif)
  *       to become available since the stack doesn't retry to send a packet
  *       dropped because of memory failure (except for the TCP timers).
  */
-
 static err_t
 low_level_output(struct netif *netif, struct pbuf *p)
 {
   struct ethernetif *ethernetif = netif->state;
   struct pbuf *q;
+  bool zerocopy = (ethernetif->ra_ether0_cfg->zerocopy == ETHER_ZEROCOPY_ENABLE);
 
   fsp_err_t fsp_err = R_ETHER_LinkProcess(ethernetif->ra_ether0_ctrl);
   if (fsp_err != FSP_SUCCESS)
   {
       ETHER_LOG_DEBUG("%s:%d: R_ETHER_LinkProcess failed!: fsp_err(%d)\n", __FUNCTION__, __LINE__, fsp_err);
+      ethernetif->stats.tx_errors++;
       return ERR_IF;
   }
 
 #if ETH_PAD_SIZE
   pbuf_remove_header(p, ETH_PAD_SIZE); /* drop the padding word */
 #endif
+  ETHER_ASSERT(p->tot_len <= ipconfigNETWORK_MTU);
 
-  char p_buffer[ipconfigNETWORK_MTU];
-  uint32_t len = 0;
+  if (zerocopy) {
+    low_level_tx_reclaim(ethernetif);
+  }
 
-  for (q = p; q != NULL; q = q->next) {
-    /* Send the data from the pbuf to the interface, one pbuf at a
-       time. The size of the data in each pbuf is kept in the ->len
-       variable. */
-      memcpy(p_buffer + len, q->payload, q->len);
-      len += q->len;
+  /* Without zero copy the driver copies single pbufs into its own descriptor
+   * buffer anyway. With it, only pbufs that own their payload are lent to the
+   * MAC, the rest are copied. */
+  if (zerocopy ? low_level_tx_can_lend(p) : (p->next == NULL)) {
+    q = p;
+    pbuf_ref(q);
+  } else {
+    q = low_level_linearize(p);
+    if (q != NULL) {
+      ethernetif->stats.tx_linearized++;
+    }
   }
-  ETHER_ASSERT(len <= ipconfigNETWORK_MTU);
 
-  fsp_err = R_ETHER_Write(ethernetif->ra_ether0_ctrl, p_buffer, len);
-  ETHER_LOG_DEBUG("%s:%d: R_ETHER_Write: fsp_err(%d), len(%d)\n", __FUNCTION__, __LINE__, fsp_err, len);
+  if (q == NULL) {
+    fsp_err = FSP_ERR_OUT_OF_MEMORY;
+  } else {
+    fsp_err = low_level_write(ethernetif, q->payload, q->len);
+  }
+  ETHER_LOG_DEBUG("%s:%d: R_ETHER_Write: fsp_err(%d), len(%d)\n", __FUNCTION__, __LINE__, fsp_err, p->tot_len);
   ETHER_ASSERT(fsp_err == FSP_SUCCESS);
 
+  if ((fsp_err == FSP_SUCCESS) && zerocopy) {
+    low_level_tx_hold(netif, q, q->payload);
+  } else if (q != NULL) {
+    pbuf_free(q);
+  }
+
+  if (fsp_err != FSP_SUCCESS) {
+    ethernetif->stats.tx_errors++;
+  } else {
+    ethernetif->stats.tx_packets++;
+    ethernetif->stats.tx_octets += p->tot_len;
+  }
+
   MIB2_STATS_NETIF_ADD(netif, ifoutoctets, p->tot_len);
   if (((u8_t *)p->payload)[0] & 1) {
     /* broadcast or multicast packet*/
@@ -263,82 +530,146 @@ low_level_output(struct netif *netif, struct pbuf *p)
   return ERR_OK;
 }
 
+/**
+ * Zero copy receive: the frame stays in the descriptor buffer, which goes up
+ * the stack wrapped in a custom pbuf. Copies into a PBUF_POOL chain only when
+ * all buffers are lent out.
+ */
+static struct pbuf *
+low_level_input_zerocopy(struct ethernetif *ethernetif, fsp_err_t *fsp_err)
+{
+  struct pbuf *p = NULL;
+  ethernetif_rx_buffer_t *rx_buffer;
+  uint8_t *frame = NULL;
+  uint32_t len = 0;
+
+  *fsp_err = R_ETHER_Read(ethernetif->ra_ether0_ctrl, (void *)&frame, &len);
+  ETHER_LOG_DEBUG("%s:%d: R_ETHER_Read: fsp_err(%d), len(%d)\n", __FUNCTION__, __LINE__, *fsp_err, len);
+  if (*fsp_err != FSP_SUCCESS) {
+    return NULL;
+  }
+
+  rx_buffer = low_level_rx_buffer_alloc();
+  if ((rx_buffer != NULL) && (R_ETHER_RxBufferUpdate(ethernetif->ra_ether0_ctrl, rx_buffer->data) == FSP_SUCCESS)) {
+    rx_buffer->data = frame;
+    rx_buffer->pc.custom_free_function = low_level_rx_buffer_free;
+    p = pbuf_alloced_custom(PBUF_RAW, (u16_t)len, PBUF_REF, &rx_buffer->pc, frame, ethernetif->ra_ether0_cfg->ether_buffer_size);
+    return p;
+  }
+
+  if (rx_buffer != NULL) {
+    low_level_rx_buffer_free(&rx_buffer->pc.pbuf);
+  }
+
+  p = pbuf_alloc(PBUF_RAW, (u16_t)len, PBUF_POOL);
+  if (p != NULL) {
+    pbuf_take(p, frame, (u16_t)len);
+    ethernetif->stats.rx_copied++;
+  }
+  R_ETHER_BufferRelease(ethernetif->ra_ether0_ctrl);
+  return p;
+}
+
+/**
+ * Receive with the driver copying out of its descriptor buffer, straight
+ * into a PBUF_RAM pbuf trimmed to the frame afterwards. The driver copies as
+ * much as the frame holds, so the pbuf spans a whole receive buffer. It is
+ * only handed up with a frame and otherwise kept for the next poll.
+ */
+static struct pbuf *
+low_level_input_copy(struct ethernetif *ethernetif, fsp_err_t *fsp_err)
+{
+  static uint8_t drop_buffer[ETHERNETIF_RX_BUFFER_SIZE];
+  u16_t size = (u16_t)ethernetif->ra_ether0_cfg->ether_buffer_size;
+  struct pbuf *p = ethernetif->rx_spare;
+  uint32_t len = 0;
+
+  if (p == NULL) {
+    p = pbuf_alloc(PBUF_RAW, size + ETH_PAD_SIZE, PBUF_RAM);
+  }
+  if (p == NULL) {
+    /* A pending frame has to leave the descriptor anyway */
+    *fsp_err = R_ETHER_Read(ethernetif->ra_ether0_ctrl, drop_buffer, &len);
+    return NULL;
+  }
+  ethernetif->rx_spare = NULL;
+
+#if ETH_PAD_SIZE
+  pbuf_remove_header(p, ETH_PAD_SIZE); /* drop the padding word */
+#endif
+
+  *fsp_err = R_ETHER_Read(ethernetif->ra_ether0_ctrl, p->payload, &len);
+  ETHER_LOG_DEBUG("%s:%d: R_ETHER_Read: fsp_err(%d), len(%d)\n", __FUNCTION__, __LINE__, *fsp_err, len);
+
+#if ETH_PAD_SIZE
+  pbuf_add_header(p, ETH_PAD_SIZE); /* reclaim the padding word */
+#endif
+
+  if (*fsp_err != FSP_SUCCESS) {
+    ethernetif->rx_spare = p;
+    return NULL;
+  }
+
+  pbuf_realloc(p, (u16_t)(len + ETH_PAD_SIZE));
+  ethernetif->stats.rx_copied++;
+  return p;
+}
+
 /**
  * Should allocate a pbuf and transfer the bytes of the incoming
  * packet from the interface into the pbuf.
  *
  * @param netif the lwip network interface structure for this ethernetif
+ * @param received set if a frame left the RX ring, even when it was dropped or
+ *                 filtered out, cleared once the ring is empty or the read failed
  * @return a pbuf filled with the received packet (including MAC header)
- *         NULL on memory error
+ *         NULL on memory error or when no frame is pending
  */
 static struct pbuf *
-low_level_input(struct netif *netif)
+low_level_input(struct netif *netif, bool *received)
 {
   struct ethernetif *ethernetif = netif->state;
-  struct pbuf *p, *q;
-  uint32_t len;
-
-  // Read Ethernet with zero copy.
-  char p_buffer[ipconfigNETWORK_MTU];
-  uint32_t len_temp = ipconfigNETWORK_MTU;
-  fsp_err_t fsp_err = R_ETHER_Read(ethernetif->ra_ether0_ctrl, (void ** const)&p_buffer, &len_temp);
-  ETHER_LOG_DEBUG("%s:%d: R_ETHER_Read: fsp_err(%d), len(%d)\n", __FUNCTION__, __LINE__, fsp_err, len_temp);
-  if (fsp_err == FSP_ERR_ETHER_ERROR_NO_DATA)
-  {
-      // No data for now.
-      return NULL;
-  }
-  ETHER_ASSERT(fsp_err == FSP_SUCCESS);
+  struct pbuf *p;
+  fsp_err_t fsp_err;
 
-  len = len_temp;
-#if ETH_PAD_SIZE
-  len += ETH_PAD_SIZE; /* allow room for Ethernet padding */
+#if ETH_PAD_SIZE == 0
+  if (ethernetif->ra_ether0_cfg->zerocopy == ETHER_ZEROCOPY_ENABLE) {
+    p = low_level_input_zerocopy(ethernetif, &fsp_err);
+  } else
 #endif
+  {
+    p = low_level_input_copy(ethernetif, &fsp_err);
+  }
 
-  /* We allocate a pbuf chain of pbufs from the pool. */
-  p = pbuf_alloc(PBUF_RAW, (u16_t)len, PBUF_POOL);
+  /* A filtered frame left the ring like any other. The remaining errors, an empty
+   * ring included, say nothing about the next frame: link down, magic packet mode
+   * or a closed driver last until the next interrupt, so they end the drain. */
+  *received = ((fsp_err == FSP_SUCCESS) || (fsp_err == FSP_ERR_ETHER_ERROR_FILTERING));
+  if (fsp_err != FSP_SUCCESS)
+  {
+      ETHER_LOG_DEBUG("%s:%d: RX drain ends: fsp_err(%d)\n", __FUNCTION__, __LINE__, fsp_err);
+      return NULL;
+  }
 
   if (p != NULL) {
-
-#if ETH_PAD_SIZE
-    pbuf_remove_header(p, ETH_PAD_SIZE); /* drop the padding word */
-#endif
-
-    /* We iterate over the pbuf chain until we have read the entire
-     * packet into the pbuf. */
-    uint32_t copied = 0;
-    for (q = p; q != NULL; q = q->next) {
-      /* Read enough bytes to fill this pbuf in the chain. The
-       * available data in the pbuf is given by the q->len
-       * variable.
-       * This does not necessarily have to be a memcpy, you can also preallocate
-       * pbufs for a DMA-enabled MAC and after receiving truncate it to the
-       * actually received size. In this case, ensure the tot_len member of the
-       * pbuf is the sum of the chained pbuf len members.
-       */
-      uint32_t copy_len = configMIN((uint32_t)q->len, len - copied);
-      memcpy(q->payload, p_buffer + copied, copy_len);
-      copied += copy_len;
-    }
-    LWIP_ASSERT("copied == len", (copied == len));
-
     MIB2_STATS_NETIF_ADD(netif, ifinoctets, p->tot_len);
-    if (((u8_t *)p->payload)[0] & 1) {
+    if (((u8_t *)p->payload)[ETH_PAD_SIZE] & 1) {
       /* broadcast or multicast packet*/
       MIB2_STATS_NETIF_INC(netif, ifinnucastpkts);
     } else {
       /* unicast packet*/
       MIB2_STATS_NETIF_INC(netif, ifinucastpkts);
     }
-#if ETH_PAD_SIZE
-    pbuf_add_header(p, ETH_PAD_SIZE); /* reclaim the padding word */
-#endif
 
     LINK_STATS_INC(link.recv);
-  } else {
+    ethernetif->stats.rx_packets++;
+    ethernetif->stats.rx_octets += p->tot_len;
+  } else if (fsp_err == FSP_SUCCESS) {
     LINK_STATS_INC(link.memerr);
     LINK_STATS_INC(link.drop);
     MIB2_STATS_NETIF_INC(netif, ifindiscards);
+    ethernetif->stats.rx_mem_errors++;
+    ethernetif->stats.rx_drops++;
   }
 
   return p;
@@ -352,27 +683,31 @@ low_level_input(struct netif *netif)
  * the appropriate input function is called.
  *
  * @param netif the lwip network interface structure for this ethernetif
+ * @return false once the RX ring is empty or reading from it failed
  */
-static void
+static bool
 ethernetif_input(struct netif *netif)
 {
   // struct ethernetif *ethernetif;
   // struct eth_hdr *ethhdr;
   struct pbuf *p;
+  bool received = false;
 
   // ethernetif = netif->state;
 
   /* move received packet into a new pbuf */
-  p = low_level_input(netif);
+  p = low_level_input(netif, &received);
   /* if no packet could be read, silently ignore this */
   if (p != NULL) {
     /* pass all packets to ethernet_input, which decides what packets it supports */
     if (netif->input(p, netif) != ERR_OK) {
       LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
+      ((struct ethernetif *)netif->state)->stats.rx_drops++;
       pbuf_free(p);
       p = NULL;
     }
   }
+  return received;
 }
 
 /**
@@ -399,6 +734,7 @@ ethernetif_init(struct netif *netif)
     LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_init: out of memory\n"));
     return ERR_MEM;
   }
+  memset(ethernetif, 0, sizeof(*ethernetif));
 
 #if LWIP_NETIF_HOSTNAME
   /* Initialize interface hostname */
@@ -435,3 +771,51 @@ ethernetif_init(struct netif *netif)
   return ERR_OK;
 }
 
+int
+ethernetif_stats_get(struct netif *netif, ethernetif_stats_t *stats)
+{
+  struct ethernetif *ethernetif;
+
+  if ((netif == NULL) || (netif->linkoutput != low_level_output) || (netif->state == NULL)) {
+    return -1;
+  }
+  ethernetif = netif->state;
+
+  /* The counters are updated from the RX task and the tcpip thread, each one is
+   * read atomically but the sample as a whole is not a snapshot. */
+  *stats = ethernetif->stats;
+  stats->timestamp_ms = (uint32_t)(((uint64_t)xTaskGetTickCount() * 1000) / configTICK_RATE_HZ);
+
+  return 0;
+}
+
+static uint32_t
+ethernetif_stats_per_sec(uint32_t prev, uint32_t cur, uint32_t interval_ms)
+{
+  /* unsigned subtraction handles counter wrap around */
+  return (uint32_t)(((uint64_t)(cur - prev) * 1000) / interval_ms);
+}
+
+void
+ethernetif_stats_rate(const ethernetif_stats_t *prev, const ethernetif_stats_t *cur, ethernetif_stats_rate_t *rate)
+{
+  uint32_t interval_ms = cur->timestamp_ms - prev->timestamp_ms;
+
+  memset(rate, 0, sizeof(*rate));
+  rate->interval_ms = interval_ms;
+  if (interval_ms == 0) {
+    return;
+  }
+
+  rate->rx_packets_per_sec = ethernetif_stats_per_sec(prev->rx_packets, cur->rx_packets, interval_ms);
+  rate->rx_octets_per_sec = ethernetif_stats_per_sec(prev->rx_octets, cur->rx_octets, interval_ms);
+  rate->rx_drops_per_sec = ethernetif_stats_per_sec(prev->rx_drops, cur->rx_drops, interval_ms);
+  rate->rx_mem_errors_per_sec = ethernetif_stats_per_sec(prev->rx_mem_errors, cur->rx_mem_errors, interval_ms);
+  rate->rx_task_wakeups_per_sec = ethernetif_stats_per_sec(prev->rx_task_wakeups, cur->rx_task_wakeups, interval_ms);
+  rate->tx_packets_per_sec = ethernetif_stats_per_sec(prev->tx_packets, cur->tx_packets, interval_ms);
+  rate->tx_octets_per_sec = ethernetif_stats_per_sec(prev->tx_octets, cur->tx_octets, interval_ms);
+  rate->tx_errors_per_sec = ethernetif_stats_per_sec(prev->tx_errors, cur->tx_errors, interval_ms);
+  rate->rx_budget_exhausted_per_sec = ethernetif_stats_per_sec(prev->rx_budget_exhausted, cur->rx_budget_exhausted, interval_ms);
+  rate->rx_copied_per_sec = ethernetif_stats_per_sec(prev->rx_copied, cur->rx_copied, interval_ms);
+  rate->tx_linearized_per_sec = ethernetif_stats_per_sec(prev->tx_linearized, cur->tx_linearized, interval_ms);
+}
@@ -20,12 +20,15 @@
 // INCLUDES
 ///////////
 #include "mcc_common_setup.h"
+#include "ethernetif_stats.h"
 #include "pal.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
 
 #include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
 
 ////////////////////////////////////////
 // PLATFORM SPECIFIC DEFINES & FUNCTIONS
@@ -39,12 +42,19 @@ extern int mcc_platform_initFreeRTOSPlatform();
 extern int networkInit(void);
 
 /*!
- * @brief fileSystemMountDrive - mount the SD card to PAL_FS_PARTITION_PRIMARY
+ * @brief fileSystemMountDrive - start mounting the SD card to PAL_FS_PARTITION_PRIMARY
  * @param void
- * @return void
+ * @return 0 if the mount was started
  */
 extern int fileSystemMountDrive();
 
+/*!
+ * @brief fileSystemWaitReady - wait for the mount started by fileSystemMountDrive()
+ * @param void
+ * @return 0 if the SD card is mounted
+ */
+extern int fileSystemWaitReady();
+
 
 ////////////////////////////////
 // SETUP_COMMON.H IMPLEMENTATION
@@ -76,6 +86,12 @@ void* mcc_platform_interface_get(void) {
     return network_interface;
 }
 
+int mcc_platform_interface_wait_up(int timeout_ms) {
+    // No link status events on this platform, the interface is taken as up
+    (void)timeout_ms;
+    return 0;
+}
+
 void mcc_platform_interface_init(void) {}
 
 int mcc_platform_reformat_storage(void)
@@ -97,12 +113,18 @@ int mcc_platform_storage_init(void)
     // which do not care about the order of these.
     if (mcc_platform_init() == 0) {
 
+        // Card detection and mount go on in the background
         return fileSystemMountDrive();
     } else {
         return -1;
     }
 }
 
+int mcc_platform_storage_wait(void)
+{
+    return fileSystemWaitReady();
+}
+
 int mcc_platform_init(void)
 {
     if(init_FreeRTOS) {
@@ -129,3 +151,36 @@ void mcc_platform_sw_build_info(void) {
 void mcc_platform_reboot(void) {
     pal_osReboot();
 }
+
+void mcc_platform_network_stats_print(void)
+{
+    static ethernetif_stats_t prev_stats;
+    static bool prev_stats_valid = false;
+    ethernetif_stats_t stats;
+    ethernetif_stats_rate_t rate;
+
+    if (ethernetif_stats_get((struct netif *)mcc_platform_GetNetWorkInterfaceContext(), &stats) != 0) {
+        printf("Network statistics not available\n");
+        return;
+    }
+
+    printf("Network rx: packets %" PRIu32 ", octets %" PRIu32 ", drops %" PRIu32 ", mem errors %" PRIu32 ", task wakeups %" PRIu32
+           ", budget exhausted %" PRIu32 ", copied %" PRIu32 "\n",
+           stats.rx_packets, stats.rx_octets, stats.rx_drops, stats.rx_mem_errors, stats.rx_task_wakeups, stats.rx_budget_exhausted,
+           stats.rx_copied);
+    printf("Network tx: packets %" PRIu32 ", octets %" PRIu32 ", errors %" PRIu32 ", linearized %" PRIu32 "\n",
+           stats.tx_packets, stats.tx_octets, stats.tx_errors, stats.tx_linearized);
+
+    if (prev_stats_valid) {
+        ethernetif_stats_rate(&prev_stats, &stats, &rate);
+        printf("Network rates over %" PRIu32 " ms (per second): rx packets %" PRIu32 ", rx octets %" PRIu32 ", rx drops %" PRIu32
+               ", rx mem errors %" PRIu32 ", rx task wakeups %" PRIu32 ", rx budget exhausted %" PRIu32 ", rx copied %" PRIu32
+               ", tx packets %" PRIu32 ", tx octets %" PRIu32 ", tx errors %" PRIu32 ", tx linearized %" PRIu32 "\n",
+               rate.interval_ms, rate.rx_packets_per_sec, rate.rx_octets_per_sec, rate.rx_drops_per_sec, rate.rx_mem_errors_per_sec,
+               rate.rx_task_wakeups_per_sec, rate.rx_budget_exhausted_per_sec, rate.rx_copied_per_sec,
+               rate.tx_packets_per_sec, rate.tx_octets_per_sec, rate.tx_errors_per_sec, rate.tx_linearized_per_sec);
+    }
+
+    prev_stats = stats;
+    prev_stats_valid = true;
+}
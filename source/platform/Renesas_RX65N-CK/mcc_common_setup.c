@@ -66,7 +66,17 @@ int mcc_platform_storage_init(void)
     return 0;
 }
 
+int mcc_platform_storage_wait(void)
+{
+    return 0;
+}
+
 void mcc_platform_reboot(void)
 {
     pal_plat_osReboot();
 }
+
+void mcc_platform_network_stats_print(void)
+{
+    // Link statistics are not available on this platform
+}
@@ -87,6 +87,14 @@ void* mcc_platform_interface_get(void) {
     return NULL;
 }
 
+int mcc_platform_interface_wait_up(int timeout_ms) {
+    DEBUG_PRINT("mcc_platform_interface_wait_up\r\n");
+
+    // No link status events on this platform, the interface is taken as up
+    (void)timeout_ms;
+    return 0;
+}
+
 void mcc_platform_interface_init(void) {
     DEBUG_PRINT("mcc_platform_interface_init\r\n");
 }
@@ -105,6 +113,13 @@ int mcc_platform_storage_init(void)
     return 0;
 }
 
+int mcc_platform_storage_wait(void)
+{
+    DEBUG_PRINT("mcc_platform_storage_wait\r\n");
+
+    return 0;
+}
+
 int mcc_platform_init(void)
 {
     DEBUG_PRINT("mcc_platform_init\r\n");
@@ -125,3 +140,7 @@ void mcc_platform_sw_build_info(void) {
 void mcc_platform_reboot(void) {
     NVIC_SystemReset();
 }
+
+void mcc_platform_network_stats_print(void) {
+    // Link statistics are not available on this platform
+}
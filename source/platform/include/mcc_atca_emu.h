@@ -0,0 +1,105 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+#ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
+#ifndef MCC_ATCA_EMU_H
+#define MCC_ATCA_EMU_H
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "atcacert_def.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Software ATECC608A.
+The emulator is a cryptoauthlib custom interface (ATCA_CUSTOM_IFACE, cryptoauthlib built with
+ATCA_HAL_CUSTOM), so the real atcab and atcacert code runs on top of it and issues exactly the
+commands it would issue over I2C. It answers Read, Write, GenKey and Info from a RAM image of the
+config, OTP and data zones. Slot keys are software P-256 keys derived from a fixed seed.
+The device is provisioned at boot from the selected signer and device certificate templates.
+The emulator runs in place of the I2C device on an Mbed OS target without an ATECC608A, or on the
+host, where test/host builds it together with the credential path against a host cryptoauthlib and
+Mbed TLS to measure the SE round trips of the certificate chain decompression without a board.
+Bus timing uses the us ticker on Mbed OS and the POSIX monotonic clock on the host.*/
+
+/* === Definitions === */
+/*Emulated I2C clock, used to charge the bus transfer time of every command*/
+#ifndef MCC_ATCA_EMU_BUS_HZ
+#define MCC_ATCA_EMU_BUS_HZ             400000
+#endif
+
+/*Scale of the latency model in percent: 100 waits for the modelled bus and execution time of every
+command, 0 answers immediately. The modelled time is accounted in the statistics either way.*/
+#ifndef MCC_ATCA_EMU_LATENCY_PERCENT
+#define MCC_ATCA_EMU_LATENCY_PERCENT    100
+#endif
+
+/*Round trip statistics*/
+typedef struct mcc_atca_emu_stats_ {
+    uint32_t round_trips;     /* Commands sent to the device */
+    uint32_t polls;           /* Receive attempts the device did not answer yet */
+    uint32_t wakes;
+    uint32_t read_commands;
+    uint32_t write_commands;
+    uint32_t genkey_commands;
+    uint32_t other_commands;
+    uint32_t tx_bytes;
+    uint32_t rx_bytes;
+    uint32_t modelled_us;     /* Bus transfer, wake and execution time of the latency model */
+} mcc_atca_emu_stats_s;
+
+/* === APIs === */
+/** Initializes cryptoauthlib on top of the emulated device.
+*
+* @returns 0 in case of success or -1 otherwise.
+*/
+int mcc_atca_emu_init(void);
+
+/** Writes compressed signer and device certificates built from the templates to the emulated device.
+* The signer certificate is signed by a software CA key and carries the authority key ID of ca_public_key,
+* the device certificate is signed by the software signer key.
+*
+* @param signer_cert_def - Signer certificate template
+* @param device_cert_def - Device certificate template
+* @param ca_public_key - CA public key the signer certificate is read with (64 bytes, X and Y)
+*
+* @returns 0 in case of success or -1 otherwise.
+*/
+int mcc_atca_emu_provision(const atcacert_def_t *signer_cert_def, const atcacert_def_t *device_cert_def, const uint8_t *ca_public_key);
+
+/** Releases cryptoauthlib and the emulated device. */
+void mcc_atca_emu_release(void);
+
+/** Gets the statistics since the last reset. */
+void mcc_atca_emu_stats_get(mcc_atca_emu_stats_s *stats);
+
+/** Resets the statistics. */
+void mcc_atca_emu_stats_reset(void);
+
+/** Prints the statistics. */
+void mcc_atca_emu_stats_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* MCC_ATCA_EMU_H */
+#endif // MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
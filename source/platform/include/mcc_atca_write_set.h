@@ -0,0 +1,73 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+#ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_SUPPORT
+#ifndef MCC_ATCA_WRITE_SET_H
+#define MCC_ATCA_WRITE_SET_H
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* === Definitions === */
+/*ATCA certificate chain size*/
+#define MCC_ATCA_SIGNER_CHAIN_DEPTH     2
+
+/*Items of the first boot storage transaction, staged in RAM before anything is written*/
+typedef struct mcc_atca_write_set_ {
+    const uint8_t *device_certificate;
+    size_t device_certificate_size;
+    const uint8_t *signer_certificate;
+    size_t signer_certificate_size;
+    const uint8_t *endpoint_name;
+    size_t endpoint_name_size;
+} mcc_atca_write_set_s;
+
+/* === APIs === */
+/** Checks whether a previous boot completed the write-set.
+* The endpoint name is always the last item written, it is the commit record of the write-set.
+* The chain stays deletable after the commit, so its certificates are checked too.
+*
+* @returns true if the endpoint name and every certificate of the chain exist in the storage, false otherwise.
+*/
+bool mcc_atca_write_set_is_committed(void);
+
+/** Removes the certificate chain an interrupted commit left behind.
+* The chain entries are stored deletable for that reason, only the endpoint name is not.
+*/
+void mcc_atca_write_set_rollback(void);
+
+/** Writes the staged items back to back: the certificate chain, then the endpoint name.
+* Leftovers of an interrupted commit are rolled back first, and so is a commit that fails halfway.
+* An endpoint name a previous commit stored is kept.
+*
+* @param write_set[in] - The staged items.
+*
+* @returns 0 in case of success, -1 otherwise.
+*/
+int mcc_atca_write_set_commit(const mcc_atca_write_set_s *write_set);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* MCC_ATCA_WRITE_SET_H */
+#endif // MBED_CONF_APP_SECURE_ELEMENT_ATCA_SUPPORT
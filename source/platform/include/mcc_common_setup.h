@@ -52,6 +52,13 @@ int mcc_platform_interface_close(void);
 // On failure: Returns NULL.
 void *mcc_platform_interface_get(void);
 
+// Wait for the network interface to come back after it went down. A connect is
+// started right away for stacks that do not reconnect by themselves, one already in
+// progress is waited for.
+// @returns
+//   0 once the interface is up, anything else for error
+int mcc_platform_interface_wait_up(int timeout_ms);
+
 // Format storage (DEPRECATED).
 int mcc_platform_reformat_storage(void);
 
@@ -59,6 +66,12 @@ int mcc_platform_reformat_storage(void);
 // creates default folders, reformat.
 int mcc_platform_storage_init(void);
 
+// Wait for the storage mcc_platform_storage_init() prepares in the background (if any)
+// to become usable.
+// @returns
+//   0 for success, anything else for error
+int mcc_platform_storage_wait(void);
+
 // Connect to network interface (Deprecated).
 int mcc_platform_init_connection(void);
 // Close network interface (Deprecated).
@@ -75,6 +88,9 @@ void mcc_platform_sw_build_info(void);
 //Reboot
 void mcc_platform_reboot(void);
 
+// Print network interface link statistics and their rates since the previous call (if available)
+void mcc_platform_network_stats_print(void);
+
 /*!
  * @brief mcc_platform_run_program - Start the OS with the main function
  * @param testMain_t mainTestFunc  - main function to run
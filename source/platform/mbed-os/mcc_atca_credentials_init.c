@@ -18,9 +18,15 @@
 
 #ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_SUPPORT
 #include "mcc_atca_credentials_init.h"
+#include "mcc_atca_write_set.h"
+#include "mbedtls/asn1.h"
+#include "mbedtls/oid.h"
+#if MBED_CONF_APP_BENCHMARK == 1
 #include "mbedtls/x509.h"
 #include "mbedtls/x509_crt.h"
-#include "mbedtls/oid.h"
+#include "cmsis.h"
+#include "sda_mem_stats.h"
+#endif
 #include "mbed-trace/mbed_trace.h"
 #include "tng_root_cert.h"
 #include "key_config_manager.h"
@@ -33,13 +39,19 @@
 #include "atca_helpers.h"
 #include "storage_kcm.h"
 #include "fcc_defs.h"
+#ifndef MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
 #include "atecc608a_se.h"
+#endif
+#include "us_ticker_api.h"
 #include "cust_def_1_signer.h"
 #include "cust_def_2_device.h"
 #include "tngtls_cert_def_1_signer.h"
 #include "tngtls_cert_def_2_device.h"
 #include "tnglora_cert_def_1_signer.h"
 #include "tnglora_cert_def_2_device.h"
+#ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
+#include "mcc_atca_emu.h"
+#endif
 #define TRACE_GROUP "atml"
 
 /*Global certificate structure pointers, should be set during mcc_atca_init 
@@ -50,173 +62,390 @@ const uint8_t  *g_mcc_cert_ca_public_key_1_signer = NULL;
 
 /* This file implements SE device certificate decompression.
 The decompression steps are:
-- Read the signer certificate data from SE using direct atca APIs
-- Read the device certificate data from SE using direct atca APIs
-- Retrieve the CN attribute of the device certificate and save it as Endpoint name in the device storage by using KCM functionality.
-- Create device certificate chain and save it to the device storage by using KCM functionally.*/
+- Read the signer and device certificate data from SE in one burst using direct atca APIs,
+  locations both certificates share are read once
+- Rebuild the signer certificate, then the device certificate with the signer public key read from SE
+- Retrieve the CN attribute of the device certificate as Endpoint name.
+- Save the device certificate chain and then the Endpoint name to the device storage by using KCM functionality.
+  The Endpoint name is written last and marks the chain as complete, an incomplete chain is removed and rewritten.*/
 
 /*******************************************************************************
 * Definitions
 ******************************************************************************/
 /* === Definitions and Prototypes === */
-/*ATCA certificate chain size*/
-#define MCC_ATCA_SIGNER_CHAIN_DEPTH     2
 /*Signer public key size*/
 #define SIGNER_PUBLIC_KEY_MAX_LEN       64
+/*Public keys stored in a slot: X and Y each preceded by 4 pad bytes*/
+#define SIGNER_PUBLIC_KEY_PADDED_LEN    72
+/*Max number of distinct SE locations the signer and device certificates are built from*/
+#ifndef MCC_ATCA_PREFETCH_MAX_LOCS
+#define MCC_ATCA_PREFETCH_MAX_LOCS      16
+#endif
+/*Size of the prefetched SE data: compressed certificates, public keys and serial number blocks*/
+#ifndef MCC_ATCA_PREFETCH_DATA_SIZE
+#define MCC_ATCA_PREFETCH_DATA_SIZE     512
+#endif
+/*Size of each arena certificate slot. It must hold atcacert_max_cert_size() of the selected
+signer and device templates, which is checked before decompression. The TNG templates fit,
+custom templates that decompress to larger certificates need to raise it.*/
+#ifndef MCC_ATCA_CERT_MAX_SIZE
+#define MCC_ATCA_CERT_MAX_SIZE          1024
+#endif
+
+/*******************************************************************************
+* Globals
+******************************************************************************/
+
+/*Certificate chain decompression arena. The whole flow runs out of it, so boot does not touch
+the heap and the worst case RAM of the decompression is fixed at build time.*/
+/*SE data both certificates are built from, read in one burst*/
+typedef struct mcc_atca_prefetch_ {
+    atcacert_device_loc_t locs[MCC_ATCA_PREFETCH_MAX_LOCS];
+    size_t offsets[MCC_ATCA_PREFETCH_MAX_LOCS];
+    size_t locs_count;
+    uint32_t round_trips;
+    uint8_t data[MCC_ATCA_PREFETCH_DATA_SIZE];
+} mcc_atca_prefetch_s;
+
+typedef struct mcc_atca_arena_ {
+    uint8_t signer_certificate[MCC_ATCA_CERT_MAX_SIZE];
+    uint8_t device_certificate[MCC_ATCA_CERT_MAX_SIZE];
+    mcc_atca_prefetch_s prefetch;
+} mcc_atca_arena_s;
+
+static mcc_atca_arena_s g_mcc_atca_arena;
 
 /*******************************************************************************
 * Static functions
 ******************************************************************************/
 
-/*Reads signer certificate from the device*/
-static int mcc_atca_read_signer_cert(uint8_t *cert, size_t *cert_size_out)
+/*Adds the SE locations a certificate is built from to the prefetch list. Locations shared by the
+certificates, or lying in the same blocks, are merged so every block is read only once.*/
+static int mcc_atca_prefetch_add(const atcacert_def_t *cert_def, mcc_atca_prefetch_s *prefetch)
 {
-
-    //read signer cert
-    int atca_status = atcacert_read_cert((const atcacert_def_t*)g_mcc_cert_def_1_signer, g_mcc_cert_ca_public_key_1_signer, cert, cert_size_out);
+    int atca_status = atcacert_get_device_locations(cert_def, prefetch->locs, &prefetch->locs_count, MCC_ATCA_PREFETCH_MAX_LOCS, ATCA_BLOCK_SIZE);
     if (atca_status != ATCACERT_E_SUCCESS) {
-        tr_error("atcacert_read_cert error (%" PRIu32 ")", (uint32_t)atca_status);
+        tr_error("atcacert_get_device_locations error (%" PRIu32 ")", (uint32_t)atca_status);
+        return -1;
+    }
+    return 0;
+}
+
+/*Number of commands atcab issues for a location: one GenKey, or 32 byte block reads and 4 byte word reads*/
+static uint32_t mcc_atca_prefetch_round_trips(const atcacert_device_loc_t *loc)
+{
+    if ((loc->zone == DEVZONE_DATA) && loc->is_genkey) {
+        return 1;
+    }
+    return (uint32_t)((loc->count / ATCA_BLOCK_SIZE) + (((loc->count % ATCA_BLOCK_SIZE) + ATCA_WORD_SIZE - 1) / ATCA_WORD_SIZE));
+}
+
+/*Reads all the prefetch locations back to back*/
+static int mcc_atca_prefetch_read(mcc_atca_prefetch_s *prefetch)
+{
+    size_t data_size = 0;
+
+    for (size_t i = 0; i < prefetch->locs_count; i++) {
+        data_size += prefetch->locs[i].count;
+    }
+    if (data_size > sizeof(prefetch->data)) {
+        tr_error("SE data (%" PRIu32 ") exceeds MCC_ATCA_PREFETCH_DATA_SIZE", (uint32_t)data_size);
+        return -1;
+    }
+
+    data_size = 0;
+    for (size_t i = 0; i < prefetch->locs_count; i++) {
+        int atca_status = atcacert_read_device_loc(&prefetch->locs[i], &prefetch->data[data_size]);
+        if (atca_status != ATCACERT_E_SUCCESS) {
+            tr_error("atcacert_read_device_loc error (%" PRIu32 ")", (uint32_t)atca_status);
+            return -1;
+        }
+        prefetch->offsets[i] = data_size;
+        data_size += prefetch->locs[i].count;
+        prefetch->round_trips += mcc_atca_prefetch_round_trips(&prefetch->locs[i]);
+    }
+
+    tr_debug("Read of %" PRIu32 " SE locations finished", (uint32_t)prefetch->locs_count);
+    return 0;
+}
+
+/*Copies prefetched data of a location, which must lie within one of the read locations*/
+static int mcc_atca_prefetch_get(const mcc_atca_prefetch_s *prefetch, const atcacert_device_loc_t *loc, uint8_t *data)
+{
+    for (size_t i = 0; i < prefetch->locs_count; i++) {
+        const atcacert_device_loc_t *read_loc = &prefetch->locs[i];
+
+        if ((read_loc->zone == loc->zone) && (read_loc->slot == loc->slot) && (read_loc->is_genkey == loc->is_genkey) &&
+                (loc->offset >= read_loc->offset) && ((loc->offset + loc->count) <= (read_loc->offset + read_loc->count))) {
+            memcpy(data, &prefetch->data[prefetch->offsets[i] + (loc->offset - read_loc->offset)], loc->count);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*The signer public key, taken from the prefetched slot instead of parsing the rebuilt signer certificate*/
+static int mcc_atca_prefetch_get_signer_public_key(const mcc_atca_prefetch_s *prefetch, uint8_t *signer_public_key)
+{
+    const atcacert_device_loc_t *loc = &g_mcc_cert_def_1_signer->public_key_dev_loc;
+    uint8_t public_key[SIGNER_PUBLIC_KEY_PADDED_LEN];
+
+    if ((loc->count > sizeof(public_key)) || (mcc_atca_prefetch_get(prefetch, loc, public_key) != 0)) {
+        tr_error("Signer public key was not prefetched");
         return -1;
     }
 
-    tr_debug("Read of signer certificate finished");
+    // Public keys stored in a slot are padded to 72 bytes, GenKey returns the raw key
+    if (loc->count == sizeof(public_key)) {
+        atcacert_public_key_remove_padding(public_key, signer_public_key);
+    } else if (loc->count == SIGNER_PUBLIC_KEY_MAX_LEN) {
+        memcpy(signer_public_key, public_key, SIGNER_PUBLIC_KEY_MAX_LEN);
+    } else {
+        tr_error("Unexpected signer public key size (%" PRIu32 ")", (uint32_t)loc->count);
+        return -1;
+    }
     return 0;
 }
 
-/*Get CN attribute of the certificate*/
-static int mcc_atca_get_cn(const uint8_t *cert, size_t cert_size, uint8_t **cn_out, size_t *cn_size_out)
+/*Rebuilds a certificate from the prefetched data, locations of the other certificate are skipped by atcacert*/
+static int mcc_atca_build_cert(const atcacert_def_t *cert_def, const uint8_t *ca_public_key, const mcc_atca_prefetch_s *prefetch,
+                               uint8_t *cert, size_t *cert_size_out)
 {
-    uint8_t *cert_cn_data = NULL;
+    atcacert_build_state_t build_state;
+
+    int atca_status = atcacert_cert_build_start(&build_state, cert_def, cert, cert_size_out, ca_public_key);
+    for (size_t i = 0; (atca_status == ATCACERT_E_SUCCESS) && (i < prefetch->locs_count); i++) {
+        atca_status = atcacert_cert_build_process(&build_state, &prefetch->locs[i], &prefetch->data[prefetch->offsets[i]]);
+    }
+    if (atca_status == ATCACERT_E_SUCCESS) {
+        atca_status = atcacert_cert_build_finish(&build_state);
+    }
+    if (atca_status != ATCACERT_E_SUCCESS) {
+        tr_error("atcacert_cert_build error (%" PRIu32 ")", (uint32_t)atca_status);
+        return -1;
+    }
+    return 0;
+}
+
+/*Get CN attribute of the certificate.
+The certificate is walked in place with a DER cursor, straight to the subject RDN sequence, and
+the returned view points into the certificate buffer - nothing is allocated or copied.*/
+static int mcc_atca_get_cn(const uint8_t *cert, size_t cert_size, const uint8_t **cn_out, size_t *cn_size_out)
+{
+    unsigned char *p = (unsigned char *)cert;
+    const unsigned char *end = cert + cert_size;
+    const unsigned char *subject_end = NULL;
+    size_t len = 0;
     int res = 0;
-    char *cn_attribute_name = "CN";
-    size_t cn_attribute_name_size = strlen(cn_attribute_name);
-    mbedtls_x509_name *asn1_subject = NULL;
-    const char *shortName = NULL;
-    mbedtls_x509_crt *cert_handler = NULL;
 
-    //Allocate mbedtls x509 certificate handler
-    cert_handler = (mbedtls_x509_crt*)malloc(sizeof(mbedtls_x509_crt));
-    if (cert_handler == NULL) {
-        tr_error("failed to allocate mbedtls_x509_crt ");
-        res = -1;
-        goto Exit;
+    //Certificate and TBSCertificate sequences
+    for (int i = 0; i < 2; i++) {
+        res = mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE);
+        if (res != 0) {
+            goto Exit;
+        }
+        end = p + len;
     }
 
-    //Initialize certificate handler
-    mbedtls_x509_crt_init(cert_handler);
+    //Optional explicit version
+    res = mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONTEXT_SPECIFIC | MBEDTLS_ASN1_CONSTRUCTED | 0);
+    if (res == 0) {
+        p += len;
+    } else if (res != MBEDTLS_ERR_ASN1_UNEXPECTED_TAG) {
+        goto Exit;
+    }
 
-    //Parse certificate
-    res = mbedtls_x509_crt_parse_der(cert_handler, (const unsigned char*)cert, cert_size);
+    //Skip serial number, signature algorithm, issuer and validity
+    res = mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_INTEGER);
     if (res != 0) {
-        tr_error("mbedtls_x509_crt_parse_der error (%" PRIu32 ")", (uint32_t)res);
-        res = -1;
         goto Exit;
     }
+    p += len;
+
+    for (int i = 0; i < 3; i++) {
+        res = mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE);
+        if (res != 0) {
+            goto Exit;
+        }
+        p += len;
+    }
 
-    //Set certificate subject pointer
-    asn1_subject = &cert_handler->subject;
+    //Subject is a sequence of RDN sets, each holding attribute type and value sequences
+    res = mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE);
+    if (res != 0) {
+        goto Exit;
+    }
+    subject_end = p + len;
 
-    //Read the "CN" attribute
-    while (asn1_subject) {
+    while (p < subject_end) {
+        const unsigned char *set_end = NULL;
 
-        //Get next oid field
-        res = mbedtls_oid_get_attr_short_name(&asn1_subject->oid, &shortName);
+        res = mbedtls_asn1_get_tag(&p, subject_end, &len, MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SET);
         if (res != 0) {
-            tr_error("mbedtls_oid_get_attr_short_name error (%" PRIu32 ")", (uint32_t)res);
-            res = -1;
             goto Exit;
         }
+        set_end = p + len;
+
+        while (p < set_end) {
+            const unsigned char *attribute_end = NULL;
+            bool is_cn = false;
+
+            res = mbedtls_asn1_get_tag(&p, set_end, &len, MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE);
+            if (res != 0) {
+                goto Exit;
+            }
+            attribute_end = p + len;
 
-        //Compare the name of the field to "CN" attribute name
-        if (strncmp(shortName, cn_attribute_name, cn_attribute_name_size) == 0) {
+            res = mbedtls_asn1_get_tag(&p, attribute_end, &len, MBEDTLS_ASN1_OID);
+            if (res != 0) {
+                goto Exit;
+            }
+            is_cn = (len == MBEDTLS_OID_SIZE(MBEDTLS_OID_AT_CN)) && (memcmp(p, MBEDTLS_OID_AT_CN, len) == 0);
+            p += len;
 
-            //Allocate memory for certificate attribute
+            //The value can be any of the string types, skip the tag and take the length
+            if (p >= attribute_end) {
+                res = MBEDTLS_ERR_ASN1_OUT_OF_DATA;
+                goto Exit;
+            }
+            p++;
+            res = mbedtls_asn1_get_len(&p, attribute_end, &len);
+            if (res != 0) {
+                goto Exit;
+            }
+
+            if (is_cn) {
+                //Set output parameters
+                *cn_out = p;
+                *cn_size_out = len;
+                return 0;
+            }
+
+            p = (unsigned char *)attribute_end;
+        }
+    }
+
+    tr_error("CN attribute not found in certificate subject");
+    return -1;
+
+Exit:
+    tr_error("Certificate DER parsing error (-0x%" PRIx32 ")", (uint32_t)(-res));
+    return -1;
+}
+
+#if MBED_CONF_APP_BENCHMARK == 1
+/*Reference CN extraction with a full mbedtls X509 parse, used to compare against mcc_atca_get_cn()*/
+static int mcc_atca_get_cn_x509(const uint8_t *cert, size_t cert_size, uint8_t **cn_out, size_t *cn_size_out)
+{
+    uint8_t *cert_cn_data = NULL;
+    const char *shortName = NULL;
+    mbedtls_x509_name *asn1_subject = NULL;
+    int res = 0;
+
+    mbedtls_x509_crt *cert_handler = (mbedtls_x509_crt*)malloc(sizeof(mbedtls_x509_crt));
+    if (cert_handler == NULL) {
+        return -1;
+    }
+    mbedtls_x509_crt_init(cert_handler);
+
+    res = mbedtls_x509_crt_parse_der(cert_handler, (const unsigned char*)cert, cert_size);
+    if (res != 0) {
+        res = -1;
+        goto Exit;
+    }
+
+    for (asn1_subject = &cert_handler->subject; asn1_subject != NULL; asn1_subject = asn1_subject->next) {
+        if ((mbedtls_oid_get_attr_short_name(&asn1_subject->oid, &shortName) == 0) && (strcmp(shortName, "CN") == 0)) {
             cert_cn_data = malloc(asn1_subject->val.len);
             if (cert_cn_data == NULL) {
-                tr_error("Failed to allocate memory to accommodate CN attribute");
                 res = -1;
                 goto Exit;
             }
-
-            //Copy the attribute data to allocated buffer
             memcpy(cert_cn_data, asn1_subject->val.p, asn1_subject->val.len);
-            //Set output parameters
             *cn_size_out = asn1_subject->val.len;
             *cn_out = cert_cn_data;
             break;
         }
-        //Get pointer of the next field
-        asn1_subject = asn1_subject->next;
     }
 
 Exit:
-    if (res != 0) {
-        free(cert_cn_data);
-    }
-
-    //Free allocated certificate handler internal data
     mbedtls_x509_crt_free(cert_handler);
-    //Free allocated certificate header
     free(cert_handler);
     return res;
 }
 
-/*The function reads CN attribute of the device certificate and stores it to the device storage as endpoint item */
-static int mcc_store_device_cert_cn(const uint8_t *device_cert, size_t device_cert_size)
+static uint32_t mcc_atca_cycles_get(void)
 {
-    kcm_status_e kcm_status = KCM_STATUS_SUCCESS;
-    uint8_t *device_cn = NULL;
-    size_t device_cn_size = 0;
-    int res = 0;
-
-    //Read cn attribute of the device certificate
-    res = mcc_atca_get_cn(device_cert, device_cert_size, &device_cn, &device_cn_size);
-    if (res != 0) {
-        tr_error("psa_drv_atca_get_cn error (%" PRIu32 ")", (uint32_t)kcm_status);
-        return -1;
-    }
-
-    // store the device certificate CN as a endpoint name config param that is not allowed for deleting
-    kcm_status = storage_item_store((const uint8_t *)g_fcc_endpoint_parameter_name, strlen(g_fcc_endpoint_parameter_name),
-                                    KCM_CONFIG_ITEM, true, STORAGE_ITEM_PREFIX_KCM, device_cn, device_cn_size, false);
-
-    /*Free memory that was allocated for CN data*/
-    free(device_cn); // caller must evacuate this buffer
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+    return DWT->CYCCNT;
+#else
+    return 0;
+#endif
+}
 
-    if (kcm_status != KCM_STATUS_SUCCESS) {
-        tr_error("kcm_item_store error (%" PRIu32 ")", (uint32_t)kcm_status);
-        return -1;
+/*Prints cycles and peak RAM of both CN extraction methods for the device certificate built from the selected templates*/
+static void mcc_atca_get_cn_compare(const uint8_t *device_cert, size_t device_cert_size)
+{
+    const uint8_t *cn_view = NULL;
+    uint8_t *cn_copy = NULL;
+    size_t cn_view_size = 0, cn_copy_size = 0;
+    uint32_t cursor_cycles, x509_cycles;
+    int cursor_res, x509_res;
+
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+#if SDA_MEM_STATS_ENABLED
+    sda_mem_snapshot_s mem_snapshot;
+    sda_mem_stats_snapshot(&mem_snapshot);
+#endif
+    cursor_cycles = mcc_atca_cycles_get();
+    cursor_res = mcc_atca_get_cn(device_cert, device_cert_size, &cn_view, &cn_view_size);
+    cursor_cycles = mcc_atca_cycles_get() - cursor_cycles;
+#if SDA_MEM_STATS_ENABLED
+    sda_mem_stats_record((const uint8_t *)"atca_get_cn_der", strlen("atca_get_cn_der"), &mem_snapshot);
+    sda_mem_stats_snapshot(&mem_snapshot);
+#endif
+    x509_cycles = mcc_atca_cycles_get();
+    x509_res = mcc_atca_get_cn_x509(device_cert, device_cert_size, &cn_copy, &cn_copy_size);
+    x509_cycles = mcc_atca_cycles_get() - x509_cycles;
+#if SDA_MEM_STATS_ENABLED
+    sda_mem_stats_record((const uint8_t *)"atca_get_cn_x509", strlen("atca_get_cn_x509"), &mem_snapshot);
+#endif
+
+    tr_info("CN extraction (%" PRIu32 " byte device certificate): DER cursor %" PRIu32 " cycles, X509 parse %" PRIu32 " cycles",
+            (uint32_t)device_cert_size, cursor_cycles, x509_cycles);
+
+    if ((cursor_res != 0) || (x509_res != 0) || (cn_view_size != cn_copy_size) || (memcmp(cn_view, cn_copy, cn_view_size) != 0)) {
+        tr_error("CN extraction methods disagree");
     }
 
-    tr_debug("Store of endpoint name finished");
-    return 0;
+    free(cn_copy);
 }
+#endif // MBED_CONF_APP_BENCHMARK == 1
 
-/* Read device certificate*/
-static int mcc_atca_read_device_cert(const uint8_t *signer_certificate, size_t signer_certificate_size, uint8_t *device_certificate, size_t *device_certificate_size_out)
+/*Stages the endpoint name: the CN attribute of the device certificate, as a view into the certificate*/
+static int mcc_atca_write_set_stage_cn(mcc_atca_write_set_s *write_set)
 {
-    int atca_status = ATCACERT_E_SUCCESS;
-    uint8_t signer_public_key[SIGNER_PUBLIC_KEY_MAX_LEN];
+    int res = 0;
 
-    //Read signer public key
-    atca_status = atcacert_get_subj_public_key((const atcacert_def_t*)g_mcc_cert_def_1_signer, signer_certificate, signer_certificate_size, signer_public_key);
-    if (atca_status != ATCACERT_E_SUCCESS) {
-        tr_error("atcacert_get_subj_public_key error (%" PRIu32 ")", (uint32_t)atca_status);
-        return -1;
-    }
+#if MBED_CONF_APP_BENCHMARK == 1
+    mcc_atca_get_cn_compare(write_set->device_certificate, write_set->device_certificate_size);
+#endif
 
-    // read device certificate using signer public key
-    atca_status = atcacert_read_cert((const atcacert_def_t*)g_mcc_cert_def_2_device, signer_public_key, device_certificate, device_certificate_size_out);
-    if (atca_status != ATCACERT_E_SUCCESS) {
-        tr_error("atcacert_read_cert error (%" PRIu32 ")", (uint32_t)atca_status);
+    res = mcc_atca_get_cn(write_set->device_certificate, write_set->device_certificate_size, &write_set->endpoint_name, &write_set->endpoint_name_size);
+    if (res != 0) {
+        tr_error("mcc_atca_get_cn failed");
         return -1;
     }
 
-    tr_debug("Read of device certificated finished");
     return 0;
 }
 
-/*Get max size of the certificate*/
+/*Get max size of the certificate and check it fits an arena slot*/
 static int mcc_atca_get_max_cert_size(const atcacert_def_t* cert_def, size_t *max_cert_size_out)
 {
     int atca_status = ATCACERT_E_SUCCESS;
@@ -227,7 +456,12 @@ static int mcc_atca_get_max_cert_size(const atcacert_def_t* cert_def, size_t *ma
         tr_error("atcacert_max_cert_size error (%" PRIu32 ")", (uint32_t)atca_status);
         return -1;
     }
-    tr_debug("certificate size is (%" PRIu32 ")", (uint32_t)max_cert_size_out);
+    tr_debug("certificate size is (%" PRIu32 ")", (uint32_t)*max_cert_size_out);
+
+    if (*max_cert_size_out > MCC_ATCA_CERT_MAX_SIZE) {
+        tr_error("Certificate size (%" PRIu32 ") exceeds MCC_ATCA_CERT_MAX_SIZE (%" PRIu32 ")", (uint32_t)*max_cert_size_out, (uint32_t)MCC_ATCA_CERT_MAX_SIZE);
+        return -1;
+    }
     return 0;
 }
 
@@ -236,12 +470,21 @@ static int mcc_atca_init(void)
 {
     tng_type_t type;
 
+#ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
+    //Initialize atca driver on top of the emulated device
+    ATCA_STATUS atca_status = ATCA_SUCCESS;
+    if (mcc_atca_emu_init() != 0) {
+        tr_error("mcc_atca_emu_init failed");
+        return -1;
+    }
+#else
     //Initialize atca driver
     ATCA_STATUS atca_status = atecc608a_init();
     if (atca_status != ATCA_SUCCESS) {
         tr_error("atcab_init error (%" PRIu32 ")", (uint32_t)atca_status);
         return -1;
     }
+#endif
 
     /*Initialize atca credentials templates
     If the device is set to default MCHP credentials, the global credential variables should use default templates according to 
@@ -272,37 +515,46 @@ static int mcc_atca_init(void)
         //Set CA public key of the signer, use custom define
         g_mcc_cert_ca_public_key_1_signer = (const uint8_t*)&g_cert_ca_public_key_1_signer;
     }
+
+#ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
+    //Write certificates matching the selected templates to the emulated device
+    if (mcc_atca_emu_provision(g_mcc_cert_def_1_signer, g_mcc_cert_def_2_device, g_mcc_cert_ca_public_key_1_signer) != 0) {
+        tr_error("mcc_atca_emu_provision failed");
+        return -1;
+    }
+#endif
     return 0;
 }
 
 void mcc_atca_release(void)
 {
+#ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
+    mcc_atca_emu_stats_print();
+    mcc_atca_emu_release();
+#else
     //Release allocated resources
     ATCA_STATUS atca_status = atecc608a_deinit();
     if (atca_status != ATCA_SUCCESS) {
         tr_error("Failed to releasing Atmel's secure element (%" PRIu32 ")", (uint32_t)atca_status);
     }
+#endif
 }
 
 static int mcc_decompress_device_cert_chain(void)
 {
-    kcm_status_e kcm_status = KCM_STATUS_SUCCESS, close_chain_status = KCM_STATUS_SUCCESS;
-    kcm_cert_chain_handle cert_chain_h = NULL;
+    mcc_atca_write_set_s write_set = { 0 };
     size_t device_cert_size = 0, signer_cert_size = 0;
-    uint8_t *signer_certificate_buffer = NULL;
-    uint8_t *device_certificate_buffer = NULL;
+    uint8_t *signer_certificate_buffer = g_mcc_atca_arena.signer_certificate;
+    uint8_t *device_certificate_buffer = g_mcc_atca_arena.device_certificate;
+    mcc_atca_prefetch_s *prefetch = &g_mcc_atca_arena.prefetch;
+    uint8_t signer_public_key[SIGNER_PUBLIC_KEY_MAX_LEN];
+    uint32_t start_us = 0;
     int res = 0;
 
-    // Create chain for device and signer certificate.
-    kcm_status = storage_cert_chain_create(&cert_chain_h, (uint8_t *)g_fcc_bootstrap_device_certificate_name, strlen(g_fcc_bootstrap_device_certificate_name), MCC_ATCA_SIGNER_CHAIN_DEPTH, true, STORAGE_ITEM_PREFIX_KCM);
-    if (kcm_status == KCM_STATUS_FILE_EXIST) {
+    if (mcc_atca_write_set_is_committed()) {
         // Already exist. Skip read and store.
         return 0;
     }
-    if (kcm_status != KCM_STATUS_SUCCESS) {
-        tr_error("kcm_cert_chain_create failed (%" PRIu32 ")", (uint32_t)kcm_status);
-        return -1;
-    }
 
     /*Initialize atca resources*/
     res = mcc_atca_init();
@@ -325,68 +577,60 @@ static int mcc_decompress_device_cert_chain(void)
         goto Exit;
     }
 
-    // allocate buffers to hold the device and signer certificates
-    signer_certificate_buffer = malloc(signer_cert_size);
-    if (signer_certificate_buffer == NULL) {
-        tr_error("Failed to allocate signer certificate buffer");
-        res = -1;
-        goto Exit;
+    // read everything both certificates are built from in one burst
+    start_us = us_ticker_read();
+    memset(prefetch, 0, sizeof(*prefetch));
+    res = mcc_atca_prefetch_add(g_mcc_cert_def_1_signer, prefetch);
+    if (res == 0) {
+        res = mcc_atca_prefetch_add(g_mcc_cert_def_2_device, prefetch);
     }
-
-    device_certificate_buffer = malloc(signer_cert_size);
-    if (device_certificate_buffer == NULL) {
-        tr_error("Failed to allocate device certificate buffer");
-        res = -1;
-        goto Exit;
+    if (res == 0) {
+        res = mcc_atca_prefetch_read(prefetch);
     }
-
-    // read the signer certificate (signer certificate is the actual device certificate CA)
-    res = mcc_atca_read_signer_cert(signer_certificate_buffer, &signer_cert_size);
     if (res != 0) {
-        tr_error("mcc_atca_read_signer_cert failed");
+        tr_error("mcc_atca_prefetch failed");
         goto Exit;
     }
+    tr_info("SE data read with %" PRIu32 " round trips in %" PRIu32 " us", prefetch->round_trips, (uint32_t)(us_ticker_read() - start_us));
 
-    // read the device certificate using signer certificate
-    res = mcc_atca_read_device_cert(signer_certificate_buffer, signer_cert_size, device_certificate_buffer, &device_cert_size);
+    // build the signer certificate (signer certificate is the actual device certificate CA)
+    res = mcc_atca_build_cert(g_mcc_cert_def_1_signer, g_mcc_cert_ca_public_key_1_signer, prefetch, signer_certificate_buffer, &signer_cert_size);
     if (res != 0) {
-        tr_error("mcc_atca_read_device_cert failed");
+        tr_error("mcc_atca_build_cert of signer certificate failed");
         goto Exit;
     }
 
-    // read and store the CN of the device X509 certificate
-    res = mcc_store_device_cert_cn(device_certificate_buffer, device_cert_size);
+    // build the device certificate using signer public key
+    res = mcc_atca_prefetch_get_signer_public_key(prefetch, signer_public_key);
+    if (res == 0) {
+        res = mcc_atca_build_cert(g_mcc_cert_def_2_device, signer_public_key, prefetch, device_certificate_buffer, &device_cert_size);
+    }
     if (res != 0) {
-        tr_error("mcc_store_device_cert_cn failed");
+        tr_error("mcc_atca_build_cert of device certificate failed");
         goto Exit;
     }
 
-    // Store the device and signer certificate as KCM chain that is not allowed for deleting
-    // start with the leaf - add device certificate
-    kcm_status = storage_cert_chain_add_next(cert_chain_h, device_certificate_buffer, device_cert_size, STORAGE_ITEM_PREFIX_KCM, false);
-    if (kcm_status != KCM_STATUS_SUCCESS) {
-        tr_error("Failed to add Atmel's device certificate (%" PRIu32 ")", (uint32_t)kcm_status);
-        res = -1;
-        goto Exit;
-    }
+    write_set.signer_certificate = signer_certificate_buffer;
+    write_set.signer_certificate_size = signer_cert_size;
+    write_set.device_certificate = device_certificate_buffer;
+    write_set.device_certificate_size = device_cert_size;
 
-    //add signer certificate
-    kcm_status = storage_cert_chain_add_next(cert_chain_h, signer_certificate_buffer, signer_cert_size, STORAGE_ITEM_PREFIX_KCM, false);
-    if (kcm_status != KCM_STATUS_SUCCESS) {
-        tr_error("Failed to add Atmel's signer certificate (%" PRIu32 ")", (uint32_t)kcm_status);
-        res = -1;
+    // read the CN of the device X509 certificate
+    res = mcc_atca_write_set_stage_cn(&write_set);
+    if (res != 0) {
+        tr_error("mcc_atca_write_set_stage_cn failed");
+        goto Exit;
     }
 
 Exit:
     mcc_atca_release();
-    free(device_certificate_buffer);
-    free(signer_certificate_buffer);
 
-    close_chain_status = storage_cert_chain_close(cert_chain_h, STORAGE_ITEM_PREFIX_KCM);
-    if (close_chain_status != KCM_STATUS_SUCCESS) {
-        tr_error("Failed closing certificate chain error (%u)", close_chain_status);
-        // modify return status only if function succeed but we failed for storage_cert_chain_close
-        res = -1;
+    // Nothing was written so far, storage is only touched once every item is staged
+    if (res == 0) {
+        res = mcc_atca_write_set_commit(&write_set);
+        if (res != 0) {
+            tr_error("mcc_atca_write_set_commit failed");
+        }
     }
     return res;
 }
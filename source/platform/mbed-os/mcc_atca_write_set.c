@@ -0,0 +1,149 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_SUPPORT
+#include "mcc_atca_write_set.h"
+#include "mbed-trace/mbed_trace.h"
+#include "storage_kcm.h"
+#include "fcc_defs.h"
+#define TRACE_GROUP "atml"
+
+/* This file implements the first boot storage transaction of the ATCA credentials.
+The device certificate chain is written first, the endpoint name last. The endpoint name is the
+commit record, a boot that finds it together with the complete chain skips the SE entirely. Any
+other boot removes whatever chain entries are left and writes the whole set again.
+The chain entries are therefore stored deletable, a chain that is not allowed for deleting could
+not be rolled back and would make every later commit fail on the existing chain. They stay
+deletable after the commit, which is why a chain deleted later is written again from the SE
+rather than trusted to the commit record. The endpoint name is not deletable, a commit that
+finds it already stored keeps it.*/
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+static bool mcc_atca_write_set_endpoint_name_exists(void)
+{
+    size_t endpoint_name_size = 0;
+
+    kcm_status_e kcm_status = storage_item_get_data_size((const uint8_t *)g_fcc_endpoint_parameter_name, strlen(g_fcc_endpoint_parameter_name),
+                                                         KCM_CONFIG_ITEM, STORAGE_ITEM_PREFIX_KCM, &endpoint_name_size);
+    return (kcm_status == KCM_STATUS_SUCCESS);
+}
+
+/*Every certificate of the chain is in the storage*/
+static bool mcc_atca_write_set_chain_exists(void)
+{
+    kcm_status_e kcm_status = KCM_STATUS_SUCCESS;
+    kcm_cert_chain_handle cert_chain_h = NULL;
+    size_t chain_len = 0, cert_size = 0;
+
+    kcm_status = storage_cert_chain_open(&cert_chain_h, (const uint8_t *)g_fcc_bootstrap_device_certificate_name, strlen(g_fcc_bootstrap_device_certificate_name),
+                                         STORAGE_ITEM_PREFIX_KCM, &chain_len);
+    if (kcm_status != KCM_STATUS_SUCCESS) {
+        return false;
+    }
+
+    for (size_t i = 0; (i < chain_len) && (kcm_status == KCM_STATUS_SUCCESS); i++) {
+        kcm_status = storage_cert_chain_get_next_size(&cert_chain_h, STORAGE_ITEM_PREFIX_KCM, &cert_size);
+    }
+
+    (void)storage_cert_chain_close(cert_chain_h, STORAGE_ITEM_PREFIX_KCM);
+    return (kcm_status == KCM_STATUS_SUCCESS) && (chain_len == MCC_ATCA_SIGNER_CHAIN_DEPTH);
+}
+
+bool mcc_atca_write_set_is_committed(void)
+{
+    if (!mcc_atca_write_set_endpoint_name_exists()) {
+        return false;
+    }
+    if (!mcc_atca_write_set_chain_exists()) {
+        tr_warn("Certificate chain missing after the commit, writing it again");
+        return false;
+    }
+    return true;
+}
+
+void mcc_atca_write_set_rollback(void)
+{
+    kcm_status_e kcm_status = storage_cert_chain_delete((const uint8_t *)g_fcc_bootstrap_device_certificate_name, strlen(g_fcc_bootstrap_device_certificate_name),
+                                                       STORAGE_ITEM_PREFIX_KCM);
+    if ((kcm_status != KCM_STATUS_SUCCESS) && (kcm_status != KCM_STATUS_ITEM_NOT_FOUND)) {
+        tr_error("storage_cert_chain_delete error (%" PRIu32 ")", (uint32_t)kcm_status);
+    }
+}
+
+int mcc_atca_write_set_commit(const mcc_atca_write_set_s *write_set)
+{
+    kcm_status_e kcm_status = KCM_STATUS_SUCCESS, close_chain_status = KCM_STATUS_SUCCESS;
+    kcm_cert_chain_handle cert_chain_h = NULL;
+    int res = 0;
+
+    // Leftovers of an interrupted commit
+    mcc_atca_write_set_rollback();
+
+    // Create chain for device and signer certificate.
+    kcm_status = storage_cert_chain_create(&cert_chain_h, (uint8_t *)g_fcc_bootstrap_device_certificate_name, strlen(g_fcc_bootstrap_device_certificate_name), MCC_ATCA_SIGNER_CHAIN_DEPTH, true, STORAGE_ITEM_PREFIX_KCM);
+    if (kcm_status != KCM_STATUS_SUCCESS) {
+        tr_error("kcm_cert_chain_create failed (%" PRIu32 ")", (uint32_t)kcm_status);
+        return -1;
+    }
+
+    // Store the device and signer certificate as KCM chain that is allowed for deleting until the commit record exists
+    // start with the leaf - add device certificate
+    kcm_status = storage_cert_chain_add_next(cert_chain_h, write_set->device_certificate, write_set->device_certificate_size, STORAGE_ITEM_PREFIX_KCM, true);
+    if (kcm_status != KCM_STATUS_SUCCESS) {
+        tr_error("Failed to add Atmel's device certificate (%" PRIu32 ")", (uint32_t)kcm_status);
+        res = -1;
+    }
+
+    //add signer certificate
+    if (res == 0) {
+        kcm_status = storage_cert_chain_add_next(cert_chain_h, write_set->signer_certificate, write_set->signer_certificate_size, STORAGE_ITEM_PREFIX_KCM, true);
+        if (kcm_status != KCM_STATUS_SUCCESS) {
+            tr_error("Failed to add Atmel's signer certificate (%" PRIu32 ")", (uint32_t)kcm_status);
+            res = -1;
+        }
+    }
+
+    close_chain_status = storage_cert_chain_close(cert_chain_h, STORAGE_ITEM_PREFIX_KCM);
+    if (close_chain_status != KCM_STATUS_SUCCESS) {
+        tr_error("Failed closing certificate chain error (%u)", close_chain_status);
+        res = -1;
+    }
+
+    // store the device certificate CN as a endpoint name config param that is not allowed for deleting, it commits the write-set.
+    // It is kept if a previous commit stored it already, it is the CN of the same SE.
+    if ((res == 0) && !mcc_atca_write_set_endpoint_name_exists()) {
+        kcm_status = storage_item_store((const uint8_t *)g_fcc_endpoint_parameter_name, strlen(g_fcc_endpoint_parameter_name),
+                                        KCM_CONFIG_ITEM, true, STORAGE_ITEM_PREFIX_KCM, write_set->endpoint_name, write_set->endpoint_name_size, false);
+        if (kcm_status != KCM_STATUS_SUCCESS) {
+            tr_error("kcm_item_store error (%" PRIu32 ")", (uint32_t)kcm_status);
+            res = -1;
+        }
+    }
+
+    if (res != 0) {
+        mcc_atca_write_set_rollback();
+        return -1;
+    }
+
+    tr_debug("Store of certificate chain and endpoint name finished");
+    return 0;
+}
+#endif // MBED_CONF_APP_SECURE_ELEMENT_ATCA_SUPPORT
@@ -38,6 +38,8 @@
 #endif
 
 
+#include "sda_trace_event.h"
+
 #define TRACE_GROUP "plat"
 
 #define SECONDS_TO_MS 1000  // to avoid using floats, wait() uses floats
@@ -79,6 +81,12 @@ static bool interface_connected = false;
 static bool volatile async_connect = false;
 #endif
 
+#if MBED_CONF_RTOS_PRESENT
+// Set on NSAPI_STATUS_GLOBAL_UP for mcc_platform_interface_wait_up()
+#define NETWORK_EVENT_UP 0x1
+static rtos::EventFlags network_events;
+#endif
+
 ////////////////////////////////
 // SETUP_COMMON.H IMPLEMENTATION
 ////////////////////////////////
@@ -232,12 +240,63 @@ void* mcc_platform_interface_get(void) {
     return NULL;
 }
 
+int mcc_platform_interface_wait_up(int timeout_ms) {
+    nsapi_error_t err;
+
+    if (network_interface == NULL) {
+        return -1;
+    }
+
+    if (!interface_connected) {
+#if MBED_CONF_RTOS_PRESENT
+        network_events.clear(NETWORK_EVENT_UP);
+#endif
+        // Not every stack reconnects by itself. Non-blocking interfaces only start the
+        // connect here and report NSAPI_STATUS_GLOBAL_UP later, there is no event
+        // queue dispatch on this thread.
+        err = network_interface->connect();
+        if ((err == NSAPI_ERROR_IS_CONNECTED) ||
+            (network_interface->get_connection_status() == NSAPI_STATUS_GLOBAL_UP)) {
+            interface_connected = true;
+        } else if ((err != NSAPI_ERROR_OK) && (err != NSAPI_ERROR_IN_PROGRESS) &&
+                   (err != NSAPI_ERROR_ALREADY) && (err != NSAPI_ERROR_BUSY)) {
+            printf("network_interface->connect(): %d\n", err);
+            return -1;
+        }
+    }
+
+    if (!interface_connected) {
+#if MBED_CONF_RTOS_PRESENT
+#if MBED_MAJOR_VERSION > 5
+        network_events.wait_any_for(NETWORK_EVENT_UP, std::chrono::milliseconds(timeout_ms));
+#else
+        network_events.wait_any(NETWORK_EVENT_UP, timeout_ms);
+#endif
+#else
+        for (int waited_ms = 0; !interface_connected && (waited_ms < timeout_ms); waited_ms += 100) {
+            mcc_platform_do_wait(100);
+        }
+#endif
+    }
+
+    if (interface_connected) {
+        return 0;
+    }
+
+    printf("Network still down after %d ms\n", timeout_ms);
+    return -1;
+}
+
 void network_status_callback(nsapi_event_t status, intptr_t param)
 {
     if (status == NSAPI_EVENT_CONNECTION_STATUS_CHANGE) {
         switch(param) {
             case NSAPI_STATUS_GLOBAL_UP:
+                SDA_TRACE_EVENT_INSTANT(SDA_TRACE_EVENT_CAT_NET, "NSAPI_STATUS_GLOBAL_UP");
                 interface_connected = true;
+#if MBED_CONF_RTOS_PRESENT
+                network_events.set(NETWORK_EVENT_UP);
+#endif
 #ifdef MCC_USE_MBED_EVENTS
                 if (async_connect) {
                     async_connect = false;
@@ -251,6 +310,7 @@ void network_status_callback(nsapi_event_t status, intptr_t param)
 #endif
                 break;
             case NSAPI_STATUS_LOCAL_UP:
+                SDA_TRACE_EVENT_INSTANT(SDA_TRACE_EVENT_CAT_NET, "NSAPI_STATUS_LOCAL_UP");
 #if MBED_CONF_MBED_TRACE_ENABLE
                 tr_info("NSAPI_STATUS_LOCAL_UP");
 #else
@@ -258,6 +318,7 @@ void network_status_callback(nsapi_event_t status, intptr_t param)
 #endif
                 break;
             case NSAPI_STATUS_DISCONNECTED:
+                SDA_TRACE_EVENT_INSTANT(SDA_TRACE_EVENT_CAT_NET, "NSAPI_STATUS_DISCONNECTED");
                 interface_connected = false;
 #if MBED_CONF_MBED_TRACE_ENABLE
                 tr_info("NSAPI_STATUS_DISCONNECTED");
@@ -272,6 +333,7 @@ void network_status_callback(nsapi_event_t status, intptr_t param)
 #endif
                 break;
             case NSAPI_STATUS_CONNECTING:
+                SDA_TRACE_EVENT_INSTANT(SDA_TRACE_EVENT_CAT_NET, "NSAPI_STATUS_CONNECTING");
 #if MBED_CONF_MBED_TRACE_ENABLE
                 tr_info("NSAPI_STATUS_CONNECTING");
 #else
@@ -383,7 +445,15 @@ int mcc_platform_storage_init(void) {
     return 0;
 }
 
+int mcc_platform_storage_wait(void) {
+    // The storage is ready once mcc_platform_storage_init() returns
+    return 0;
+}
+
 void mcc_platform_reboot(void) {
     NVIC_SystemReset();
 }
 
+void mcc_platform_network_stats_print(void) {
+    // Link statistics are not available on this platform
+}
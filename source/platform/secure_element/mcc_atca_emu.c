@@ -0,0 +1,648 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifdef MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
+#include "mcc_atca_emu.h"
+#include "mbed-trace/mbed_trace.h"
+#include "atca_basic.h"
+#include "atca_iface.h"
+#include "atcacert_def.h"
+#include "atcacert_client.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/sha256.h"
+#if defined(__MBED__)
+#include "mbed_wait_api.h"
+#include "us_ticker_api.h"
+#else
+#include <time.h>
+#endif
+#define TRACE_GROUP "atml"
+
+/*******************************************************************************
+* Definitions
+******************************************************************************/
+/*Command opcodes*/
+#define EMU_OPCODE_READ                 0x02
+#define EMU_OPCODE_WRITE                0x12
+#define EMU_OPCODE_INFO                 0x30
+#define EMU_OPCODE_GENKEY               0x40
+
+/*Status codes of single byte responses*/
+#define EMU_STATUS_SUCCESS              0x00
+#define EMU_STATUS_PARSE_ERROR          0x03
+#define EMU_STATUS_EXECUTION_ERROR      0x0F
+#define EMU_STATUS_COMM_ERROR           0xFF
+
+/*Read and Write param1*/
+#define EMU_ZONE_MASK                   0x03
+#define EMU_ZONE_CONFIG                 0x00
+#define EMU_ZONE_OTP                    0x01
+#define EMU_ZONE_DATA                   0x02
+#define EMU_ZONE_32_BYTES               0x80
+
+/*GenKey modes that only return the public key of a slot*/
+#define EMU_GENKEY_MODE_PUBLIC          0x00
+#define EMU_GENKEY_MODE_PRIVATE         0x04
+
+/*ATECC608A memory map*/
+#define EMU_CONFIG_SIZE                 128
+#define EMU_OTP_SIZE                    64
+#define EMU_SLOT_COUNT                  16
+#define EMU_DATA_SIZE                   ((8 * 36) + 416 + (7 * 72))
+#define EMU_PUBLIC_KEY_SIZE             64
+#define EMU_SERIAL_NUMBER_SIZE          9
+
+/*Packet: count, opcode, param1, param2 (2), data, crc (2)*/
+#define EMU_PACKET_HEADER_SIZE          5
+#define EMU_PACKET_MIN_SIZE             (EMU_PACKET_HEADER_SIZE + 2)
+#define EMU_RESPONSE_MAX_SIZE           (1 + EMU_PUBLIC_KEY_SIZE + 2)
+
+/*Size of the buffer certificates are built in while provisioning*/
+#ifndef MCC_ATCA_EMU_CERT_MAX_SIZE
+#define MCC_ATCA_EMU_CERT_MAX_SIZE      1024
+#endif
+
+/*Wake pulse and wake delay*/
+#define EMU_WAKE_US                     1500
+/*Execution time of commands missing from the table*/
+#define EMU_DEFAULT_EXECUTION_US        5000
+
+/*Software keys*/
+#define EMU_KEY_LABEL_CA                "ca"
+#define EMU_KEY_LABEL_SIGNER            "signer"
+#define EMU_KEY_LABEL_SLOT              "slot"
+
+/*******************************************************************************
+* Structures
+******************************************************************************/
+typedef struct mcc_atca_emu_latency_ {
+    uint8_t opcode;
+    uint32_t execution_us;
+} mcc_atca_emu_latency_s;
+
+typedef struct mcc_atca_emu_ {
+    uint8_t config[EMU_CONFIG_SIZE];
+    uint8_t otp[EMU_OTP_SIZE];
+    uint8_t data[EMU_DATA_SIZE];
+    uint8_t response[EMU_RESPONSE_MAX_SIZE];
+    size_t response_size;
+    uint64_t ready_at_us;
+    mcc_atca_emu_stats_s stats;
+} mcc_atca_emu_s;
+
+/*******************************************************************************
+* Globals
+******************************************************************************/
+/*Approximate ATECC608A execution times, the device answers polls only once they elapsed*/
+static const mcc_atca_emu_latency_s g_mcc_atca_emu_latency[] = {
+    { EMU_OPCODE_READ,   1000 },
+    { EMU_OPCODE_WRITE,  7000 },
+    { EMU_OPCODE_INFO,   1000 },
+    { EMU_OPCODE_GENKEY, 60000 }
+};
+
+static mcc_atca_emu_s g_mcc_atca_emu;
+static uint8_t g_mcc_atca_emu_cert[MCC_ATCA_EMU_CERT_MAX_SIZE];
+
+static ATCA_STATUS mcc_atca_emu_hal_init(void *hal, void *cfg);
+static ATCA_STATUS mcc_atca_emu_hal_post_init(void *iface);
+static ATCA_STATUS mcc_atca_emu_hal_send(void *iface, uint8_t *txdata, int txlength);
+static ATCA_STATUS mcc_atca_emu_hal_receive(void *iface, uint8_t *rxdata, uint16_t *rxlength);
+static ATCA_STATUS mcc_atca_emu_hal_wake(void *iface);
+static ATCA_STATUS mcc_atca_emu_hal_idle(void *iface);
+static ATCA_STATUS mcc_atca_emu_hal_sleep(void *iface);
+static ATCA_STATUS mcc_atca_emu_hal_release(void *hal_data);
+
+static ATCAIfaceCfg g_mcc_atca_emu_cfg = {
+    .iface_type = ATCA_CUSTOM_IFACE,
+    .devtype = ATECC608A,
+    .atcacustom.halinit = mcc_atca_emu_hal_init,
+    .atcacustom.halpostinit = mcc_atca_emu_hal_post_init,
+    .atcacustom.halsend = mcc_atca_emu_hal_send,
+    .atcacustom.halreceive = mcc_atca_emu_hal_receive,
+    .atcacustom.halwake = mcc_atca_emu_hal_wake,
+    .atcacustom.halidle = mcc_atca_emu_hal_idle,
+    .atcacustom.halsleep = mcc_atca_emu_hal_sleep,
+    .atcacustom.halrelease = mcc_atca_emu_hal_release,
+    .wake_delay = EMU_WAKE_US,
+    .rx_retries = 20,
+    .cfg_data = NULL
+};
+
+/*******************************************************************************
+* Static functions
+******************************************************************************/
+
+static uint64_t mcc_atca_emu_now_us(void)
+{
+#if defined(__MBED__)
+    return ticker_read_us(get_us_ticker_data());
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000);
+#endif
+}
+
+static uint32_t mcc_atca_emu_scaled_us(uint32_t modelled_us)
+{
+    return (uint32_t)(((uint64_t)modelled_us * MCC_ATCA_EMU_LATENCY_PERCENT) / 100);
+}
+
+static void mcc_atca_emu_wait_us(uint32_t modelled_us)
+{
+    uint32_t wait_time_us = mcc_atca_emu_scaled_us(modelled_us);
+
+    if (wait_time_us == 0) {
+        return;
+    }
+#if defined(__MBED__)
+    wait_us((int)wait_time_us);
+#else
+    struct timespec ts = { (time_t)(wait_time_us / 1000000), (long)(wait_time_us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/*Time to clock bytes over I2C: the address byte plus 9 bit times (8 data + ACK) per byte*/
+static uint32_t mcc_atca_emu_bus_us(size_t size)
+{
+    return (uint32_t)((((uint64_t)size + 1) * 9 * 1000000) / MCC_ATCA_EMU_BUS_HZ);
+}
+
+static uint32_t mcc_atca_emu_execution_us(uint8_t opcode)
+{
+    for (size_t i = 0; i < sizeof(g_mcc_atca_emu_latency) / sizeof(g_mcc_atca_emu_latency[0]); i++) {
+        if (g_mcc_atca_emu_latency[i].opcode == opcode) {
+            return g_mcc_atca_emu_latency[i].execution_us;
+        }
+    }
+    return EMU_DEFAULT_EXECUTION_US;
+}
+
+/*CRC-16 of the ATCA packets, polynomial 0x8005, bits fed LSB first, stored little endian*/
+static void mcc_atca_emu_crc(size_t length, const uint8_t *data, uint8_t *crc_le)
+{
+    uint16_t crc_register = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        for (uint8_t shift_register = 0x01; shift_register > 0x00; shift_register <<= 1) {
+            uint8_t data_bit = (data[i] & shift_register) ? 1 : 0;
+            uint8_t crc_bit = (uint8_t)(crc_register >> 15);
+            crc_register <<= 1;
+            if (data_bit != crc_bit) {
+                crc_register ^= 0x8005;
+            }
+        }
+    }
+
+    crc_le[0] = (uint8_t)(crc_register & 0x00FF);
+    crc_le[1] = (uint8_t)(crc_register >> 8);
+}
+
+static void mcc_atca_emu_respond(const uint8_t *data, size_t data_size)
+{
+    g_mcc_atca_emu.response[0] = (uint8_t)(data_size + 3);
+    memcpy(&g_mcc_atca_emu.response[1], data, data_size);
+    mcc_atca_emu_crc(data_size + 1, g_mcc_atca_emu.response, &g_mcc_atca_emu.response[data_size + 1]);
+    g_mcc_atca_emu.response_size = data_size + 3;
+}
+
+static void mcc_atca_emu_respond_status(uint8_t status)
+{
+    mcc_atca_emu_respond(&status, 1);
+}
+
+/*Maps a Read/Write address to the emulated memory*/
+static uint8_t *mcc_atca_emu_locate(uint8_t zone, uint16_t address, size_t size)
+{
+    size_t offset = 0;
+
+    switch (zone) {
+        case EMU_ZONE_CONFIG:
+        case EMU_ZONE_OTP:
+            offset = (((address >> 3) & 0x1F) * 32) + ((address & 0x07) * 4);
+            if (offset + size > ((zone == EMU_ZONE_CONFIG) ? EMU_CONFIG_SIZE : EMU_OTP_SIZE)) {
+                return NULL;
+            }
+            return (zone == EMU_ZONE_CONFIG) ? &g_mcc_atca_emu.config[offset] : &g_mcc_atca_emu.otp[offset];
+
+        case EMU_ZONE_DATA: {
+            uint8_t slot = (uint8_t)((address >> 3) & 0x0F);
+            size_t slot_size = (slot < 8) ? 36 : ((slot == 8) ? 416 : 72);
+            size_t slot_offset = (slot <= 8) ? ((size_t)slot * 36) : ((8 * 36) + 416 + ((size_t)(slot - 9) * 72));
+
+            offset = ((size_t)(address >> 8) * 32) + ((address & 0x07) * 4);
+            if (offset + size > slot_size) {
+                return NULL;
+            }
+            return &g_mcc_atca_emu.data[slot_offset + offset];
+        }
+        default:
+            return NULL;
+    }
+}
+
+/*Derives a P-256 key pair from a label, the same label always gives the same key*/
+static int mcc_atca_emu_key_derive(const char *label, uint16_t index, mbedtls_ecp_keypair *key)
+{
+    char seed_input[32];
+    uint8_t seed[32];
+    int res = 0;
+
+    snprintf(seed_input, sizeof(seed_input), "mcc-atca-emu-%s-%u", label, (unsigned)index);
+
+    res = mbedtls_sha256_ret((const unsigned char *)seed_input, strlen(seed_input), seed, 0);
+    if (res == 0) {
+        res = mbedtls_ecp_group_load(&key->grp, MBEDTLS_ECP_DP_SECP256R1);
+    }
+    if (res == 0) {
+        res = mbedtls_mpi_read_binary(&key->d, seed, sizeof(seed));
+    }
+    if (res == 0) {
+        res = mbedtls_mpi_mod_mpi(&key->d, &key->d, &key->grp.N);
+    }
+    if ((res == 0) && (mbedtls_mpi_cmp_int(&key->d, 0) == 0)) {
+        res = mbedtls_mpi_lset(&key->d, 1);
+    }
+    if (res == 0) {
+        res = mbedtls_ecp_mul(&key->grp, &key->Q, &key->d, &key->grp.G, NULL, NULL);
+    }
+
+    return res;
+}
+
+static int mcc_atca_emu_public_key(const char *label, uint16_t index, uint8_t public_key[EMU_PUBLIC_KEY_SIZE])
+{
+    mbedtls_ecp_keypair key;
+    int res = 0;
+
+    mbedtls_ecp_keypair_init(&key);
+
+    res = mcc_atca_emu_key_derive(label, index, &key);
+    if (res == 0) {
+        res = mbedtls_mpi_write_binary(&key.Q.X, public_key, EMU_PUBLIC_KEY_SIZE / 2);
+    }
+    if (res == 0) {
+        res = mbedtls_mpi_write_binary(&key.Q.Y, public_key + (EMU_PUBLIC_KEY_SIZE / 2), EMU_PUBLIC_KEY_SIZE / 2);
+    }
+
+    mbedtls_ecp_keypair_free(&key);
+    return res;
+}
+
+static int mcc_atca_emu_sign(const char *label, const uint8_t digest[32], uint8_t signature[64])
+{
+    mbedtls_ecp_keypair key;
+    mbedtls_mpi r, s;
+    int res = 0;
+
+    mbedtls_ecp_keypair_init(&key);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    res = mcc_atca_emu_key_derive(label, 0, &key);
+    if (res == 0) {
+        res = mbedtls_ecdsa_sign_det(&key.grp, &r, &s, &key.d, digest, 32, MBEDTLS_MD_SHA256);
+    }
+    if (res == 0) {
+        res = mbedtls_mpi_write_binary(&r, signature, 32);
+    }
+    if (res == 0) {
+        res = mbedtls_mpi_write_binary(&s, signature + 32, 32);
+    }
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_keypair_free(&key);
+    return res;
+}
+
+/*Executes a command and prepares its response, returns the modelled execution time*/
+static uint32_t mcc_atca_emu_execute(const uint8_t *packet, size_t packet_size)
+{
+    uint8_t opcode = packet[1];
+    uint8_t param1 = packet[2];
+    uint16_t param2 = (uint16_t)(packet[3] | (packet[4] << 8));
+    const uint8_t *data = &packet[EMU_PACKET_HEADER_SIZE];
+    size_t data_size = packet_size - EMU_PACKET_MIN_SIZE;
+
+    switch (opcode) {
+        case EMU_OPCODE_READ: {
+            size_t size = (param1 & EMU_ZONE_32_BYTES) ? 32 : 4;
+            const uint8_t *location = mcc_atca_emu_locate(param1 & EMU_ZONE_MASK, param2, size);
+
+            g_mcc_atca_emu.stats.read_commands++;
+            if (location == NULL) {
+                mcc_atca_emu_respond_status(EMU_STATUS_PARSE_ERROR);
+                break;
+            }
+            mcc_atca_emu_respond(location, size);
+            break;
+        }
+        case EMU_OPCODE_WRITE: {
+            size_t size = (param1 & EMU_ZONE_32_BYTES) ? 32 : 4;
+            uint8_t *location = mcc_atca_emu_locate(param1 & EMU_ZONE_MASK, param2, size);
+
+            g_mcc_atca_emu.stats.write_commands++;
+            if ((location == NULL) || (data_size < size)) {
+                mcc_atca_emu_respond_status(EMU_STATUS_PARSE_ERROR);
+                break;
+            }
+            memcpy(location, data, size);
+            mcc_atca_emu_respond_status(EMU_STATUS_SUCCESS);
+            break;
+        }
+        case EMU_OPCODE_GENKEY: {
+            uint8_t public_key[EMU_PUBLIC_KEY_SIZE];
+
+            g_mcc_atca_emu.stats.genkey_commands++;
+            // Slot keys are fixed, a new private key request keeps the current one
+            if (((param1 != EMU_GENKEY_MODE_PUBLIC) && (param1 != EMU_GENKEY_MODE_PRIVATE)) || (param2 >= EMU_SLOT_COUNT)) {
+                mcc_atca_emu_respond_status(EMU_STATUS_PARSE_ERROR);
+                break;
+            }
+            if (mcc_atca_emu_public_key(EMU_KEY_LABEL_SLOT, param2, public_key) != 0) {
+                mcc_atca_emu_respond_status(EMU_STATUS_EXECUTION_ERROR);
+                break;
+            }
+            mcc_atca_emu_respond(public_key, sizeof(public_key));
+            break;
+        }
+        case EMU_OPCODE_INFO: {
+            // Revision mode returns the ATECC608A revision, other modes are not emulated
+            static const uint8_t revision[4] = { 0x00, 0x00, 0x60, 0x02 };
+            static const uint8_t empty[4] = { 0 };
+
+            g_mcc_atca_emu.stats.other_commands++;
+            mcc_atca_emu_respond((param1 == 0) ? revision : empty, 4);
+            break;
+        }
+        default:
+            g_mcc_atca_emu.stats.other_commands++;
+            tr_warn("Emulated secure element does not support opcode 0x%02" PRIx8, opcode);
+            mcc_atca_emu_respond_status(EMU_STATUS_PARSE_ERROR);
+            break;
+    }
+
+    return mcc_atca_emu_execution_us(opcode);
+}
+
+static ATCA_STATUS mcc_atca_emu_hal_init(void *hal, void *cfg)
+{
+    (void)hal;
+    (void)cfg;
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS mcc_atca_emu_hal_post_init(void *iface)
+{
+    (void)iface;
+    return ATCA_SUCCESS;
+}
+
+/*txdata[0] is reserved for the I2C word address, the packet starts at txdata[1]*/
+static ATCA_STATUS mcc_atca_emu_hal_send(void *iface, uint8_t *txdata, int txlength)
+{
+    const uint8_t *packet = &txdata[1];
+    size_t packet_size = (size_t)txlength;
+    uint8_t crc[2];
+    uint32_t bus_us = mcc_atca_emu_bus_us(packet_size);
+    uint32_t execution_us = 0;
+
+    (void)iface;
+
+    g_mcc_atca_emu.stats.round_trips++;
+    g_mcc_atca_emu.stats.tx_bytes += (uint32_t)packet_size + 1;
+
+    if ((packet_size < EMU_PACKET_MIN_SIZE) || (packet[0] != packet_size)) {
+        mcc_atca_emu_respond_status(EMU_STATUS_COMM_ERROR);
+    } else {
+        mcc_atca_emu_crc(packet_size - 2, packet, crc);
+        if (memcmp(crc, &packet[packet_size - 2], sizeof(crc)) != 0) {
+            mcc_atca_emu_respond_status(EMU_STATUS_COMM_ERROR);
+        } else {
+            execution_us = mcc_atca_emu_execute(packet, packet_size);
+        }
+    }
+
+    g_mcc_atca_emu.stats.modelled_us += bus_us + execution_us;
+    mcc_atca_emu_wait_us(bus_us);
+    g_mcc_atca_emu.ready_at_us = mcc_atca_emu_now_us() + mcc_atca_emu_scaled_us(execution_us);
+
+    return ATCA_SUCCESS;
+}
+
+/*The device does not answer until the command executed, cryptoauthlib polls again*/
+static ATCA_STATUS mcc_atca_emu_hal_receive(void *iface, uint8_t *rxdata, uint16_t *rxlength)
+{
+    uint32_t bus_us = 0;
+
+    (void)iface;
+
+    if ((g_mcc_atca_emu.response_size == 0) || (mcc_atca_emu_now_us() < g_mcc_atca_emu.ready_at_us)) {
+        g_mcc_atca_emu.stats.polls++;
+        return ATCA_RX_NO_RESPONSE;
+    }
+
+    if (*rxlength < g_mcc_atca_emu.response_size) {
+        return ATCA_SMALL_BUFFER;
+    }
+
+    bus_us = mcc_atca_emu_bus_us(g_mcc_atca_emu.response_size);
+    g_mcc_atca_emu.stats.modelled_us += bus_us;
+    mcc_atca_emu_wait_us(bus_us);
+
+    memcpy(rxdata, g_mcc_atca_emu.response, g_mcc_atca_emu.response_size);
+    *rxlength = (uint16_t)g_mcc_atca_emu.response_size;
+    g_mcc_atca_emu.stats.rx_bytes += (uint32_t)g_mcc_atca_emu.response_size;
+    g_mcc_atca_emu.response_size = 0;
+
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS mcc_atca_emu_hal_wake(void *iface)
+{
+    (void)iface;
+
+    g_mcc_atca_emu.stats.wakes++;
+    g_mcc_atca_emu.stats.modelled_us += EMU_WAKE_US;
+    mcc_atca_emu_wait_us(EMU_WAKE_US);
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS mcc_atca_emu_hal_idle(void *iface)
+{
+    (void)iface;
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS mcc_atca_emu_hal_sleep(void *iface)
+{
+    (void)iface;
+    return ATCA_SUCCESS;
+}
+
+static ATCA_STATUS mcc_atca_emu_hal_release(void *hal_data)
+{
+    (void)hal_data;
+    return ATCA_SUCCESS;
+}
+
+/*Factory state: serial number, ATECC608A revision, TNG I2C address, config and data zones locked*/
+static void mcc_atca_emu_reset(void)
+{
+    static const uint8_t serial_number_head[4] = { 0x01, 0x23, 0x5D, 0xA0 };
+    static const uint8_t revision[4] = { 0x00, 0x00, 0x60, 0x02 };
+    static const uint8_t serial_number_tail[5] = { 0xE1, 0x4D, 0x55, 0x01, 0x01 };
+
+    memset(&g_mcc_atca_emu, 0, sizeof(g_mcc_atca_emu));
+
+    memcpy(&g_mcc_atca_emu.config[0], serial_number_head, sizeof(serial_number_head));
+    memcpy(&g_mcc_atca_emu.config[4], revision, sizeof(revision));
+    memcpy(&g_mcc_atca_emu.config[8], serial_number_tail, sizeof(serial_number_tail));
+    g_mcc_atca_emu.config[16] = 0x6A;
+    g_mcc_atca_emu.config[86] = 0x00;
+    g_mcc_atca_emu.config[87] = 0x00;
+}
+
+/*Builds a certificate from its template and writes it to the device in compressed form*/
+static int mcc_atca_emu_provision_cert(const atcacert_def_t *cert_def, const uint8_t *subj_public_key,
+                                       const uint8_t *auth_public_key, const char *signer_label)
+{
+    uint8_t serial_number[EMU_SERIAL_NUMBER_SIZE];
+    uint8_t tbs_digest[32];
+    uint8_t signature[64];
+    size_t cert_size = cert_def->cert_template_size;
+    int atca_status = ATCACERT_E_SUCCESS;
+
+    if ((cert_def->cert_template == NULL) || (cert_size > sizeof(g_mcc_atca_emu_cert))) {
+        tr_error("Certificate template does not fit MCC_ATCA_EMU_CERT_MAX_SIZE");
+        return -1;
+    }
+    memcpy(g_mcc_atca_emu_cert, cert_def->cert_template, cert_size);
+
+    memcpy(serial_number, &g_mcc_atca_emu.config[0], 4);
+    memcpy(&serial_number[4], &g_mcc_atca_emu.config[8], 5);
+
+    atca_status = atcacert_set_subj_public_key(cert_def, g_mcc_atca_emu_cert, cert_size, subj_public_key);
+    if (atca_status == ATCACERT_E_SUCCESS) {
+        atca_status = atcacert_set_auth_key_id(cert_def, g_mcc_atca_emu_cert, cert_size, auth_public_key);
+    }
+    if ((atca_status == ATCACERT_E_SUCCESS) && (cert_def->sn_source != SNSRC_STORED) && (cert_def->sn_source != SNSRC_STORED_DYNAMIC)) {
+        atca_status = atcacert_gen_cert_sn(cert_def, g_mcc_atca_emu_cert, cert_size, serial_number);
+    }
+    if (atca_status == ATCACERT_E_SUCCESS) {
+        atca_status = atcacert_get_tbs_digest(cert_def, g_mcc_atca_emu_cert, cert_size, tbs_digest);
+    }
+    if (atca_status != ATCACERT_E_SUCCESS) {
+        tr_error("Building certificate from template failed (%" PRIu32 ")", (uint32_t)atca_status);
+        return -1;
+    }
+
+    if (mcc_atca_emu_sign(signer_label, tbs_digest, signature) != 0) {
+        tr_error("Signing emulated certificate failed");
+        return -1;
+    }
+
+    atca_status = atcacert_set_signature(cert_def, g_mcc_atca_emu_cert, &cert_size, sizeof(g_mcc_atca_emu_cert), signature);
+    if (atca_status == ATCACERT_E_SUCCESS) {
+        atca_status = atcacert_write_cert(cert_def, g_mcc_atca_emu_cert, cert_size);
+    }
+    if (atca_status != ATCACERT_E_SUCCESS) {
+        tr_error("Writing emulated certificate failed (%" PRIu32 ")", (uint32_t)atca_status);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Code
+ ******************************************************************************/
+
+int mcc_atca_emu_init(void)
+{
+    mcc_atca_emu_reset();
+
+    ATCA_STATUS atca_status = atcab_init(&g_mcc_atca_emu_cfg);
+    if (atca_status != ATCA_SUCCESS) {
+        tr_error("atcab_init error (%" PRIu32 ")", (uint32_t)atca_status);
+        return -1;
+    }
+
+    tr_info("Using emulated ATECC608A (bus %" PRIu32 " Hz, latency %" PRIu32 "%%)", (uint32_t)MCC_ATCA_EMU_BUS_HZ, (uint32_t)MCC_ATCA_EMU_LATENCY_PERCENT);
+    return 0;
+}
+
+int mcc_atca_emu_provision(const atcacert_def_t *signer_cert_def, const atcacert_def_t *device_cert_def, const uint8_t *ca_public_key)
+{
+    uint8_t signer_public_key[EMU_PUBLIC_KEY_SIZE];
+    uint8_t device_public_key[EMU_PUBLIC_KEY_SIZE];
+    mcc_atca_emu_stats_s stats = g_mcc_atca_emu.stats;
+    int res = 0;
+
+    // The device key is the GenKey key of the slot the device certificate takes its public key from
+    res = mcc_atca_emu_public_key(EMU_KEY_LABEL_SIGNER, 0, signer_public_key);
+    if (res == 0) {
+        res = mcc_atca_emu_public_key(EMU_KEY_LABEL_SLOT, device_cert_def->public_key_dev_loc.slot, device_public_key);
+    }
+    if (res != 0) {
+        tr_error("Deriving emulated keys failed");
+        return -1;
+    }
+
+    res = mcc_atca_emu_provision_cert(signer_cert_def, signer_public_key, ca_public_key, EMU_KEY_LABEL_CA);
+    if (res == 0) {
+        res = mcc_atca_emu_provision_cert(device_cert_def, device_public_key, signer_public_key, EMU_KEY_LABEL_SIGNER);
+    }
+
+    // Provisioning happens in the factory, keep its commands out of the statistics
+    g_mcc_atca_emu.stats = stats;
+    return res;
+}
+
+void mcc_atca_emu_release(void)
+{
+    ATCA_STATUS atca_status = atcab_release();
+    if (atca_status != ATCA_SUCCESS) {
+        tr_error("atcab_release error (%" PRIu32 ")", (uint32_t)atca_status);
+    }
+}
+
+void mcc_atca_emu_stats_get(mcc_atca_emu_stats_s *stats)
+{
+    *stats = g_mcc_atca_emu.stats;
+}
+
+void mcc_atca_emu_stats_reset(void)
+{
+    memset(&g_mcc_atca_emu.stats, 0, sizeof(g_mcc_atca_emu.stats));
+}
+
+void mcc_atca_emu_stats_print(void)
+{
+    const mcc_atca_emu_stats_s *stats = &g_mcc_atca_emu.stats;
+
+    printf("Emulated secure element: %" PRIu32 " round trips (read %" PRIu32 ", write %" PRIu32 ", genkey %" PRIu32 ", other %" PRIu32 "), "
+           "%" PRIu32 " wakes, %" PRIu32 " polls, %" PRIu32 " bytes tx, %" PRIu32 " bytes rx, %" PRIu32 " us modelled\n",
+           stats->round_trips, stats->read_commands, stats->write_commands, stats->genkey_commands, stats->other_commands,
+           stats->wakes, stats->polls, stats->tx_bytes, stats->rx_bytes, stats->modelled_us);
+}
+#endif // MBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR
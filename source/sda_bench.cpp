@@ -0,0 +1,272 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+// Note: this macro is needed on armcc to get the the PRI*32 macros
+// from inttypes.h in a C++ code.
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "sda_bench.h"
+#include "mbed-trace/mbed_trace.h"
+
+#if defined(__MBED__)
+#include "mbed.h"
+#else
+#include <time.h>
+#endif
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP           "sdae"
+
+#define SDA_BENCH_NS_IN_MS    1000000ULL
+
+// Never grow the iteration count more than this factor between two attempts
+#define SDA_BENCH_MAX_GROWTH  10
+
+#define SDA_BENCH_MAX_ITERATIONS 1000000000UL
+
+#define SDA_BENCH_NAME_MAX_SIZE  96
+
+// Failed benchmarks logged by name at the end of the report, the rest are only counted
+#define SDA_BENCH_MAX_FAILED     4
+
+///////////////////////// GLOBALS /////////////////////////
+
+static bool g_bench_first_entry = true;
+static uint8_t g_bench_trace_config;
+static bool g_bench_failed;
+static char g_bench_failed_names[SDA_BENCH_MAX_FAILED][SDA_BENCH_NAME_MAX_SIZE];
+static uint32_t g_bench_failed_count;
+
+//////////////////////////////////////////////////////////
+
+uint64_t sda_bench_time_ns(void)
+{
+#if defined(__MBED__)
+    return (uint64_t)ticker_read_us(get_us_ticker_data()) * 1000;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t sda_bench_cpu_mhz(void)
+{
+#if defined(__MBED__)
+    return (uint32_t)(SystemCoreClock / 1000000);
+#else
+    return 0;
+#endif
+}
+
+static uint64_t sda_bench_measure(sda_bench_fn fn, void *arg, uint32_t iterations)
+{
+    uint64_t start_ns = sda_bench_time_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        fn(arg);
+    }
+    return sda_bench_time_ns() - start_ns;
+}
+
+void sda_bench_report_begin(void)
+{
+    // Tracing would dominate the measured time, keep only the call overhead
+    g_bench_trace_config = mbed_trace_config_get();
+    mbed_trace_config_set((g_bench_trace_config & ~TRACE_ACTIVE_LEVEL_ALL) | TRACE_ACTIVE_LEVEL_NONE);
+
+    g_bench_first_entry = true;
+    g_bench_failed_count = 0;
+
+    printf("%s\n", SDA_BENCH_REPORT_BEGIN_MARKER);
+    printf("{\n");
+    printf("  \"context\": {\n");
+    printf("    \"executable\": \"sda_bench\",\n");
+    printf("    \"num_cpus\": 1,\n");
+    printf("    \"mhz_per_cpu\": %" PRIu32 ",\n", sda_bench_cpu_mhz());
+    printf("    \"cpu_scaling_enabled\": false,\n");
+    printf("    \"library_build_type\": \"release\"\n");
+    printf("  },\n");
+    printf("  \"benchmarks\": [");
+}
+
+static uint32_t sda_bench_calibrate(sda_bench_fn fn, void *arg, uint64_t *elapsed_ns_out)
+{
+    const uint64_t min_time_ns = SDA_BENCH_MIN_TIME_MS * SDA_BENCH_NS_IN_MS;
+    uint32_t iterations = 1;
+    uint64_t elapsed_ns;
+
+    do {
+        elapsed_ns = sda_bench_measure(fn, arg, iterations);
+
+        if ((elapsed_ns >= min_time_ns) || (iterations >= SDA_BENCH_MAX_ITERATIONS)) {
+            break;
+        }
+
+        // Predict the iteration count needed to reach min time, with some head room
+        uint64_t next = (elapsed_ns == 0) ? ((uint64_t)iterations * SDA_BENCH_MAX_GROWTH)
+                        : (((uint64_t)iterations * min_time_ns * 14) / (elapsed_ns * 10));
+        if (next > (uint64_t)iterations * SDA_BENCH_MAX_GROWTH) {
+            next = (uint64_t)iterations * SDA_BENCH_MAX_GROWTH;
+        }
+        if (next <= iterations) {
+            next = (uint64_t)iterations + 1;
+        }
+        iterations = (next > SDA_BENCH_MAX_ITERATIONS) ? SDA_BENCH_MAX_ITERATIONS : (uint32_t)next;
+
+    } while (true);
+
+    *elapsed_ns_out = elapsed_ns;
+    return iterations;
+}
+
+static void sda_bench_print_entry(const char *name, const char *run_name, const char *aggregate_name,
+                                  uint32_t repetition_index, uint32_t iterations, uint64_t per_iter_milli_ns)
+{
+    printf("%s\n", g_bench_first_entry ? "" : ",");
+    g_bench_first_entry = false;
+
+    printf("    {\n");
+    printf("      \"name\": \"%s\",\n", name);
+    printf("      \"run_name\": \"%s\",\n", run_name);
+    if (aggregate_name == NULL) {
+        printf("      \"run_type\": \"iteration\",\n");
+        printf("      \"repetitions\": %u,\n", (unsigned)SDA_BENCH_REPETITIONS);
+        printf("      \"repetition_index\": %" PRIu32 ",\n", repetition_index);
+    } else {
+        printf("      \"run_type\": \"aggregate\",\n");
+        printf("      \"repetitions\": %u,\n", (unsigned)SDA_BENCH_REPETITIONS);
+        printf("      \"aggregate_name\": \"%s\",\n", aggregate_name);
+    }
+    printf("      \"iterations\": %" PRIu32 ",\n", iterations);
+    // Time per iteration with three decimals, without pulling float printf support in
+    printf("      \"real_time\": %" PRIu32 ".%03" PRIu32 ",\n", (uint32_t)(per_iter_milli_ns / 1000), (uint32_t)(per_iter_milli_ns % 1000));
+    printf("      \"cpu_time\": %" PRIu32 ".%03" PRIu32 ",\n", (uint32_t)(per_iter_milli_ns / 1000), (uint32_t)(per_iter_milli_ns % 1000));
+    printf("      \"time_unit\": \"ns\"\n");
+    printf("    }");
+}
+
+void sda_bench_fail(void)
+{
+    g_bench_failed = true;
+}
+
+void sda_bench_run(const char *name, sda_bench_fn fn, void *arg)
+{
+    uint64_t results[SDA_BENCH_REPETITIONS];
+    char aggregate_name[SDA_BENCH_NAME_MAX_SIZE];
+    uint64_t elapsed_ns;
+    uint64_t sum = 0;
+
+    g_bench_failed = false;
+
+    // All repetitions run the iteration count found by the calibration so they are comparable
+    uint32_t iterations = sda_bench_calibrate(fn, arg, &elapsed_ns);
+
+    for (uint32_t rep = 0; rep < SDA_BENCH_REPETITIONS; rep++) {
+        if (rep != 0) {
+            elapsed_ns = sda_bench_measure(fn, arg, iterations);
+        }
+        results[rep] = (elapsed_ns * 1000) / iterations;
+        sum += results[rep];
+    }
+
+    // The times of a failing iteration measure some error path, not the benchmark
+    if (g_bench_failed) {
+        if (g_bench_failed_count < SDA_BENCH_MAX_FAILED) {
+            snprintf(g_bench_failed_names[g_bench_failed_count], SDA_BENCH_NAME_MAX_SIZE, "%s", name);
+        }
+        g_bench_failed_count++;
+        return;
+    }
+
+    if (SDA_BENCH_REPETITIONS > 1) {
+        for (uint32_t rep = 0; rep < SDA_BENCH_REPETITIONS; rep++) {
+            sda_bench_print_entry(name, name, NULL, rep, iterations, results[rep]);
+        }
+    }
+
+    if (SDA_BENCH_REPETITIONS == 1) {
+        sda_bench_print_entry(name, name, NULL, 0, iterations, results[0]);
+        return;
+    }
+
+    // Insertion sort, there are only a handful of repetitions
+    for (uint32_t i = 1; i < SDA_BENCH_REPETITIONS; i++) {
+        uint64_t value = results[i];
+        uint32_t j = i;
+        while ((j > 0) && (results[j - 1] > value)) {
+            results[j] = results[j - 1];
+            j--;
+        }
+        results[j] = value;
+    }
+
+    uint64_t median = ((SDA_BENCH_REPETITIONS % 2) == 1) ? results[SDA_BENCH_REPETITIONS / 2]
+                      : ((results[(SDA_BENCH_REPETITIONS / 2) - 1] + results[SDA_BENCH_REPETITIONS / 2]) / 2);
+
+    snprintf(aggregate_name, sizeof(aggregate_name), "%s_mean", name);
+    sda_bench_print_entry(aggregate_name, name, "mean", 0, iterations, sum / SDA_BENCH_REPETITIONS);
+
+    snprintf(aggregate_name, sizeof(aggregate_name), "%s_median", name);
+    sda_bench_print_entry(aggregate_name, name, "median", 0, iterations, median);
+}
+
+void sda_bench_report_end(void)
+{
+    printf("\n  ]\n");
+    printf("}\n");
+    printf("%s\n", SDA_BENCH_REPORT_END_MARKER);
+
+    mbed_trace_config_set(g_bench_trace_config);
+
+    for (uint32_t i = 0; (i < g_bench_failed_count) && (i < SDA_BENCH_MAX_FAILED); i++) {
+        tr_warn("Benchmark %s failed, left out of the report", g_bench_failed_names[i]);
+    }
+    if (g_bench_failed_count > SDA_BENCH_MAX_FAILED) {
+        tr_warn("%" PRIu32 " more benchmarks failed, left out of the report", g_bench_failed_count - SDA_BENCH_MAX_FAILED);
+    }
+}
+
+void sda_bench_main(void)
+{
+    tr_cmdline("Secure-Device-Access benchmarks start");
+
+    sda_bench_report_begin();
+
+    sda_bench_scope_check();
+    sda_bench_dispatch();
+    sda_bench_trust_anchor();
+    sda_bench_session();
+    sda_bench_replay();
+    sda_bench_serial();
+    sda_bench_request();
+
+    sda_bench_report_end();
+
+    tr_cmdline("Secure-Device-Access benchmarks done");
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
@@ -0,0 +1,106 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_BENCH_H__
+#define __SDA_BENCH_H__
+
+#include <stdint.h>
+
+/**
+* Minimum time in milliseconds a single benchmark should run for.
+* The iteration count is scaled up until a run takes at least this long.
+*/
+#ifndef SDA_BENCH_MIN_TIME_MS
+#define SDA_BENCH_MIN_TIME_MS 100
+#endif
+
+/**
+* Number of times every benchmark is repeated. With more than one repetition the
+* report also carries "_mean" and "_median" aggregates, the median is what
+* sda_bench_gate.py compares against the baseline.
+*/
+#ifndef SDA_BENCH_REPETITIONS
+#define SDA_BENCH_REPETITIONS 5
+#endif
+
+/**
+* Results are printed between these markers so they can be cut out of the
+* serial log and fed to any Google Benchmark compatible tooling.
+*/
+#define SDA_BENCH_REPORT_BEGIN_MARKER "---- sda-bench-json-begin ----"
+#define SDA_BENCH_REPORT_END_MARKER   "---- sda-bench-json-end ----"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A single benchmark iteration */
+typedef void (*sda_bench_fn)(void *arg);
+
+/**
+* Returns a monotonic timestamp in nanoseconds.
+*/
+uint64_t sda_bench_time_ns(void);
+
+/**
+* Starts the Google Benchmark JSON report and mutes tracing for the duration of the run.
+*/
+void sda_bench_report_begin(void);
+
+/**
+* Runs a benchmark SDA_BENCH_REPETITIONS times and appends its results to the report.
+*
+* @param name[in] - Benchmark name, e.g. "BM_ScopeCheck/best/scopes:8/len:32"
+* @param fn[in] - The iteration function
+* @param arg[in] - Argument passed to every fn call
+*/
+void sda_bench_run(const char *name, sda_bench_fn fn, void *arg);
+
+/**
+* Marks the benchmark sda_bench_run() is running as failed, for iterations that
+* can tell their result is wrong. sda_bench_run() leaves a failed benchmark out
+* of the report, sda_bench_report_end() logs it.
+*/
+void sda_bench_fail(void);
+
+/**
+* Closes the report and restores tracing.
+*/
+void sda_bench_report_end(void);
+
+/**
+* Runs all the benchmark suites.
+*/
+void sda_bench_main(void);
+
+/**
+* Benchmark suites
+*/
+void sda_bench_scope_check(void);
+void sda_bench_dispatch(void);
+void sda_bench_trust_anchor(void);
+void sda_bench_session(void);
+void sda_bench_replay(void);
+void sda_bench_serial(void);
+void sda_bench_request(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_BENCH_H__
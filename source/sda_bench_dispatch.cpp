@@ -0,0 +1,82 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sda_bench.h"
+#include "sda_dispatch.h"
+
+/*
+* Operation dispatch benchmarks.
+*
+* Each benchmark maps one function callback name to its demo operation, as
+* application_callback() does for every request. Besides the supported names the
+* corpus has a prefix of a supported name and an unknown name of the same length
+* as a supported one, the two ways a lookup is rejected.
+*/
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define DISPATCH_BENCH_NAME_MAX_SIZE 64
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct dispatch_bench_case_ {
+    const char *label;
+    const char *func_name;
+} dispatch_bench_case_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static const dispatch_bench_case_s g_dispatch_bench_cases[] = {
+    { "configure", "configure" },
+    { "read-data", "read-data" },
+    { "update", "update" },
+    { "diagnostics", "diagnostics" },
+    { "restart", "restart" },
+    { "prefix", "conf" },
+    { "unknown", "reconfigure" }
+};
+
+static volatile sda_demo_operation_e g_dispatch_bench_sink;
+
+//////////////////////////////////////////////////////////
+
+static void dispatch_bench_iteration(void *arg)
+{
+    const char *func_name = (const char *)arg;
+
+    g_dispatch_bench_sink = sda_demo_operation_lookup((const uint8_t *)func_name, strlen(func_name));
+}
+
+void sda_bench_dispatch(void)
+{
+    char name[DISPATCH_BENCH_NAME_MAX_SIZE];
+
+    for (size_t i = 0; i < sizeof(g_dispatch_bench_cases) / sizeof(g_dispatch_bench_cases[0]); i++) {
+
+        snprintf(name, sizeof(name), "BM_Dispatch/%s", g_dispatch_bench_cases[i].label);
+
+        sda_bench_run(name, dispatch_bench_iteration, (void *)g_dispatch_bench_cases[i].func_name);
+    }
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
@@ -0,0 +1,124 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sda_bench.h"
+#include "sda_replay.h"
+
+/*
+* Replay protection benchmarks, every iteration is a new request so the numbers hold
+* for a sustained request rate with the filter rotating generations.
+*
+*   - BM_ReplayWindow/in_order:     session counters arriving in order
+*   - BM_ReplayWindow/reordered:    session counters shuffled within blocks of 8
+*   - BM_ReplayFilter/len:N:        digest, lookup and insert of an N byte SDA request
+*/
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define REPLAY_BENCH_SEED           0x4E9C0A11UL
+#define REPLAY_BENCH_REORDER_BLOCK  8
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct replay_bench_window_ctx_ {
+    sda_replay_window_s window;
+    uint32_t counter;
+} replay_bench_window_ctx_s;
+
+typedef struct replay_bench_filter_ctx_ {
+    sda_replay_filter_s filter;
+    uint8_t request[512];
+    size_t request_size;
+    uint32_t sequence;
+} replay_bench_filter_ctx_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static const uint8_t g_replay_bench_reorder[REPLAY_BENCH_REORDER_BLOCK] = { 2, 0, 5, 1, 7, 3, 6, 4 };
+static const size_t g_replay_bench_request_sizes[] = { 128, 512 };
+
+static replay_bench_window_ctx_s g_replay_bench_window_ctx;
+static replay_bench_filter_ctx_s g_replay_bench_filter_ctx;
+static volatile bool g_replay_bench_sink;
+
+//////////////////////////////////////////////////////////
+
+static void replay_bench_window_in_order_iteration(void *arg)
+{
+    replay_bench_window_ctx_s *ctx = (replay_bench_window_ctx_s *)arg;
+
+    g_replay_bench_sink = sda_replay_window_accept(&ctx->window, ++ctx->counter);
+}
+
+static void replay_bench_window_reordered_iteration(void *arg)
+{
+    replay_bench_window_ctx_s *ctx = (replay_bench_window_ctx_s *)arg;
+    uint32_t block = ctx->counter & ~(uint32_t)(REPLAY_BENCH_REORDER_BLOCK - 1);
+    uint32_t counter = block + g_replay_bench_reorder[ctx->counter % REPLAY_BENCH_REORDER_BLOCK] + 1;
+
+    ctx->counter++;
+    g_replay_bench_sink = sda_replay_window_accept(&ctx->window, counter);
+}
+
+static void replay_bench_filter_iteration(void *arg)
+{
+    replay_bench_filter_ctx_s *ctx = (replay_bench_filter_ctx_s *)arg;
+    uint64_t digest;
+
+    // A fresh nonce per request
+    ctx->sequence++;
+    memcpy(ctx->request, &ctx->sequence, sizeof(ctx->sequence));
+
+    digest = sda_replay_filter_digest(&ctx->filter, ctx->request, ctx->request_size);
+    g_replay_bench_sink = sda_replay_filter_contains(&ctx->filter, digest);
+    if (!g_replay_bench_sink) {
+        sda_replay_filter_insert(&ctx->filter, digest);
+    }
+}
+
+void sda_bench_replay(void)
+{
+    replay_bench_window_ctx_s *window_ctx = &g_replay_bench_window_ctx;
+    replay_bench_filter_ctx_s *filter_ctx = &g_replay_bench_filter_ctx;
+    char name[64];
+
+    sda_replay_window_init(&window_ctx->window);
+    window_ctx->counter = 0;
+    sda_bench_run("BM_ReplayWindow/in_order", replay_bench_window_in_order_iteration, window_ctx);
+
+    sda_replay_window_init(&window_ctx->window);
+    window_ctx->counter = 0;
+    sda_bench_run("BM_ReplayWindow/reordered", replay_bench_window_reordered_iteration, window_ctx);
+
+    for (size_t i = 0; i < sizeof(g_replay_bench_request_sizes) / sizeof(g_replay_bench_request_sizes[0]); i++) {
+        sda_replay_filter_init(&filter_ctx->filter, REPLAY_BENCH_SEED);
+        memset(filter_ctx->request, 0xA5, sizeof(filter_ctx->request));
+        filter_ctx->request_size = g_replay_bench_request_sizes[i];
+        filter_ctx->sequence = 0;
+
+        snprintf(name, sizeof(name), "BM_ReplayFilter/len:%u", (unsigned)filter_ctx->request_size);
+        sda_bench_run(name, replay_bench_filter_iteration, filter_ctx);
+    }
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
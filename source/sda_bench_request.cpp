@@ -0,0 +1,170 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sda_bench.h"
+#include "sda_status.h"
+#include "secure_device_access.h"
+#include "sda_scope_check.h"
+#include "mbed-trace/mbed_trace.h"
+
+/*
+* End-to-end request benchmark.
+*
+* Feeds a request recorded from the host, the "benchmark-request" hex string,
+* through sda_operation_process() as process_request_fetch_response() does:
+* frame decoding, access token verification against the trust anchor, the scope
+* check and the response encoding. The callback stops short of running the demo
+* operation, its LED emulation would dominate the time.
+*
+* The request has to be issued for this device and trust anchor, it is recorded
+* with the host tooling while talking to the same device.
+*/
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP                     "sdae"
+
+#define REQUEST_BENCH_MAX_SIZE          2048
+#define REQUEST_BENCH_RESPONSE_SIZE     (SDA_RESPONSE_HEADER_SIZE + 64)
+
+///////////////////////// GLOBALS /////////////////////////
+
+static uint8_t g_request_bench_request[REQUEST_BENCH_MAX_SIZE];
+static size_t g_request_bench_request_size;
+static uint8_t g_request_bench_response[REQUEST_BENCH_RESPONSE_SIZE];
+static const uint8_t g_request_bench_response_data[] = "This is app data buffer";
+static sda_status_e g_request_bench_status;
+
+//////////////////////////////////////////////////////////
+
+#ifdef MBED_CONF_APP_BENCHMARK_REQUEST
+static int request_bench_hex_nibble(char c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    }
+    if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static bool request_bench_hex_decode(const char *hex, uint8_t *out, size_t out_max_size, size_t *out_size)
+{
+    size_t hex_size = strlen(hex);
+
+    if (((hex_size % 2) != 0) || ((hex_size / 2) > out_max_size)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < hex_size / 2; i++) {
+        int high = request_bench_hex_nibble(hex[2 * i]);
+        int low = request_bench_hex_nibble(hex[(2 * i) + 1]);
+
+        if ((high < 0) || (low < 0)) {
+            return false;
+        }
+        out[i] = (uint8_t)((high << 4) | low);
+    }
+
+    *out_size = hex_size / 2;
+    return true;
+}
+#endif
+
+static sda_status_e request_bench_scope_get_next(void *scope_list, const uint8_t **scope_out, size_t *scope_size_out)
+{
+    return sda_scope_get_next((sda_operation_ctx_h)scope_list, scope_out, scope_size_out);
+}
+
+// application_callback() without the replay and revocation state and without running the operation
+static sda_status_e request_bench_callback(sda_operation_ctx_h handle, void *callback_param)
+{
+    sda_command_type_e command_type = SDA_OPERATION_NONE;
+    const uint8_t *func_name = NULL;
+    size_t func_name_size = 0;
+    sda_status_e status;
+
+    (void)callback_param;
+
+    status = sda_command_type_get(handle, &command_type);
+    if (status != SDA_STATUS_SUCCESS) {
+        return status;
+    }
+    if (command_type != SDA_OPERATION_FUNC_CALL) {
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    status = sda_func_call_name_get(handle, &func_name, &func_name_size);
+    if (status != SDA_STATUS_SUCCESS) {
+        return status;
+    }
+
+    status = sda_scope_check(request_bench_scope_get_next, (void *)handle, func_name, func_name_size);
+    if (status != SDA_STATUS_SUCCESS) {
+        return status;
+    }
+
+    return sda_response_data_set(handle, g_request_bench_response_data, sizeof(g_request_bench_response_data));
+}
+
+static void request_bench_iteration(void *arg)
+{
+    size_t response_size = 0;
+
+    (void)arg;
+    g_request_bench_status = sda_operation_process(g_request_bench_request, g_request_bench_request_size, request_bench_callback, NULL,
+                                                   g_request_bench_response, sizeof(g_request_bench_response), &response_size);
+    if (g_request_bench_status != SDA_STATUS_SUCCESS) {
+        sda_bench_fail();
+    }
+}
+
+void sda_bench_request(void)
+{
+#ifdef MBED_CONF_APP_BENCHMARK_REQUEST
+    if (!request_bench_hex_decode(MBED_CONF_APP_BENCHMARK_REQUEST, g_request_bench_request, sizeof(g_request_bench_request),
+                                  &g_request_bench_request_size)) {
+        tr_error("Recorded benchmark request is not a hex string of at most %u bytes", (unsigned)REQUEST_BENCH_MAX_SIZE);
+        return;
+    }
+
+    // A request for another device, trust anchor or an expired token only measures the rejection
+    request_bench_iteration(NULL);
+    if (g_request_bench_status != SDA_STATUS_SUCCESS) {
+        tr_error("Recorded benchmark request rejected (%u), not benchmarked", g_request_bench_status);
+        return;
+    }
+
+    // Only reported when every timed call was accepted too. A request whose nonce
+    // the device used up on the first call is rejected from then on.
+    sda_bench_run("BM_Request/process", request_bench_iteration, NULL);
+#else
+    tr_info("No recorded request (\"benchmark-request\"), end-to-end benchmark skipped");
+#endif
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
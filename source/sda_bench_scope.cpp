@@ -0,0 +1,174 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sda_bench.h"
+#include "sda_scope_check.h"
+
+/*
+* Scope check benchmark corpus.
+*
+* Each benchmark runs sda_scope_check() over a synthetic operation context: a scope
+* list generated from a fixed seed, so results are comparable between builds.
+* The corpus covers the token shapes that matter for the check:
+*   - best:    the matching scope is the first one
+*   - worst:   the matching scope is the last one and all others have the same
+*              length and differ only in their last byte (full memcmp each time)
+*   - deny:    same as worst, but no scope matches
+*   - invalid: every other scope is empty or NULL (the tr_warn path), match is last
+*/
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define SCOPE_BENCH_MAX_SCOPES      32
+#define SCOPE_BENCH_MAX_SCOPE_SIZE  64
+#define SCOPE_BENCH_SEED            0x5DA5C09EUL
+#define SCOPE_BENCH_NAME_MAX_SIZE   64
+
+typedef enum {
+    SCOPE_BENCH_BEST,
+    SCOPE_BENCH_WORST,
+    SCOPE_BENCH_DENY,
+    SCOPE_BENCH_INVALID
+} scope_bench_case_e;
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct scope_bench_ctx_ {
+    const uint8_t *scopes[SCOPE_BENCH_MAX_SCOPES];
+    size_t scope_sizes[SCOPE_BENCH_MAX_SCOPES];
+    size_t scope_count;
+    size_t next_scope;
+    const uint8_t *func_name;
+    size_t func_name_size;
+} scope_bench_ctx_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static const char *g_scope_bench_case_names[] = { "best", "worst", "deny", "invalid" };
+static const size_t g_scope_bench_counts[] = { 1, 8, 32 };
+static const size_t g_scope_bench_sizes[] = { 8, 32, 64 };
+
+static uint8_t g_scope_bench_storage[SCOPE_BENCH_MAX_SCOPES][SCOPE_BENCH_MAX_SCOPE_SIZE];
+static uint8_t g_scope_bench_func_name[SCOPE_BENCH_MAX_SCOPE_SIZE];
+static scope_bench_ctx_s g_scope_bench_ctx;
+static volatile sda_status_e g_scope_bench_sink;
+
+//////////////////////////////////////////////////////////
+
+static uint32_t scope_bench_rand(uint32_t *state)
+{
+    // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void scope_bench_fill(uint8_t *buf, size_t size, uint32_t *rand_state)
+{
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789-";
+
+    for (size_t i = 0; i < size; i++) {
+        buf[i] = (uint8_t)alphabet[scope_bench_rand(rand_state) % (sizeof(alphabet) - 1)];
+    }
+}
+
+static void scope_bench_build(scope_bench_ctx_s *ctx, scope_bench_case_e bench_case, size_t scope_count, size_t scope_size)
+{
+    uint32_t rand_state = SCOPE_BENCH_SEED;
+    size_t match_index = (bench_case == SCOPE_BENCH_BEST) ? 0 : (scope_count - 1);
+
+    memset(ctx, 0, sizeof(*ctx));
+
+    // The function name all scopes are compared against
+    scope_bench_fill(g_scope_bench_func_name, scope_size, &rand_state);
+    ctx->func_name = g_scope_bench_func_name;
+    ctx->func_name_size = scope_size;
+
+    for (size_t i = 0; i < scope_count; i++) {
+
+        if ((bench_case == SCOPE_BENCH_INVALID) && (i != match_index) && ((i % 2) == 0)) {
+            // Alternate between NULL and zero length scopes
+            ctx->scopes[i] = ((i % 4) == 0) ? NULL : g_scope_bench_storage[i];
+            ctx->scope_sizes[i] = 0;
+            continue;
+        }
+
+        // Near misses: same size, differ only in the last byte
+        memcpy(g_scope_bench_storage[i], g_scope_bench_func_name, scope_size);
+        if ((i != match_index) || (bench_case == SCOPE_BENCH_DENY)) {
+            g_scope_bench_storage[i][scope_size - 1] ^= 0x20;
+        }
+
+        ctx->scopes[i] = g_scope_bench_storage[i];
+        ctx->scope_sizes[i] = scope_size;
+    }
+
+    ctx->scope_count = scope_count;
+}
+
+static sda_status_e scope_bench_get_next(void *scope_list, const uint8_t **scope_out, size_t *scope_size_out)
+{
+    scope_bench_ctx_s *ctx = (scope_bench_ctx_s *)scope_list;
+
+    if (ctx->next_scope >= ctx->scope_count) {
+        return SDA_STATUS_NO_MORE_SCOPES;
+    }
+
+    *scope_out = ctx->scopes[ctx->next_scope];
+    *scope_size_out = ctx->scope_sizes[ctx->next_scope];
+    ctx->next_scope++;
+
+    return SDA_STATUS_SUCCESS;
+}
+
+static void scope_bench_iteration(void *arg)
+{
+    scope_bench_ctx_s *ctx = (scope_bench_ctx_s *)arg;
+
+    ctx->next_scope = 0;
+    g_scope_bench_sink = sda_scope_check(scope_bench_get_next, ctx, ctx->func_name, ctx->func_name_size);
+}
+
+void sda_bench_scope_check(void)
+{
+    char name[SCOPE_BENCH_NAME_MAX_SIZE];
+
+    for (size_t c = 0; c < sizeof(g_scope_bench_case_names) / sizeof(g_scope_bench_case_names[0]); c++) {
+        for (size_t n = 0; n < sizeof(g_scope_bench_counts) / sizeof(g_scope_bench_counts[0]); n++) {
+            for (size_t s = 0; s < sizeof(g_scope_bench_sizes) / sizeof(g_scope_bench_sizes[0]); s++) {
+
+                scope_bench_build(&g_scope_bench_ctx, (scope_bench_case_e)c, g_scope_bench_counts[n], g_scope_bench_sizes[s]);
+
+                snprintf(name, sizeof(name), "BM_ScopeCheck/%s/scopes:%u/len:%u", g_scope_bench_case_names[c],
+                         (unsigned)g_scope_bench_counts[n], (unsigned)g_scope_bench_sizes[s]);
+
+                sda_bench_run(name, scope_bench_iteration, &g_scope_bench_ctx);
+            }
+        }
+    }
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
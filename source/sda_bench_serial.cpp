@@ -0,0 +1,182 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sda_bench.h"
+#include "sda_ring.h"
+
+/*
+* Serial RX ring benchmarks, the CPU time to receive one framed SDA message:
+*
+*   token (8) | message size (4) | message | signature (32)
+*
+* The producer hands the frame over the way the UART does at each rate, one byte per
+* RX interrupt at 115200 baud and FIFO bursts of SERIAL_BENCH_BURST bytes at 921600
+* baud. The reader picks up whatever arrived after each interrupt, as the transport
+* does when it is woken.
+*
+*   - BM_SerialRing/baud:B/len:N
+*
+* The wire needs (N + 44) * 10 / B seconds per frame, e.g. 92.7 ms for 1024 bytes at
+* 115200 and 11.6 ms at 921600, the time reported here is what the CPU spends of it.
+*/
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define SERIAL_BENCH_TOKEN          "mbeddbap"
+#define SERIAL_BENCH_TOKEN_SIZE     (sizeof(SERIAL_BENCH_TOKEN) - 1)
+#define SERIAL_BENCH_SIGNATURE_SIZE 32
+#define SERIAL_BENCH_MAX_MESSAGE    1024
+#define SERIAL_BENCH_HEADER_SIZE    (SERIAL_BENCH_TOKEN_SIZE + 4)
+#define SERIAL_BENCH_MAX_FRAME      (SERIAL_BENCH_HEADER_SIZE + SERIAL_BENCH_MAX_MESSAGE + SERIAL_BENCH_SIGNATURE_SIZE)
+#define SERIAL_BENCH_BURST          16
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct serial_bench_ctx_ {
+    sda_ring_s ring;
+    uint8_t ring_buffer[SDA_RING_SIZE];
+    uint8_t frame[SERIAL_BENCH_MAX_FRAME];
+    size_t frame_size;
+    size_t burst;
+
+    // Reader state
+    sda_ring_token_scan_s scan;
+    bool token_found;
+    uint8_t size_bytes[4];
+    uint8_t message[SERIAL_BENCH_MAX_MESSAGE];
+    uint8_t signature[SERIAL_BENCH_SIGNATURE_SIZE];
+    size_t received;
+} serial_bench_ctx_s;
+
+typedef struct serial_bench_case_ {
+    uint32_t baud;
+    size_t burst;
+} serial_bench_case_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static const serial_bench_case_s g_serial_bench_cases[] = { { 115200, 1 }, { 921600, SERIAL_BENCH_BURST } };
+static const size_t g_serial_bench_lengths[] = { 256, SERIAL_BENCH_MAX_MESSAGE };
+
+static serial_bench_ctx_s g_serial_bench_ctx;
+static volatile size_t g_serial_bench_sink;
+
+//////////////////////////////////////////////////////////
+
+static void serial_bench_frame_build(serial_bench_ctx_s *ctx, size_t message_size)
+{
+    uint8_t *p = ctx->frame;
+
+    memcpy(p, SERIAL_BENCH_TOKEN, SERIAL_BENCH_TOKEN_SIZE);
+    p += SERIAL_BENCH_TOKEN_SIZE;
+    *p++ = (uint8_t)(message_size >> 24);
+    *p++ = (uint8_t)(message_size >> 16);
+    *p++ = (uint8_t)(message_size >> 8);
+    *p++ = (uint8_t)message_size;
+    for (size_t i = 0; i < message_size + SERIAL_BENCH_SIGNATURE_SIZE; i++) {
+        *p++ = (uint8_t)(i * 31);
+    }
+    ctx->frame_size = (size_t)(p - ctx->frame);
+}
+
+// Reads what is there, returns "true" once the whole frame is in
+static bool serial_bench_reader_step(serial_bench_ctx_s *ctx)
+{
+    size_t message_size;
+
+    if (!ctx->token_found) {
+        ctx->token_found = sda_ring_token_scan(&ctx->ring, &ctx->scan);
+        if (!ctx->token_found) {
+            return false;
+        }
+    }
+
+    if (ctx->received < sizeof(ctx->size_bytes)) {
+        ctx->received += sda_ring_read(&ctx->ring, &ctx->size_bytes[ctx->received], sizeof(ctx->size_bytes) - ctx->received);
+        if (ctx->received < sizeof(ctx->size_bytes)) {
+            return false;
+        }
+    }
+
+    message_size = ((size_t)ctx->size_bytes[0] << 24) | ((size_t)ctx->size_bytes[1] << 16) | ((size_t)ctx->size_bytes[2] << 8) | ctx->size_bytes[3];
+    if (ctx->received < sizeof(ctx->size_bytes) + message_size) {
+        size_t offset = ctx->received - sizeof(ctx->size_bytes);
+
+        ctx->received += sda_ring_read(&ctx->ring, &ctx->message[offset], message_size - offset);
+        if (ctx->received < sizeof(ctx->size_bytes) + message_size) {
+            return false;
+        }
+    }
+
+    if (ctx->received < sizeof(ctx->size_bytes) + message_size + SERIAL_BENCH_SIGNATURE_SIZE) {
+        size_t offset = ctx->received - sizeof(ctx->size_bytes) - message_size;
+
+        ctx->received += sda_ring_read(&ctx->ring, &ctx->signature[offset], SERIAL_BENCH_SIGNATURE_SIZE - offset);
+    }
+
+    return (ctx->received == sizeof(ctx->size_bytes) + message_size + SERIAL_BENCH_SIGNATURE_SIZE);
+}
+
+static void serial_bench_iteration(void *arg)
+{
+    serial_bench_ctx_s *ctx = (serial_bench_ctx_s *)arg;
+    bool done = false;
+
+    sda_ring_token_scan_init(&ctx->scan, (const uint8_t *)SERIAL_BENCH_TOKEN, SERIAL_BENCH_TOKEN_SIZE);
+    ctx->token_found = false;
+    ctx->received = 0;
+
+    for (size_t offset = 0; offset < ctx->frame_size; offset += ctx->burst) {
+        size_t burst = ctx->frame_size - offset;
+
+        if (burst > ctx->burst) {
+            burst = ctx->burst;
+        }
+
+        // RX interrupt, then the woken reader
+        sda_ring_push(&ctx->ring, &ctx->frame[offset], burst);
+        done = serial_bench_reader_step(ctx);
+    }
+
+    g_serial_bench_sink = done ? ctx->received : 0;
+}
+
+void sda_bench_serial(void)
+{
+    serial_bench_ctx_s *ctx = &g_serial_bench_ctx;
+    char name[64];
+
+    sda_ring_init(&ctx->ring, ctx->ring_buffer, sizeof(ctx->ring_buffer));
+
+    for (size_t i = 0; i < sizeof(g_serial_bench_cases) / sizeof(g_serial_bench_cases[0]); i++) {
+        for (size_t j = 0; j < sizeof(g_serial_bench_lengths) / sizeof(g_serial_bench_lengths[0]); j++) {
+            serial_bench_frame_build(ctx, g_serial_bench_lengths[j]);
+            ctx->burst = g_serial_bench_cases[i].burst;
+
+            snprintf(name, sizeof(name), "BM_SerialRing/baud:%u/len:%u", (unsigned)g_serial_bench_cases[i].baud, (unsigned)g_serial_bench_lengths[j]);
+            sda_bench_run(name, serial_bench_iteration, ctx);
+        }
+    }
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
@@ -0,0 +1,234 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sda_bench.h"
+#include "sda_session.h"
+#include "mbed-trace/mbed_trace.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/sha256.h"
+
+/*
+* Session resumption benchmarks.
+*
+*   - BM_SessionOpen:              the device side of "open-session", scope copy and ECDH
+*   - BM_SessionRequest/roundtrip: a follow-up request, the client request MAC, the device
+*                                  authentication, scope check and response MAC
+*
+* Compare BM_SessionRequest/roundtrip with BM_TrustAnchorVerify/resident, the signature
+* verification every request pays without a session.
+*/
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP                 "sdae"
+
+#define SESSION_BENCH_SEED          0x5E551011UL
+#define SESSION_BENCH_FRAME_SIZE    128
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct session_bench_ctx_ {
+    size_t next_scope;
+    uint8_t client_public_key[SDA_SESSION_PUBLIC_KEY_SIZE];
+    uint8_t open_response[SDA_SESSION_OPEN_RESPONSE_SIZE];
+    uint8_t key[SDA_SESSION_KEY_SIZE];
+    uint32_t counter;
+    uint8_t request[SESSION_BENCH_FRAME_SIZE];
+    uint8_t response[SESSION_BENCH_FRAME_SIZE];
+} session_bench_ctx_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static const char *const g_session_bench_scopes[] = { SDA_SESSION_OPEN_FUNC_NAME, "read-data", "configure", "diagnostics" };
+
+static session_bench_ctx_s g_session_bench_ctx;
+static volatile sda_status_e g_session_bench_sink;
+
+//////////////////////////////////////////////////////////
+
+// Deterministic byte source (xorshift32), only used to build the client key
+static int session_bench_rand(void *state, unsigned char *output, size_t len)
+{
+    uint32_t *x = (uint32_t *)state;
+
+    for (size_t i = 0; i < len; i++) {
+        *x ^= *x << 13;
+        *x ^= *x >> 17;
+        *x ^= *x << 5;
+        output[i] = (unsigned char)*x;
+    }
+    return 0;
+}
+
+static sda_status_e session_bench_scope_get_next(void *scope_list, const uint8_t **scope_out, size_t *scope_size_out)
+{
+    session_bench_ctx_s *ctx = (session_bench_ctx_s *)scope_list;
+
+    if (ctx->next_scope >= sizeof(g_session_bench_scopes) / sizeof(g_session_bench_scopes[0])) {
+        return SDA_STATUS_NO_MORE_SCOPES;
+    }
+
+    *scope_out = (const uint8_t *)g_session_bench_scopes[ctx->next_scope];
+    *scope_size_out = strlen(g_session_bench_scopes[ctx->next_scope]);
+    ctx->next_scope++;
+    return SDA_STATUS_SUCCESS;
+}
+
+// Client side of the scope hash, see sda_session.h
+static void session_bench_scopes_hash(uint8_t *hash)
+{
+    mbedtls_sha256_context sha256;
+
+    mbedtls_sha256_init(&sha256);
+    mbedtls_sha256_starts_ret(&sha256, 0);
+    for (size_t i = 0; i < sizeof(g_session_bench_scopes) / sizeof(g_session_bench_scopes[0]); i++) {
+        size_t scope_size = strlen(g_session_bench_scopes[i]);
+        uint8_t scope_size_be[2] = { (uint8_t)(scope_size >> 8), (uint8_t)scope_size };
+
+        mbedtls_sha256_update_ret(&sha256, scope_size_be, sizeof(scope_size_be));
+        mbedtls_sha256_update_ret(&sha256, (const uint8_t *)g_session_bench_scopes[i], scope_size);
+    }
+    mbedtls_sha256_finish_ret(&sha256, hash);
+    mbedtls_sha256_free(&sha256);
+}
+
+static sda_status_e session_bench_open(session_bench_ctx_s *ctx)
+{
+    ctx->next_scope = 0;
+    return sda_session_open(session_bench_scope_get_next, ctx, ctx->client_public_key, sizeof(ctx->client_public_key), 0, ctx->open_response);
+}
+
+// Opens a session and derives the client copy of the session key
+static bool session_bench_build(session_bench_ctx_s *ctx)
+{
+    uint32_t rand_state = SESSION_BENCH_SEED;
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point client_point, device_point;
+    mbedtls_mpi client_secret, shared;
+    uint8_t shared_secret[32];
+    uint8_t scopes_hash[32];
+    const uint8_t *response = ctx->open_response;
+    uint32_t lifetime_sec;
+    size_t point_size = 0;
+    int mbedtls_status;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&client_point);
+    mbedtls_ecp_point_init(&device_point);
+    mbedtls_mpi_init(&client_secret);
+    mbedtls_mpi_init(&shared);
+
+    mbedtls_status = mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1);
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_ecdh_gen_public(&grp, &client_secret, &client_point, session_bench_rand, &rand_state);
+    }
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_ecp_point_write_binary(&grp, &client_point, MBEDTLS_ECP_PF_UNCOMPRESSED, &point_size,
+                                                        ctx->client_public_key, sizeof(ctx->client_public_key));
+    }
+    if ((mbedtls_status == 0) && (session_bench_open(ctx) != SDA_STATUS_SUCCESS)) {
+        mbedtls_status = -1;
+    }
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_ecp_point_read_binary(&grp, &device_point, &response[SDA_SESSION_ID_SIZE + 4], SDA_SESSION_PUBLIC_KEY_SIZE);
+    }
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_ecdh_compute_shared(&grp, &shared, &device_point, &client_secret, session_bench_rand, &rand_state);
+    }
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_mpi_write_binary(&shared, shared_secret, sizeof(shared_secret));
+    }
+    if (mbedtls_status == 0) {
+        lifetime_sec = ((uint32_t)response[SDA_SESSION_ID_SIZE] << 24) | ((uint32_t)response[SDA_SESSION_ID_SIZE + 1] << 16) |
+                       ((uint32_t)response[SDA_SESSION_ID_SIZE + 2] << 8) | response[SDA_SESSION_ID_SIZE + 3];
+        session_bench_scopes_hash(scopes_hash);
+        if (!sda_session_key_derive(shared_secret, sizeof(shared_secret), response, scopes_hash, lifetime_sec, ctx->key)) {
+            mbedtls_status = -1;
+        }
+    }
+
+    mbedtls_mpi_free(&shared);
+    mbedtls_mpi_free(&client_secret);
+    mbedtls_ecp_point_free(&device_point);
+    mbedtls_ecp_point_free(&client_point);
+    mbedtls_ecp_group_free(&grp);
+    ctx->counter = 0;
+    return (mbedtls_status == 0);
+}
+
+static void session_bench_open_iteration(void *arg)
+{
+    g_session_bench_sink = session_bench_open((session_bench_ctx_s *)arg);
+}
+
+static void session_bench_roundtrip_iteration(void *arg)
+{
+    session_bench_ctx_s *ctx = (session_bench_ctx_s *)arg;
+    static const uint8_t func_name[] = "read-data";
+    sda_session_request_s request;
+    size_t request_size = 0;
+    size_t response_size = 0;
+    sda_status_e status;
+
+    request.counter = 0;
+
+    // Client
+    ctx->counter++;
+    sda_session_request_write(ctx->key, ctx->open_response, ctx->counter, func_name, sizeof(func_name) - 1, NULL, 0,
+                              ctx->request, sizeof(ctx->request), &request_size);
+
+    // Device
+    status = sda_session_request_authenticate(ctx->request, request_size, &request);
+    if (status == SDA_STATUS_SUCCESS) {
+        status = sda_session_scope_check(request.func_name, request.func_name_size);
+    }
+    sda_session_response_write(request.counter, status, NULL, 0, ctx->response, sizeof(ctx->response), &response_size);
+
+    g_session_bench_sink = status;
+}
+
+void sda_bench_session(void)
+{
+    session_bench_ctx_s *ctx = &g_session_bench_ctx;
+
+    // Replaces the open session, if any
+    if (!session_bench_build(ctx)) {
+        tr_error("Failed building session benchmark fixture");
+        sda_session_close();
+        return;
+    }
+
+    session_bench_roundtrip_iteration(ctx);
+    if (g_session_bench_sink != SDA_STATUS_SUCCESS) {
+        tr_error("Session benchmark fixture does not authenticate");
+        sda_session_close();
+        return;
+    }
+
+    sda_bench_run("BM_SessionRequest/roundtrip", session_bench_roundtrip_iteration, ctx);
+    sda_bench_run("BM_SessionOpen", session_bench_open_iteration, ctx);
+
+    sda_session_close();
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
@@ -0,0 +1,225 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sda_bench.h"
+#include "sda_trust_anchor.h"
+#include "mbed-trace/mbed_trace.h"
+
+/*
+* Trust anchor verification benchmarks.
+*
+* P-256 trust anchors and a signature of the last one are generated from a fixed
+* seed. A single trust anchor is verified:
+*   - parse_each: the trust anchor is parsed and its tables are precomputed for
+*                 every verification, as when it is fetched per token
+*   - resident:   verification with a context loaded once
+* and a set of TA_BENCH_SET_COUNT trust anchors, as during key rotation:
+*   - try_each:   every resident context is tried until the signature verifies
+*   - indexed:    the resident set is searched by key ID, one verification
+*/
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP                 "sdae"
+
+#define TA_BENCH_SEED               0x7A5EED01UL
+#define TA_BENCH_P256_SIZE          32
+#define TA_BENCH_SET_COUNT          ((SDA_TRUST_ANCHOR_MAX_COUNT < 4) ? SDA_TRUST_ANCHOR_MAX_COUNT : 4)
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct ta_bench_ctx_ {
+    uint8_t ders[TA_BENCH_SET_COUNT][SDA_TRUST_ANCHOR_MAX_DER_SIZE];
+    size_t der_sizes[TA_BENCH_SET_COUNT];
+    uint8_t key_id[SDA_TRUST_ANCHOR_KEY_ID_SIZE];     // Of the signing (last) trust anchor
+    uint8_t hash[TA_BENCH_P256_SIZE];
+    uint8_t signature[2 * TA_BENCH_P256_SIZE];
+    sda_trust_anchor_s resident[TA_BENCH_SET_COUNT];
+} ta_bench_ctx_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+// SubjectPublicKeyInfo header of an uncompressed P-256 point
+static const uint8_t g_ta_bench_spki_prefix[] = {
+    0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01,
+    0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00
+};
+
+static ta_bench_ctx_s g_ta_bench_ctx;
+static volatile bool g_ta_bench_sink;
+
+//////////////////////////////////////////////////////////
+
+// Deterministic byte source (xorshift32), only used to build the fixture
+static int ta_bench_rand(void *state, unsigned char *output, size_t len)
+{
+    uint32_t *x = (uint32_t *)state;
+
+    for (size_t i = 0; i < len; i++) {
+        *x ^= *x << 13;
+        *x ^= *x >> 17;
+        *x ^= *x << 5;
+        output[i] = (unsigned char)*x;
+    }
+    return 0;
+}
+
+// Generates a trust anchor, the hash is signed with it when signature is not NULL
+static bool ta_bench_build_key(uint32_t *rand_state, uint8_t *der, size_t *der_size, const uint8_t *hash, uint8_t *signature)
+{
+    mbedtls_ecp_keypair key;
+    mbedtls_mpi r, s;
+    size_t point_size = 0;
+    int mbedtls_status;
+
+    mbedtls_ecp_keypair_init(&key);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    mbedtls_status = mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_SECP256R1, &key, ta_bench_rand, rand_state);
+    if (mbedtls_status == 0) {
+        memcpy(der, g_ta_bench_spki_prefix, sizeof(g_ta_bench_spki_prefix));
+        mbedtls_status = mbedtls_ecp_point_write_binary(&key.grp, &key.Q, MBEDTLS_ECP_PF_UNCOMPRESSED, &point_size,
+                                                        der + sizeof(g_ta_bench_spki_prefix),
+                                                        SDA_TRUST_ANCHOR_MAX_DER_SIZE - sizeof(g_ta_bench_spki_prefix));
+        *der_size = sizeof(g_ta_bench_spki_prefix) + point_size;
+    }
+    if ((mbedtls_status == 0) && (signature != NULL)) {
+        mbedtls_status = mbedtls_ecdsa_sign(&key.grp, &r, &s, &key.d, hash, TA_BENCH_P256_SIZE, ta_bench_rand, rand_state);
+        if (mbedtls_status == 0) {
+            mbedtls_status = mbedtls_mpi_write_binary(&r, signature, TA_BENCH_P256_SIZE);
+        }
+        if (mbedtls_status == 0) {
+            mbedtls_status = mbedtls_mpi_write_binary(&s, signature + TA_BENCH_P256_SIZE, TA_BENCH_P256_SIZE);
+        }
+    }
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_keypair_free(&key);
+    return (mbedtls_status == 0);
+}
+
+static bool ta_bench_build(ta_bench_ctx_s *ctx)
+{
+    uint32_t rand_state = TA_BENCH_SEED;
+    const size_t last = TA_BENCH_SET_COUNT - 1;
+
+    ta_bench_rand(&rand_state, ctx->hash, sizeof(ctx->hash));
+
+    for (size_t i = 0; i < TA_BENCH_SET_COUNT; i++) {
+        if (!ta_bench_build_key(&rand_state, ctx->ders[i], &ctx->der_sizes[i], ctx->hash, (i == last) ? ctx->signature : NULL)) {
+            return false;
+        }
+    }
+
+    return sda_trust_anchor_key_id(ctx->ders[last], ctx->der_sizes[last], ctx->key_id);
+}
+
+static void ta_bench_parse_each_iteration(void *arg)
+{
+    ta_bench_ctx_s *ctx = (ta_bench_ctx_s *)arg;
+    sda_trust_anchor_s trust_anchor;
+
+    const size_t last = TA_BENCH_SET_COUNT - 1;
+
+    sda_trust_anchor_init(&trust_anchor);
+    g_ta_bench_sink = sda_trust_anchor_load_der(&trust_anchor, ctx->ders[last], ctx->der_sizes[last]) &&
+                      sda_trust_anchor_verify(&trust_anchor, ctx->hash, sizeof(ctx->hash), ctx->signature, sizeof(ctx->signature));
+    sda_trust_anchor_free(&trust_anchor);
+}
+
+static void ta_bench_resident_iteration(void *arg)
+{
+    ta_bench_ctx_s *ctx = (ta_bench_ctx_s *)arg;
+
+    g_ta_bench_sink = sda_trust_anchor_verify(&ctx->resident[TA_BENCH_SET_COUNT - 1], ctx->hash, sizeof(ctx->hash),
+                                              ctx->signature, sizeof(ctx->signature));
+}
+
+static void ta_bench_try_each_iteration(void *arg)
+{
+    ta_bench_ctx_s *ctx = (ta_bench_ctx_s *)arg;
+    bool verified = false;
+
+    for (size_t i = 0; (i < TA_BENCH_SET_COUNT) && !verified; i++) {
+        verified = sda_trust_anchor_verify(&ctx->resident[i], ctx->hash, sizeof(ctx->hash), ctx->signature, sizeof(ctx->signature));
+    }
+    g_ta_bench_sink = verified;
+}
+
+static void ta_bench_indexed_iteration(void *arg)
+{
+    ta_bench_ctx_s *ctx = (ta_bench_ctx_s *)arg;
+
+    g_ta_bench_sink = sda_trust_anchor_set_verify(ctx->key_id, sizeof(ctx->key_id), ctx->hash, sizeof(ctx->hash),
+                                                  ctx->signature, sizeof(ctx->signature));
+}
+
+static void ta_bench_release(ta_bench_ctx_s *ctx)
+{
+    for (size_t i = 0; i < TA_BENCH_SET_COUNT; i++) {
+        sda_trust_anchor_free(&ctx->resident[i]);
+    }
+    sda_trust_anchor_set_free();
+}
+
+void sda_bench_trust_anchor(void)
+{
+    ta_bench_ctx_s *ctx = &g_ta_bench_ctx;
+    char name[64];
+
+    if (!ta_bench_build(ctx)) {
+        tr_error("Failed building trust anchor benchmark fixture");
+        return;
+    }
+
+    for (size_t i = 0; i < TA_BENCH_SET_COUNT; i++) {
+        sda_trust_anchor_init(&ctx->resident[i]);
+        if (!sda_trust_anchor_load_der(&ctx->resident[i], ctx->ders[i], ctx->der_sizes[i]) ||
+                !sda_trust_anchor_set_add_der(ctx->ders[i], ctx->der_sizes[i])) {
+            tr_error("Failed loading trust anchor benchmark fixture");
+            ta_bench_release(ctx);
+            return;
+        }
+    }
+
+    ta_bench_indexed_iteration(ctx);
+    if (!g_ta_bench_sink) {
+        tr_error("Trust anchor benchmark fixture does not verify");
+        ta_bench_release(ctx);
+        return;
+    }
+
+    sda_bench_run("BM_TrustAnchorVerify/parse_each", ta_bench_parse_each_iteration, ctx);
+    sda_bench_run("BM_TrustAnchorVerify/resident", ta_bench_resident_iteration, ctx);
+
+    snprintf(name, sizeof(name), "BM_TrustAnchorSet/try_each/anchors:%u", (unsigned)TA_BENCH_SET_COUNT);
+    sda_bench_run(name, ta_bench_try_each_iteration, ctx);
+    snprintf(name, sizeof(name), "BM_TrustAnchorSet/indexed/anchors:%u", (unsigned)TA_BENCH_SET_COUNT);
+    sda_bench_run(name, ta_bench_indexed_iteration, ctx);
+
+    ta_bench_release(ctx);
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
@@ -0,0 +1,471 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_SDA_COAP == 1
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "sda_comm_coap.h"
+#include "mcc_common_setup.h"
+#include "mbed-trace/mbed_trace.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP           "sdae"
+
+//////////////////////////////////////////////////////////
+
+static void *coap_malloc(uint16_t size)
+{
+    return malloc(size);
+}
+
+static void coap_free(void *ptr)
+{
+    free(ptr);
+}
+
+// sn-coap keeps time in seconds
+static uint32_t coap_time(void)
+{
+    return (uint32_t)(pal_osKernelSysTick() / pal_osKernelSysTickFrequency());
+}
+
+FtcdCommCoap::FtcdCommCoap(ftcd_comm_network_endianness_e network_endianness, const uint8_t *header_token, bool use_signature,
+                           uint32_t interface_index, uint16_t port)
+    : FtcdCommBase(network_endianness, header_token, use_signature), _network_endianness(network_endianness),
+      _interface_index(interface_index), _port(port), _socket(0), _coap(NULL), _loss_state(1), _disconnect_countdown(SDA_COAP_DISCONNECT_EVERY),
+      _link_down(false), _link_tracked(false), _request(NULL),
+      _rx_size(0), _rx_offset(0), _tx_size(0)
+{
+    memcpy(_header_token, header_token, sizeof(_header_token));
+    memset(&_peer, 0, sizeof(_peer));
+    _peer.addr_ptr = _peer_addr;
+}
+
+FtcdCommCoap::~FtcdCommCoap()
+{
+}
+
+bool FtcdCommCoap::_socket_open(void)
+{
+    palSocketAddress_t address;
+    palIpV4Addr_t any_addr = { 0, 0, 0, 0 };
+    int timeout_ms = SDA_COAP_RX_TIMEOUT_MS;
+    palStatus_t pal_status;
+
+    pal_status = pal_socket(PAL_AF_INET, PAL_SOCK_DGRAM, false, _interface_index, &_socket);
+    if (pal_status != PAL_SUCCESS) {
+        tr_error("Failed creating CoAP socket (0x%x)", (unsigned)pal_status);
+        return false;
+    }
+
+    memset(&address, 0, sizeof(address));
+    pal_status = pal_setSockAddrIPV4Addr(&address, any_addr);
+    if (pal_status == PAL_SUCCESS) {
+        pal_status = pal_setSockAddrPort(&address, _port);
+    }
+    if (pal_status == PAL_SUCCESS) {
+        pal_status = pal_setSocketOptions(_socket, PAL_SO_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    }
+    if (pal_status == PAL_SUCCESS) {
+        pal_status = pal_bind(_socket, &address, sizeof(address));
+    }
+    if (pal_status != PAL_SUCCESS) {
+        tr_error("Failed binding CoAP socket to port %u (0x%x)", (unsigned)_port, (unsigned)pal_status);
+        pal_close(&_socket);
+        return false;
+    }
+
+    // Platforms without link status events never return an interface
+    _link_tracked = (mcc_platform_interface_get() != NULL);
+    _link_down = false;
+    return true;
+}
+
+bool FtcdCommCoap::init(void)
+{
+    _coap = sn_coap_protocol_init(coap_malloc, coap_free, &FtcdCommCoap::_coap_tx, &FtcdCommCoap::_coap_rx);
+    if (_coap == NULL) {
+        tr_error("Failed initializing CoAP");
+        return false;
+    }
+
+    if ((sn_coap_protocol_set_block_size(_coap, SDA_COAP_BLOCK_SIZE) != 0) ||
+            (sn_coap_protocol_set_duplicate_buffer_size(_coap, SDA_COAP_DUPLICATE_COUNT) != 0)) {
+        tr_error("Failed configuring CoAP");
+        goto fail;
+    }
+
+    if (!_socket_open()) {
+        goto fail;
+    }
+
+#if SDA_COAP_LOSS_PERCENT > 0
+    if ((pal_osRandomBuffer((uint8_t *)&_loss_state, sizeof(_loss_state)) != PAL_SUCCESS) || (_loss_state == 0)) {
+        _loss_state = 1;
+    }
+    tr_warn("CoAP drops %u%% of the datagrams", (unsigned)SDA_COAP_LOSS_PERCENT);
+#endif
+#if SDA_COAP_DISCONNECT_EVERY > 0
+    tr_warn("CoAP disconnects every %u requests", (unsigned)SDA_COAP_DISCONNECT_EVERY);
+#endif
+
+    tr_info("SDA over CoAP on UDP port %u", (unsigned)_port);
+    return FtcdCommBase::init();
+
+fail:
+    sn_coap_protocol_destroy(_coap);
+    _coap = NULL;
+    return false;
+}
+
+bool FtcdCommCoap::reconnect(void)
+{
+    if (_coap == NULL) {
+        return false;
+    }
+
+    // Already gone after an injected disconnect
+    if (_socket != 0) {
+        pal_close(&_socket);
+    }
+    return _socket_open();
+}
+
+void FtcdCommCoap::finish(void)
+{
+    if (_coap != NULL) {
+        _response_flush();
+        if (_socket != 0) {
+            pal_close(&_socket);
+        }
+        sn_coap_protocol_destroy(_coap);
+        _coap = NULL;
+    }
+    FtcdCommBase::finish();
+}
+
+uint8_t FtcdCommCoap::_coap_tx(uint8_t *packet, uint16_t packet_size, sn_nsdl_addr_s *addr, void *param)
+{
+    FtcdCommCoap *comm = (FtcdCommCoap *)param;
+
+    // Follow-up blocks and cached responses sent from within sn-coap
+    if ((comm == NULL) || (addr == NULL)) {
+        return 0;
+    }
+    return comm->_datagram_send(packet, packet_size, addr) ? 1 : 0;
+}
+
+int8_t FtcdCommCoap::_coap_rx(sn_coap_hdr_s *message, sn_nsdl_addr_s *addr, void *param)
+{
+    (void)message;
+    (void)addr;
+    (void)param;
+
+    // Only called for transfers given up on, the host will retry
+    tr_debug("CoAP transfer expired");
+    return 0;
+}
+
+// xorshift32, cheap and good enough to pick datagrams to drop
+bool FtcdCommCoap::_lossy(void)
+{
+#if SDA_COAP_LOSS_PERCENT > 0
+    _loss_state ^= _loss_state << 13;
+    _loss_state ^= _loss_state >> 17;
+    _loss_state ^= _loss_state << 5;
+    return ((_loss_state % 100) < SDA_COAP_LOSS_PERCENT);
+#else
+    return false;
+#endif
+}
+
+bool FtcdCommCoap::_datagram_send(const uint8_t *packet, size_t packet_size, const sn_nsdl_addr_s *addr)
+{
+    palSocketAddress_t to;
+    size_t sent = 0;
+    palStatus_t pal_status;
+
+    if (_lossy()) {
+        tr_debug("CoAP TX dropped (%u bytes)", (unsigned)packet_size);
+        return true;
+    }
+
+    memset(&to, 0, sizeof(to));
+    if (addr->type == SN_NSDL_ADDRESS_TYPE_IPV6) {
+        pal_status = pal_setSockAddrIPV6Addr(&to, addr->addr_ptr);
+    } else {
+        pal_status = pal_setSockAddrIPV4Addr(&to, addr->addr_ptr);
+    }
+    if (pal_status == PAL_SUCCESS) {
+        pal_status = pal_setSockAddrPort(&to, addr->port);
+    }
+    if (pal_status == PAL_SUCCESS) {
+        pal_status = pal_sendTo(_socket, packet, packet_size, &to, sizeof(to), &sent);
+    }
+
+    if ((pal_status != PAL_SUCCESS) || (sent != packet_size)) {
+        tr_error("Failed sending CoAP datagram (0x%x)", (unsigned)pal_status);
+        return false;
+    }
+    return true;
+}
+
+void FtcdCommCoap::_request_release(sn_coap_hdr_s *request)
+{
+    // A reassembled payload belongs to the block-wise store until removed
+    if ((request->coap_status == COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED) && (request->payload_ptr != NULL)) {
+        sn_coap_protocol_block_remove(_coap, &_peer, request->payload_len, request->payload_ptr);
+    }
+    request->payload_ptr = NULL;
+    sn_coap_parser_release_allocated_coap_msg_mem(_coap, request);
+}
+
+bool FtcdCommCoap::_response_send(sn_coap_hdr_s *request, sn_coap_msg_code_e code, const uint8_t *payload, size_t payload_size)
+{
+    sn_coap_hdr_s *response;
+    int16_t packet_size;
+
+    response = sn_coap_build_response(_coap, request, code);
+    if (response == NULL) {
+        tr_error("Failed building CoAP response");
+        return false;
+    }
+
+    // Larger payloads get a Block2 option, sn-coap stores the rest for the host to fetch
+    response->payload_ptr = (uint8_t *)payload;
+    response->payload_len = (uint16_t)payload_size;
+
+    if (sn_coap_builder_calc_needed_packet_data_size_2(response, SDA_COAP_BLOCK_SIZE) > sizeof(_datagram)) {
+        packet_size = -1;
+    } else {
+        packet_size = sn_coap_protocol_build(_coap, &_peer, _datagram, response, this);
+    }
+
+    response->payload_ptr = NULL;
+    sn_coap_parser_release_allocated_coap_msg_mem(_coap, response);
+
+    if (packet_size < 0) {
+        tr_error("Failed encoding CoAP response (%d)", (int)packet_size);
+        return false;
+    }
+    return _datagram_send(_datagram, (size_t)packet_size, &_peer);
+}
+
+void FtcdCommCoap::_response_flush(void)
+{
+    if (_request == NULL) {
+        return;
+    }
+
+    _response_send(_request, COAP_MSG_CODE_RESPONSE_CHANGED, _tx, _tx_size);
+    _request_release(_request);
+    _request = NULL;
+    _tx_size = 0;
+}
+
+// Waits for the next complete SDA request, "false" when a datagram or timeout yields none
+bool FtcdCommCoap::_request_receive(void)
+{
+    palSocketAddress_t from;
+    palSocketLength_t from_size = sizeof(from);
+    size_t datagram_size = 0;
+    sn_coap_hdr_s *request;
+    palStatus_t pal_status;
+
+    memset(&from, 0, sizeof(from));
+    pal_status = pal_receiveFrom(_socket, _datagram, sizeof(_datagram), &from, &from_size, &datagram_size);
+    sn_coap_protocol_exec(_coap, coap_time());
+    if (pal_status != PAL_SUCCESS) {
+        // A receive timeout only means the host is quiet
+        if (pal_status != PAL_ERR_SOCKET_WOULD_BLOCK) {
+            tr_error("Failed receiving CoAP datagram (0x%x)", (unsigned)pal_status);
+            _link_down = true;
+        } else if (_link_tracked && (mcc_platform_interface_get() == NULL)) {
+            // The network status events have taken the interface down
+            _link_down = true;
+        }
+        return false;
+    }
+
+    if (_lossy()) {
+        tr_debug("CoAP RX dropped (%u bytes)", (unsigned)datagram_size);
+        return false;
+    }
+
+    if (from.addressType == PAL_AF_INET6) {
+        _peer.type = SN_NSDL_ADDRESS_TYPE_IPV6;
+        _peer.addr_len = PAL_IPV6_ADDRESS_SIZE;
+        pal_status = pal_getSockAddrIPV6Addr(&from, _peer_addr);
+    } else {
+        _peer.type = SN_NSDL_ADDRESS_TYPE_IPV4;
+        _peer.addr_len = PAL_IPV4_ADDRESS_SIZE;
+        pal_status = pal_getSockAddrIPV4Addr(&from, _peer_addr);
+    }
+    if ((pal_status != PAL_SUCCESS) || (pal_getSockAddrPort(&from, &_peer.port) != PAL_SUCCESS)) {
+        return false;
+    }
+
+    request = sn_coap_protocol_parse(_coap, &_peer, (uint16_t)datagram_size, _datagram, this);
+    if (request == NULL) {
+        tr_debug("Malformed CoAP datagram (%u bytes)", (unsigned)datagram_size);
+        return false;
+    }
+
+    // Intermediate blocks, Block2 requests and duplicates are answered by sn-coap
+    if (((request->coap_status != COAP_STATUS_OK) && (request->coap_status != COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED)) ||
+            (request->msg_type == COAP_MSG_TYPE_ACKNOWLEDGEMENT) || (request->msg_type == COAP_MSG_TYPE_RESET)) {
+        _request_release(request);
+        return false;
+    }
+
+    if ((request->uri_path_ptr == NULL) || (request->uri_path_len != strlen(SDA_COAP_URI_PATH)) ||
+            (memcmp(request->uri_path_ptr, SDA_COAP_URI_PATH, request->uri_path_len) != 0)) {
+        _response_send(request, COAP_MSG_CODE_RESPONSE_NOT_FOUND, NULL, 0);
+        _request_release(request);
+        return false;
+    }
+
+    if (request->msg_code != COAP_MSG_CODE_REQUEST_POST) {
+        _response_send(request, COAP_MSG_CODE_RESPONSE_METHOD_NOT_ALLOWED, NULL, 0);
+        _request_release(request);
+        return false;
+    }
+
+    if (request->payload_len > sizeof(_rx)) {
+        tr_error("SDA request over CoAP too large (%u bytes)", (unsigned)request->payload_len);
+        _response_send(request, COAP_MSG_CODE_RESPONSE_REQUEST_ENTITY_TOO_LARGE, NULL, 0);
+        _request_release(request);
+        return false;
+    }
+
+    memcpy(_rx, request->payload_ptr, request->payload_len);
+    _rx_size = request->payload_len;
+    _rx_offset = 0;
+
+    // Kept until the response frame is complete
+    if (request->coap_status == COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVED) {
+        sn_coap_protocol_block_remove(_coap, &_peer, request->payload_len, request->payload_ptr);
+    }
+    request->payload_ptr = NULL;
+    _request = request;
+    return true;
+}
+
+bool FtcdCommCoap::_read(uint8_t *data, size_t data_size)
+{
+    if ((data == NULL) || (data_size > _rx_size - _rx_offset)) {
+        return false;
+    }
+
+    memcpy(data, &_rx[_rx_offset], data_size);
+    _rx_offset += data_size;
+    return true;
+}
+
+// Drops the socket as a lost link would, before every SDA_COAP_DISCONNECT_EVERY requests
+bool FtcdCommCoap::_disconnect_injected(void)
+{
+#if SDA_COAP_DISCONNECT_EVERY > 0
+    if (_disconnect_countdown == 0) {
+        _disconnect_countdown = SDA_COAP_DISCONNECT_EVERY;
+        tr_warn("CoAP disconnect injected");
+        pal_close(&_socket);
+        _link_down = true;
+        return true;
+    }
+#endif
+    return false;
+}
+
+ftcd_comm_status_e FtcdCommCoap::is_token_detected(void)
+{
+    // The previous response is complete by now
+    _response_flush();
+
+    if (_link_down || _disconnect_injected()) {
+        return FTCD_COMM_NETWORK_CONNECTION_ERROR;
+    }
+
+    while (true) {
+        while (!_request_receive()) {
+            if (_link_down) {
+                return FTCD_COMM_NETWORK_CONNECTION_ERROR;
+            }
+        }
+
+        if ((_rx_size >= sizeof(_header_token)) && (memcmp(_rx, _header_token, sizeof(_header_token)) == 0)) {
+            _rx_offset = sizeof(_header_token);
+#if SDA_COAP_DISCONNECT_EVERY > 0
+            _disconnect_countdown--;
+#endif
+            return FTCD_COMM_STATUS_SUCCESS;
+        }
+
+        // Not an SDA frame, refuse it and keep listening
+        tr_warn("CoAP request without SDA header token");
+        _response_send(_request, COAP_MSG_CODE_RESPONSE_BAD_REQUEST, NULL, 0);
+        _request_release(_request);
+        _request = NULL;
+    }
+}
+
+uint32_t FtcdCommCoap::read_message_size(void)
+{
+    uint8_t size_bytes[sizeof(uint32_t)];
+
+    if (!_read(size_bytes, sizeof(size_bytes))) {
+        return 0;
+    }
+
+    if (_network_endianness == FTCD_COMM_NET_ENDIANNESS_LITTLE) {
+        return ((uint32_t)size_bytes[3] << 24) | ((uint32_t)size_bytes[2] << 16) | ((uint32_t)size_bytes[1] << 8) | size_bytes[0];
+    }
+    return ((uint32_t)size_bytes[0] << 24) | ((uint32_t)size_bytes[1] << 16) | ((uint32_t)size_bytes[2] << 8) | size_bytes[3];
+}
+
+bool FtcdCommCoap::read_message(uint8_t *message_out, size_t message_size)
+{
+    return _read(message_out, message_size);
+}
+
+bool FtcdCommCoap::read_message_signature(uint8_t *sig, size_t sig_size)
+{
+    return _read(sig, sig_size);
+}
+
+bool FtcdCommCoap::send(const uint8_t *data, uint32_t data_size)
+{
+    if (data == NULL) {
+        return false;
+    }
+
+    // Collected into one CoAP response, see _response_flush()
+    if (data_size > sizeof(_tx) - _tx_size) {
+        tr_error("SDA response over CoAP too large (%u bytes)", (unsigned)(_tx_size + data_size));
+        return false;
+    }
+
+    memcpy(&_tx[_tx_size], data, data_size);
+    _tx_size += data_size;
+    return true;
+}
+
+#endif // MBED_CONF_APP_SDA_COAP == 1
@@ -0,0 +1,189 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_COMM_COAP_H__
+#define __SDA_COMM_COAP_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "ftcd_comm_base.h"
+#include "pal.h"
+#include "mbed-coap/sn_coap_header.h"
+#include "mbed-coap/sn_coap_protocol.h"
+
+/**
+* SDA transport over CoAP/UDP.
+*
+* The host POSTs the same frame the serial transport carries to SDA_COAP_URI_PATH,
+*
+*   FTCD header token | message size (4) | message | signature
+*
+* and gets the response frame back as the payload of the piggybacked 2.04 response.
+* Frames larger than SDA_COAP_BLOCK_SIZE travel block-wise, Block1 for the request
+* and Block2 for the response, reassembly and the follow-up blocks are left to
+* sn-coap. A retransmitted request is answered from the sn-coap duplicate cache.
+*
+* The response is sent right before waiting for the next request, the whole frame
+* has to be known to build the first block. The host should therefore allow for the
+* longest demo operation in its ACK timeout or rely on retransmission.
+*
+* The sockets are PAL sockets, so the transport itself is not tied to Mbed OS, but only
+* the Mbed OS helper creates it: this tree has no Linux target and no loopback test.
+* SDA_COAP_LOSS_PERCENT drops that share of the datagrams in both directions to
+* exercise the recovery paths on a board.
+*
+* A socket error or the network interface going down ends wait_for_message() with
+* FTCD_COMM_NETWORK_CONNECTION_ERROR. reconnect() opens a new socket once the network
+* is back and keeps the sn-coap state, so a response lost with the link is answered
+* from the duplicate cache when the host retransmits its request.
+* SDA_COAP_DISCONNECT_EVERY injects such a drop after every that many requests.
+*/
+
+/** UDP port the device listens on */
+#ifndef SDA_COAP_PORT
+#ifdef MBED_CONF_APP_SDA_COAP_PORT
+#define SDA_COAP_PORT MBED_CONF_APP_SDA_COAP_PORT
+#else
+#define SDA_COAP_PORT 5683
+#endif
+#endif
+
+#define SDA_COAP_URI_PATH           "sda"
+
+/** Block size of both directions */
+#ifndef SDA_COAP_BLOCK_SIZE
+#define SDA_COAP_BLOCK_SIZE SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+#endif
+
+/** Largest request or response frame */
+#ifndef SDA_COAP_MAX_MESSAGE_SIZE
+#ifdef MBED_CONF_APP_SDA_COAP_MAX_MESSAGE
+#define SDA_COAP_MAX_MESSAGE_SIZE MBED_CONF_APP_SDA_COAP_MAX_MESSAGE
+#else
+#define SDA_COAP_MAX_MESSAGE_SIZE 2048
+#endif
+#endif
+
+/** Share of datagrams dropped on purpose, 0 in production */
+#ifndef SDA_COAP_LOSS_PERCENT
+#ifdef MBED_CONF_APP_SDA_COAP_LOSS_PERCENT
+#define SDA_COAP_LOSS_PERCENT MBED_CONF_APP_SDA_COAP_LOSS_PERCENT
+#else
+#define SDA_COAP_LOSS_PERCENT 0
+#endif
+#endif
+
+/** Requests between injected disconnects, 0 in production */
+#ifndef SDA_COAP_DISCONNECT_EVERY
+#ifdef MBED_CONF_APP_SDA_COAP_DISCONNECT_EVERY
+#define SDA_COAP_DISCONNECT_EVERY MBED_CONF_APP_SDA_COAP_DISCONNECT_EVERY
+#else
+#define SDA_COAP_DISCONNECT_EVERY 0
+#endif
+#endif
+
+#define SDA_COAP_HEADER_ROOM        64      // CoAP header, token and options around one block
+#define SDA_COAP_DATAGRAM_SIZE      (SDA_COAP_BLOCK_SIZE + SDA_COAP_HEADER_ROOM)
+#define SDA_COAP_DUPLICATE_COUNT    4       // recent responses kept for retransmitted requests
+#define SDA_COAP_RX_TIMEOUT_MS      1000    // lets sn-coap expire stale transfers while idle
+
+class FtcdCommCoap : public FtcdCommBase {
+
+public:
+    /**
+    * @param network_endianness[in] - Endianness of the message size field
+    * @param header_token[in] - FTCD_MSG_HEADER_TOKEN_SIZE bytes opening every frame
+    * @param use_signature[in] - Whether frames end with a signature
+    * @param interface_index[in] - PAL network interface to bind to
+    * @param port[in] - UDP port to listen on
+    */
+    FtcdCommCoap(ftcd_comm_network_endianness_e network_endianness, const uint8_t *header_token, bool use_signature,
+                 uint32_t interface_index, uint16_t port);
+
+    virtual ~FtcdCommCoap();
+
+    virtual bool init(void);
+
+    virtual void finish(void);
+
+    virtual ftcd_comm_status_e is_token_detected(void);
+
+    virtual uint32_t read_message_size(void);
+
+    virtual bool read_message(uint8_t *message_out, size_t message_size);
+
+    virtual bool read_message_signature(uint8_t *sig, size_t sig_size);
+
+    virtual bool send(const uint8_t *data, uint32_t data_size);
+
+    /**
+    * Replaces the socket after a connection error, the network has to be up again.
+    * The CoAP state, including the duplicate cache, is kept.
+    */
+    bool reconnect(void);
+
+private:
+    static uint8_t _coap_tx(uint8_t *packet, uint16_t packet_size, sn_nsdl_addr_s *addr, void *param);
+
+    static int8_t _coap_rx(sn_coap_hdr_s *message, sn_nsdl_addr_s *addr, void *param);
+
+    bool _datagram_send(const uint8_t *packet, size_t packet_size, const sn_nsdl_addr_s *addr);
+
+    bool _lossy(void);
+
+    bool _socket_open(void);
+
+    bool _disconnect_injected(void);
+
+    bool _request_receive(void);
+
+    void _request_release(sn_coap_hdr_s *request);
+
+    bool _response_send(sn_coap_hdr_s *request, sn_coap_msg_code_e code, const uint8_t *payload, size_t payload_size);
+
+    void _response_flush(void);
+
+    bool _read(uint8_t *data, size_t data_size);
+
+    ftcd_comm_network_endianness_e _network_endianness;
+    uint32_t _interface_index;
+    uint16_t _port;
+    palSocket_t _socket;
+    struct coap_s *_coap;
+    uint32_t _loss_state;
+    uint32_t _disconnect_countdown;                 // requests left before an injected disconnect
+    bool _link_down;                                // set on socket errors and interface down events
+    bool _link_tracked;                             // mcc_platform_interface_get() reflects the link state
+    uint8_t _header_token[FTCD_MSG_HEADER_TOKEN_SIZE];
+
+    // Peer of the request being served
+    sn_nsdl_addr_s _peer;
+    uint8_t _peer_addr[PAL_IPV6_ADDRESS_SIZE];
+
+    sn_coap_hdr_s *_request;                        // answered with the frame sent meanwhile
+    uint8_t _datagram[SDA_COAP_DATAGRAM_SIZE];
+    uint8_t _rx[SDA_COAP_MAX_MESSAGE_SIZE];
+    size_t _rx_size;
+    size_t _rx_offset;
+    uint8_t _tx[SDA_COAP_MAX_MESSAGE_SIZE];
+    size_t _tx_size;
+};
+
+#endif //__SDA_COMM_COAP_H__
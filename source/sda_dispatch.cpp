@@ -0,0 +1,68 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include <string.h>
+
+#include "sda_dispatch.h"
+#include "sda_session.h"
+#include "sda_revocation.h"
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct sda_demo_operation_entry_ {
+    const char *name;
+    size_t name_size;
+    sda_demo_operation_e operation;
+} sda_demo_operation_entry_s;
+
+#define SDA_DEMO_OPERATION_ENTRY(name, operation) { name, sizeof(name) - 1, operation }
+
+///////////////////////// GLOBALS /////////////////////////
+
+static const sda_demo_operation_entry_s g_demo_operations[] = {
+    SDA_DEMO_OPERATION_ENTRY("configure", SDA_DEMO_OPERATION_CONFIGURE),
+    SDA_DEMO_OPERATION_ENTRY("read-data", SDA_DEMO_OPERATION_READ_DATA),
+    SDA_DEMO_OPERATION_ENTRY("update", SDA_DEMO_OPERATION_UPDATE),
+    SDA_DEMO_OPERATION_ENTRY("diagnostics", SDA_DEMO_OPERATION_DIAGNOSTICS),
+    SDA_DEMO_OPERATION_ENTRY("restart", SDA_DEMO_OPERATION_RESTART),
+    SDA_DEMO_OPERATION_ENTRY(SDA_SESSION_OPEN_FUNC_NAME, SDA_DEMO_OPERATION_OPEN_SESSION),
+    SDA_DEMO_OPERATION_ENTRY(SDA_REVOCATION_UPDATE_FUNC_NAME, SDA_DEMO_OPERATION_UPDATE_REVOCATION)
+};
+
+//////////////////////////////////////////////////////////
+
+sda_demo_operation_e sda_demo_operation_lookup(const uint8_t *func_name, size_t func_name_size)
+{
+    if (func_name == NULL) {
+        return SDA_DEMO_OPERATION_UNKNOWN;
+    }
+
+    for (size_t i = 0; i < sizeof(g_demo_operations) / sizeof(g_demo_operations[0]); i++) {
+
+        // Compare sizes first, most names are rejected without touching the bytes
+        if (g_demo_operations[i].name_size != func_name_size) {
+            continue;
+        }
+
+        if (memcmp(g_demo_operations[i].name, func_name, func_name_size) == 0) {
+            return g_demo_operations[i].operation;
+        }
+    }
+
+    return SDA_DEMO_OPERATION_UNKNOWN;
+}
@@ -0,0 +1,57 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_DISPATCH_H__
+#define __SDA_DISPATCH_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Demo operations that can be requested through SDA */
+typedef enum {
+    SDA_DEMO_OPERATION_UNKNOWN = 0,
+    SDA_DEMO_OPERATION_CONFIGURE,
+    SDA_DEMO_OPERATION_READ_DATA,
+    SDA_DEMO_OPERATION_UPDATE,
+    SDA_DEMO_OPERATION_DIAGNOSTICS,
+    SDA_DEMO_OPERATION_RESTART,
+    SDA_DEMO_OPERATION_OPEN_SESSION,
+    SDA_DEMO_OPERATION_UPDATE_REVOCATION,
+    SDA_DEMO_OPERATION_COUNT        // number of operations, SDA_DEMO_OPERATION_UNKNOWN included
+} sda_demo_operation_e;
+
+/** Maps a function callback name to a demo operation.
+*
+* The name must match exactly, a prefix of an operation name is not a match.
+*
+* @param func_name[in] - Function name in its string representation
+* @param func_name_size[in] - Function name length
+*
+* @return The operation or SDA_DEMO_OPERATION_UNKNOWN.
+*/
+sda_demo_operation_e sda_demo_operation_lookup(const uint8_t *func_name, size_t func_name_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_DISPATCH_H__
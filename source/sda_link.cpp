@@ -0,0 +1,82 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include <string.h>
+
+#include "sda_link.h"
+
+///////////////////////// GLOBALS /////////////////////////
+
+// Rates every UART this example runs on derives closely enough from its clock
+static const uint32_t g_link_bauds[] = { 230400, 460800, 921600, 1000000, 2000000 };
+
+//////////////////////////////////////////////////////////
+
+static uint8_t link_check(const uint8_t *body)
+{
+    uint8_t sum = 0;
+
+    for (size_t i = 0; i < SDA_LINK_BODY_SIZE - 1; i++) {
+        sum += body[i];
+    }
+    return (uint8_t)~sum;
+}
+
+bool sda_link_body_parse(const uint8_t *body, sda_link_type_e *type, uint32_t *baud)
+{
+    if (link_check(body) != body[SDA_LINK_BODY_SIZE - 1]) {
+        return false;
+    }
+
+    if ((body[0] < SDA_LINK_TYPE_PROPOSE) || (body[0] > SDA_LINK_TYPE_CONFIRMED)) {
+        return false;
+    }
+
+    *type = (sda_link_type_e)body[0];
+    *baud = ((uint32_t)body[1] << 24) | ((uint32_t)body[2] << 16) | ((uint32_t)body[3] << 8) | body[4];
+    return true;
+}
+
+void sda_link_frame_write(sda_link_type_e type, uint32_t baud, uint8_t *frame)
+{
+    const uint8_t token[] = SDA_LINK_TOKEN;
+    uint8_t *body = &frame[SDA_LINK_TOKEN_SIZE];
+
+    memcpy(frame, token, SDA_LINK_TOKEN_SIZE);
+    body[0] = (uint8_t)type;
+    body[1] = (uint8_t)(baud >> 24);
+    body[2] = (uint8_t)(baud >> 16);
+    body[3] = (uint8_t)(baud >> 8);
+    body[4] = (uint8_t)baud;
+    body[5] = link_check(body);
+}
+
+uint32_t sda_link_baud_select(uint32_t proposed_baud, uint32_t base_baud, uint32_t max_baud)
+{
+    if ((proposed_baud <= base_baud) || (proposed_baud > max_baud)) {
+        return base_baud;
+    }
+
+    for (size_t i = 0; i < sizeof(g_link_bauds) / sizeof(g_link_bauds[0]); i++) {
+        if (g_link_bauds[i] == proposed_baud) {
+            return proposed_baud;
+        }
+    }
+
+    return base_baud;
+}
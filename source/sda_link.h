@@ -0,0 +1,125 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_LINK_H__
+#define __SDA_LINK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+* Serial link rate negotiation.
+*
+* Link frames travel on the SDA serial channel between SDA messages, all integers
+* big endian:
+*
+*   SDA_LINK_TOKEN | type (1) | baud (4) | check (1)
+*
+* where check is the complement of the byte sum of type and baud.
+*
+*   1. The host sends PROPOSE with the rate it wants, at the current rate.
+*   2. The device answers ACCEPT with the rate it picked, the current one if it
+*      refuses, then both sides switch.
+*   3. The host sends CONFIRM at the new rate within SDA_LINK_CONFIRM_TIMEOUT_MS, the
+*      device answers CONFIRMED. A valid SDA message confirms the rate as well.
+*
+* The device falls back to SDA_LINK_BASE_BAUD when no confirmation arrives in time,
+* or when more than SDA_LINK_GARBAGE_LIMIT bytes in a row are not part of a frame,
+* the way framing errors show once the bytes reach the ring. The host falls back
+* when its own request times out.
+*/
+
+#define SDA_LINK_TOKEN          { 'm', 'b', 'e', 'd', 'l', 'i', 'n', 'k' }
+#define SDA_LINK_TOKEN_SIZE     8
+#define SDA_LINK_BODY_SIZE      6
+#define SDA_LINK_FRAME_SIZE     (SDA_LINK_TOKEN_SIZE + SDA_LINK_BODY_SIZE)
+
+/** Rate the link starts at and falls back to */
+#ifndef SDA_LINK_BASE_BAUD
+#ifdef MBED_CONF_APP_SDA_SERIAL_BAUD
+#define SDA_LINK_BASE_BAUD MBED_CONF_APP_SDA_SERIAL_BAUD
+#else
+#define SDA_LINK_BASE_BAUD 115200
+#endif
+#endif
+
+/** Highest rate the device accepts, SDA_LINK_BASE_BAUD disables negotiation */
+#ifndef SDA_LINK_MAX_BAUD
+#ifdef MBED_CONF_APP_SDA_SERIAL_MAX_BAUD
+#define SDA_LINK_MAX_BAUD MBED_CONF_APP_SDA_SERIAL_MAX_BAUD
+#else
+#define SDA_LINK_MAX_BAUD 921600
+#endif
+#endif
+
+#ifndef SDA_LINK_CONFIRM_TIMEOUT_MS
+#define SDA_LINK_CONFIRM_TIMEOUT_MS 500
+#endif
+
+#ifndef SDA_LINK_GARBAGE_LIMIT
+#define SDA_LINK_GARBAGE_LIMIT 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SDA_LINK_TYPE_PROPOSE = 1,
+    SDA_LINK_TYPE_ACCEPT,
+    SDA_LINK_TYPE_CONFIRM,
+    SDA_LINK_TYPE_CONFIRMED
+} sda_link_type_e;
+
+/**
+* Decodes the body following SDA_LINK_TOKEN.
+*
+* @param body[in] - SDA_LINK_BODY_SIZE bytes
+* @param type[out] - Frame type
+* @param baud[out] - Rate
+*
+* @return "true" if the body is well formed "false" otherwise.
+*/
+bool sda_link_body_parse(const uint8_t *body, sda_link_type_e *type, uint32_t *baud);
+
+/**
+* Writes a complete link frame.
+*
+* @param type[in] - Frame type
+* @param baud[in] - Rate
+* @param frame[out] - SDA_LINK_FRAME_SIZE bytes
+*/
+void sda_link_frame_write(sda_link_type_e type, uint32_t baud, uint8_t *frame);
+
+/**
+* Picks the rate to answer a proposal with.
+*
+* @param proposed_baud[in] - Rate proposed by the host
+* @param base_baud[in] - Rate the channel falls back to
+* @param max_baud[in] - Highest rate the channel supports
+*
+* @return The proposed rate if the device supports it, base_baud otherwise.
+*/
+uint32_t sda_link_baud_select(uint32_t proposed_baud, uint32_t base_baud, uint32_t max_baud);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_LINK_H__
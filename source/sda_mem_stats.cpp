@@ -0,0 +1,180 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "sda_mem_stats.h"
+
+#if SDA_MEM_STATS_ENABLED
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mbed.h"
+#include "mbed_stats.h"
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct sda_mem_stats_entry_ {
+    char name[SDA_MEM_STATS_MAX_NAME_SIZE + 1];
+    uint32_t calls;
+    size_t heap_peak;         // largest heap growth over the entry level seen during the operation
+    size_t heap_high_water;   // heap high-water mark set by this operation, 0 if it never raised it
+    size_t stack_high_water;  // thread stack high-water mark set by this operation, 0 if it never raised it
+    size_t stack_size;        // stack size of the thread the operation ran on
+} sda_mem_stats_entry_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static sda_mem_stats_entry_s g_mem_stats[SDA_MEM_STATS_MAX_OPERATIONS];
+
+#if defined(MBED_STACK_STATS_ENABLED)
+static mbed_stats_stack_t g_thread_stack_stats[SDA_MEM_STATS_MAX_THREADS];
+#endif
+
+//////////////////////////////////////////////////////////
+
+static size_t mem_stats_stack_used(size_t *stack_size_out)
+{
+#if defined(MBED_STACK_STATS_ENABLED)
+    osThreadId_t thread_id = osThreadGetId();
+    size_t stack_size = osThreadGetStackSize(thread_id);
+    size_t stack_space = osThreadGetStackSpace(thread_id);
+
+    if (stack_size_out) {
+        *stack_size_out = stack_size;
+    }
+    return stack_size - stack_space;
+#else
+    if (stack_size_out) {
+        *stack_size_out = 0;
+    }
+    return 0;
+#endif
+}
+
+static sda_mem_stats_entry_s *mem_stats_entry_get(const uint8_t *op_name, size_t op_name_size)
+{
+    if (op_name_size > SDA_MEM_STATS_MAX_NAME_SIZE) {
+        op_name_size = SDA_MEM_STATS_MAX_NAME_SIZE;
+    }
+
+    for (size_t i = 0; i < SDA_MEM_STATS_MAX_OPERATIONS; i++) {
+        sda_mem_stats_entry_s *entry = &g_mem_stats[i];
+
+        if (entry->name[0] == '\0') {
+            // First free slot, the operation was not seen before
+            memcpy(entry->name, op_name, op_name_size);
+            entry->name[op_name_size] = '\0';
+            return entry;
+        }
+
+        if ((strlen(entry->name) == op_name_size) && (memcmp(entry->name, op_name, op_name_size) == 0)) {
+            return entry;
+        }
+    }
+
+    // Table full
+    return NULL;
+}
+
+void sda_mem_stats_snapshot(sda_mem_snapshot_s *snapshot)
+{
+    memset(snapshot, 0, sizeof(*snapshot));
+
+#if defined(MBED_HEAP_STATS_ENABLED)
+    mbed_stats_heap_t heap_stats;
+    mbed_stats_heap_get(&heap_stats);
+    snapshot->heap_current = heap_stats.current_size;
+    snapshot->heap_max = heap_stats.max_size;
+#endif
+
+    snapshot->stack_max = mem_stats_stack_used(NULL);
+}
+
+void sda_mem_stats_record(const uint8_t *op_name, size_t op_name_size, const sda_mem_snapshot_s *before)
+{
+    sda_mem_snapshot_s after;
+    size_t stack_size;
+    size_t heap_peak;
+
+    if ((op_name == NULL) || (op_name_size == 0)) {
+        op_name = (const uint8_t *)"unknown";
+        op_name_size = strlen("unknown");
+    }
+
+    sda_mem_stats_snapshot(&after);
+    (void)mem_stats_stack_used(&stack_size);
+
+    sda_mem_stats_entry_s *entry = mem_stats_entry_get(op_name, op_name_size);
+    if (entry == NULL) {
+        return;
+    }
+
+    entry->calls++;
+    entry->stack_size = stack_size;
+
+    if (after.heap_max > before->heap_max) {
+        // The operation raised the heap high-water mark, its peak is known exactly
+        heap_peak = after.heap_max - before->heap_current;
+        entry->heap_high_water = after.heap_max;
+    } else {
+        // Peak stayed under the previous mark, only the retained growth is known
+        heap_peak = (after.heap_current > before->heap_current) ? (after.heap_current - before->heap_current) : 0;
+    }
+    if (heap_peak > entry->heap_peak) {
+        entry->heap_peak = heap_peak;
+    }
+
+    if (after.stack_max > before->stack_max) {
+        entry->stack_high_water = after.stack_max;
+    }
+}
+
+void sda_mem_stats_print(void)
+{
+    printf("Per operation memory high-water marks (bytes):\n");
+    printf("%-*s %8s %10s %12s %12s %12s\n", SDA_MEM_STATS_MAX_NAME_SIZE, "operation", "calls", "heap-peak", "heap-hwm", "stack-hwm", "stack-size");
+
+    for (size_t i = 0; i < SDA_MEM_STATS_MAX_OPERATIONS; i++) {
+        const sda_mem_stats_entry_s *entry = &g_mem_stats[i];
+
+        if (entry->name[0] == '\0') {
+            break;
+        }
+
+        printf("%-*s %8lu %10lu %12lu %12lu %12lu\n", SDA_MEM_STATS_MAX_NAME_SIZE, entry->name,
+               (unsigned long)entry->calls, (unsigned long)entry->heap_peak, (unsigned long)entry->heap_high_water,
+               (unsigned long)entry->stack_high_water, (unsigned long)entry->stack_size);
+    }
+
+#if defined(MBED_STACK_STATS_ENABLED)
+    // The network stack runs requests partly on its own threads (lwIP tcpip, EMAC RX)
+    size_t thread_count = mbed_stats_stack_get_each(g_thread_stack_stats, SDA_MEM_STATS_MAX_THREADS);
+    const char *thread_name;
+
+    printf("Per thread stack high-water marks (bytes):\n");
+    printf("%-*s %12s %12s\n", SDA_MEM_STATS_MAX_NAME_SIZE, "thread", "stack-hwm", "stack-size");
+    for (size_t i = 0; i < thread_count; i++) {
+        thread_name = osThreadGetName((osThreadId_t)g_thread_stack_stats[i].thread_id);
+        printf("%-*.*s %12lu %12lu\n", SDA_MEM_STATS_MAX_NAME_SIZE, SDA_MEM_STATS_MAX_NAME_SIZE,
+               (thread_name != NULL) ? thread_name : "unnamed",
+               (unsigned long)g_thread_stack_stats[i].max_size, (unsigned long)g_thread_stack_stats[i].reserved_size);
+    }
+#endif
+}
+
+#endif // SDA_MEM_STATS_ENABLED
@@ -0,0 +1,100 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_MEM_STATS_H__
+#define __SDA_MEM_STATS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sda_dispatch.h"
+
+/**
+* Per operation heap and stack high-water accounting.
+*
+* Mbed OS only keeps global high-water marks (the heap peak and the per thread
+* stack watermark), they cannot be reset. An operation is therefore charged with
+* a peak whenever it raises one of these marks, which is exactly the information
+* needed to tell which operation sizes the heap and the stacks.
+*
+* Active when Mbed OS heap or stack statistics are enabled
+* (MBED_HEAP_STATS_ENABLED / MBED_STACK_STATS_ENABLED).
+*/
+#if defined(MBED_HEAP_STATS_ENABLED) || defined(MBED_STACK_STATS_ENABLED)
+#define SDA_MEM_STATS_ENABLED 1
+#else
+#define SDA_MEM_STATS_ENABLED 0
+#endif
+
+/** Entries recorded outside the dispatch: "sda_operation_process" and the two ATCA CN reads */
+#define SDA_MEM_STATS_FIXED_OPERATIONS 3
+
+/** Number of distinct operation names tracked, every demo operation and "unknown" get an entry */
+#ifndef SDA_MEM_STATS_MAX_OPERATIONS
+#define SDA_MEM_STATS_MAX_OPERATIONS (SDA_DEMO_OPERATION_COUNT + SDA_MEM_STATS_FIXED_OPERATIONS)
+#endif
+
+/** Number of threads whose stack watermark is printed, the lwIP threads included */
+#ifndef SDA_MEM_STATS_MAX_THREADS
+#define SDA_MEM_STATS_MAX_THREADS 16
+#endif
+
+/** Operation names longer than this are truncated */
+#ifndef SDA_MEM_STATS_MAX_NAME_SIZE
+#define SDA_MEM_STATS_MAX_NAME_SIZE 24
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Memory usage taken before an operation runs */
+typedef struct sda_mem_snapshot_ {
+    size_t heap_current;  // heap bytes in use
+    size_t heap_max;      // heap high-water mark
+    size_t stack_max;     // calling thread stack high-water mark
+} sda_mem_snapshot_s;
+
+/**
+* Takes a memory usage snapshot.
+*
+* @param snapshot[out] - The snapshot
+*/
+void sda_mem_stats_snapshot(sda_mem_snapshot_s *snapshot);
+
+/**
+* Charges the memory used since a snapshot to an operation.
+*
+* A NULL or empty name is charged to the "unknown" entry.
+*
+* @param op_name[in] - Operation name (does not need to be NUL terminated)
+* @param op_name_size[in] - Operation name length
+* @param before[in] - The snapshot taken before the operation ran
+*/
+void sda_mem_stats_record(const uint8_t *op_name, size_t op_name_size, const sda_mem_snapshot_s *before);
+
+/**
+* Prints the per operation table and the stack watermark of every thread.
+*/
+void sda_mem_stats_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_MEM_STATS_H__
@@ -0,0 +1,203 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include <string.h>
+
+#include "sda_replay.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define REPLAY_WINDOW_WORDS         (SDA_REPLAY_WINDOW_SIZE / 32)
+#define REPLAY_FILTER_BUCKET_MASK   (SDA_REPLAY_FILTER_BUCKETS - 1)
+#define REPLAY_FILTER_CAPACITY      (SDA_REPLAY_FILTER_BUCKETS * SDA_REPLAY_FILTER_SLOTS)
+#define REPLAY_FILTER_MAX_KICKS     16
+
+#define REPLAY_FNV_OFFSET           0xcbf29ce484222325ULL
+#define REPLAY_FNV_PRIME            0x00000100000001b3ULL
+
+//////////////////////////////////////////////////////////
+
+void sda_replay_window_init(sda_replay_window_s *window)
+{
+    memset(window, 0, sizeof(*window));
+}
+
+// Moves every recorded counter shift positions further from the top
+static void replay_window_shift(sda_replay_window_s *window, uint32_t shift)
+{
+    uint32_t word_shift = shift / 32;
+    uint32_t bit_shift = shift % 32;
+
+    if (shift >= SDA_REPLAY_WINDOW_SIZE) {
+        memset(window->bitmap, 0, sizeof(window->bitmap));
+        return;
+    }
+
+    for (int i = REPLAY_WINDOW_WORDS - 1; i >= 0; i--) {
+        uint32_t value = 0;
+
+        if ((uint32_t)i >= word_shift) {
+            value = window->bitmap[i - word_shift] << bit_shift;
+            if ((bit_shift != 0) && ((uint32_t)i > word_shift)) {
+                value |= window->bitmap[i - word_shift - 1] >> (32 - bit_shift);
+            }
+        }
+        window->bitmap[i] = value;
+    }
+}
+
+bool sda_replay_window_accept(sda_replay_window_s *window, uint32_t counter)
+{
+    uint32_t offset;
+
+    if (!window->started || (counter > window->top)) {
+        replay_window_shift(window, window->started ? (counter - window->top) : SDA_REPLAY_WINDOW_SIZE);
+        window->top = counter;
+        window->bitmap[0] |= 1;
+        window->started = true;
+        return true;
+    }
+
+    offset = window->top - counter;
+    if (offset >= SDA_REPLAY_WINDOW_SIZE) {
+        return false; // too old to tell
+    }
+
+    if (window->bitmap[offset / 32] & (1UL << (offset % 32))) {
+        return false; // replayed
+    }
+
+    window->bitmap[offset / 32] |= (1UL << (offset % 32));
+    return true;
+}
+
+void sda_replay_filter_init(sda_replay_filter_s *filter, uint32_t seed)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->seed = seed;
+}
+
+uint64_t sda_replay_filter_digest(const sda_replay_filter_s *filter, const uint8_t *request, size_t request_size)
+{
+    uint64_t hash = REPLAY_FNV_OFFSET ^ filter->seed;
+
+    // FNV-1a, then the MurmurHash3 finalizer so every digest bit depends on every input bit
+    for (size_t i = 0; i < request_size; i++) {
+        hash ^= request[i];
+        hash *= REPLAY_FNV_PRIME;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static uint32_t replay_filter_fingerprint(uint64_t digest)
+{
+    uint32_t fingerprint = (uint32_t)(digest >> 32);
+
+    return (fingerprint != 0) ? fingerprint : 1;
+}
+
+// Partial-key cuckoo hashing: the other bucket is found from a bucket and the fingerprint alone
+static uint32_t replay_filter_alt_bucket(uint32_t bucket, uint32_t fingerprint)
+{
+    return (bucket ^ (fingerprint * 0x9E3779B1UL)) & REPLAY_FILTER_BUCKET_MASK;
+}
+
+static bool replay_filter_bucket_contains(const sda_replay_filter_generation_s *generation, uint32_t bucket, uint32_t fingerprint)
+{
+    const uint32_t *slots = generation->fingerprints[bucket];
+
+    return (slots[0] == fingerprint) | (slots[1] == fingerprint) | (slots[2] == fingerprint) | (slots[3] == fingerprint);
+}
+
+static bool replay_filter_bucket_insert(sda_replay_filter_generation_s *generation, uint32_t bucket, uint32_t fingerprint)
+{
+    for (size_t slot = 0; slot < SDA_REPLAY_FILTER_SLOTS; slot++) {
+        if (generation->fingerprints[bucket][slot] == 0) {
+            generation->fingerprints[bucket][slot] = fingerprint;
+            generation->count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drops the previous generation, the current one becomes the previous
+static sda_replay_filter_generation_s *replay_filter_rotate(sda_replay_filter_s *filter)
+{
+    filter->current ^= 1;
+    memset(&filter->generations[filter->current], 0, sizeof(filter->generations[0]));
+    return &filter->generations[filter->current];
+}
+
+bool sda_replay_filter_contains(const sda_replay_filter_s *filter, uint64_t digest)
+{
+    uint32_t fingerprint = replay_filter_fingerprint(digest);
+    uint32_t bucket = (uint32_t)digest & REPLAY_FILTER_BUCKET_MASK;
+    uint32_t alt_bucket = replay_filter_alt_bucket(bucket, fingerprint);
+    bool found = false;
+
+    for (size_t i = 0; i < 2; i++) {
+        found |= replay_filter_bucket_contains(&filter->generations[i], bucket, fingerprint);
+        found |= replay_filter_bucket_contains(&filter->generations[i], alt_bucket, fingerprint);
+    }
+    return found;
+}
+
+void sda_replay_filter_insert(sda_replay_filter_s *filter, uint64_t digest)
+{
+    sda_replay_filter_generation_s *generation = &filter->generations[filter->current];
+    uint32_t fingerprint = replay_filter_fingerprint(digest);
+    uint32_t bucket = (uint32_t)digest & REPLAY_FILTER_BUCKET_MASK;
+
+    // Half load keeps cuckoo insertion short
+    if (generation->count >= (REPLAY_FILTER_CAPACITY / 2)) {
+        generation = replay_filter_rotate(filter);
+    }
+
+    if (replay_filter_bucket_insert(generation, bucket, fingerprint)) {
+        return;
+    }
+    bucket = replay_filter_alt_bucket(bucket, fingerprint);
+    if (replay_filter_bucket_insert(generation, bucket, fingerprint)) {
+        return;
+    }
+
+    // Both buckets full, relocate fingerprints until one finds a free slot
+    for (uint32_t kick = 0; kick < REPLAY_FILTER_MAX_KICKS; kick++) {
+        uint32_t slot = (fingerprint ^ kick) % SDA_REPLAY_FILTER_SLOTS;
+        uint32_t victim = generation->fingerprints[bucket][slot];
+
+        generation->fingerprints[bucket][slot] = fingerprint;
+        fingerprint = victim;
+        bucket = replay_filter_alt_bucket(bucket, fingerprint);
+        if (replay_filter_bucket_insert(generation, bucket, fingerprint)) {
+            return;
+        }
+    }
+
+    // Keep the fingerprint in hand in a fresh generation, the others stay in the previous one.
+    // It is the last victim, bucket is one of its own two buckets, not one of the digest
+    generation = replay_filter_rotate(filter);
+    replay_filter_bucket_insert(generation, bucket, fingerprint);
+}
@@ -0,0 +1,147 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_REPLAY_H__
+#define __SDA_REPLAY_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+* Replay protection in constant memory, no heap.
+*
+* - Sliding window: tracks the counters of a session. Counters up to
+*   SDA_REPLAY_WINDOW_SIZE behind the highest one seen are accepted once each,
+*   so reordered requests pass and replayed ones do not.
+*
+* - Request filter: a cuckoo filter of 32 bit fingerprints of recently accepted
+*   requests, for requests without a counter. Two generations are kept, when the
+*   current one is half full the previous one is dropped, so the filter always
+*   remembers at least the last SDA_REPLAY_FILTER_BUCKETS * SDA_REPLAY_FILTER_SLOTS / 2
+*   requests. Lookup and insert touch two buckets of each generation.
+*/
+
+/** Counters tracked behind the highest one, multiple of 32 */
+#ifndef SDA_REPLAY_WINDOW_SIZE
+#define SDA_REPLAY_WINDOW_SIZE 64
+#endif
+
+/** Buckets of a filter generation, power of 2 */
+#ifndef SDA_REPLAY_FILTER_BUCKETS
+#ifdef MBED_CONF_APP_REPLAY_FILTER_BUCKETS
+#define SDA_REPLAY_FILTER_BUCKETS MBED_CONF_APP_REPLAY_FILTER_BUCKETS
+#else
+#define SDA_REPLAY_FILTER_BUCKETS 32
+#endif
+#endif
+
+#define SDA_REPLAY_FILTER_SLOTS 4
+
+#if (SDA_REPLAY_WINDOW_SIZE % 32) != 0
+#error "SDA_REPLAY_WINDOW_SIZE must be a multiple of 32"
+#endif
+
+#if (SDA_REPLAY_FILTER_BUCKETS & (SDA_REPLAY_FILTER_BUCKETS - 1)) != 0
+#error "SDA_REPLAY_FILTER_BUCKETS must be a power of 2"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct sda_replay_window_ {
+    uint32_t top;                                   // Highest accepted counter
+    uint32_t bitmap[SDA_REPLAY_WINDOW_SIZE / 32];   // Bit n set: counter top - n accepted
+    bool started;
+} sda_replay_window_s;
+
+typedef struct sda_replay_filter_generation_ {
+    uint32_t fingerprints[SDA_REPLAY_FILTER_BUCKETS][SDA_REPLAY_FILTER_SLOTS];     // 0 is an empty slot
+    uint16_t count;
+} sda_replay_filter_generation_s;
+
+typedef struct sda_replay_filter_ {
+    sda_replay_filter_generation_s generations[2];
+    uint8_t current;
+    uint32_t seed;
+} sda_replay_filter_s;
+
+/**
+* Initializes a window, the first counter is accepted whatever its value.
+*
+* @param window[in] - The window
+*/
+void sda_replay_window_init(sda_replay_window_s *window);
+
+/**
+* Accepts a counter not seen before and not older than the window, and records it.
+* Call once the request carrying the counter is authenticated.
+*
+* @param window[in] - The window
+* @param counter[in] - Request counter
+*
+* @return "true" if accepted "false" for a replayed or too old counter.
+*/
+bool sda_replay_window_accept(sda_replay_window_s *window, uint32_t counter);
+
+/**
+* Initializes an empty filter.
+*
+* @param filter[in] - The filter
+* @param seed[in] - Digest seed, random per boot so fingerprints cannot be precomputed
+*/
+void sda_replay_filter_init(sda_replay_filter_s *filter, uint32_t seed);
+
+/**
+* Digests a request for the filter.
+*
+* @param filter[in] - The filter
+* @param request[in] - The request
+* @param request_size[in] - Request size
+*
+* @return The digest, the fingerprint and bucket index are taken from it.
+*/
+uint64_t sda_replay_filter_digest(const sda_replay_filter_s *filter, const uint8_t *request, size_t request_size);
+
+/**
+* Looks a request up.
+*
+* @param filter[in] - The filter
+* @param digest[in] - Request digest
+*
+* @return "true" if the request was seen recently (or a fingerprint collision, about
+*         4 * SDA_REPLAY_FILTER_SLOTS in 2^32), "false" otherwise.
+*/
+bool sda_replay_filter_contains(const sda_replay_filter_s *filter, uint64_t digest);
+
+/**
+* Records a request.
+*
+* @param filter[in] - The filter
+* @param digest[in] - Request digest
+*/
+void sda_replay_filter_insert(sda_replay_filter_s *filter, uint64_t digest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_REPLAY_H__
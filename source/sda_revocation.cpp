@@ -0,0 +1,445 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sda_revocation.h"
+#include "key_config_manager.h"
+#include "mbed-trace/mbed_trace.h"
+#include "mbedtls/sha256.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP                     "sdae"
+
+#define REVOCATION_BLOOM_MASK           (SDA_REVOCATION_BLOOM_BITS - 1)
+#define REVOCATION_SLOT_COUNT           2
+#define REVOCATION_SLOT_NONE            REVOCATION_SLOT_COUNT
+#define REVOCATION_CBOR_MAX_DEPTH       8
+
+#define REVOCATION_CBOR_MAJOR_BYTES     2
+#define REVOCATION_CBOR_MAJOR_TEXT      3
+#define REVOCATION_CBOR_MAJOR_ARRAY     4
+#define REVOCATION_CBOR_MAJOR_MAP       5
+#define REVOCATION_CBOR_MAJOR_TAG       6
+
+#define REVOCATION_CBOR_TAG_COSE_SIGN1  18
+#define REVOCATION_CBOR_TAG_CWT         61
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct revocation_ {
+    uint32_t bloom[SDA_REVOCATION_BLOOM_BITS / 32];
+    uint32_t version;
+    size_t count;
+    size_t slot;        // Item holding the list, REVOCATION_SLOT_NONE for none
+} revocation_s;
+
+// Token candidates of a request, see sda_revocation_request_is_revoked()
+typedef struct revocation_scan_ {
+    size_t count;
+    bool revoked;
+} revocation_scan_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static revocation_s g_revocation = { { 0 }, 0, 0, REVOCATION_SLOT_NONE };
+
+static const char *const g_revocation_item_names[REVOCATION_SLOT_COUNT] = {
+    SDA_REVOCATION_ITEM_NAME_0,
+    SDA_REVOCATION_ITEM_NAME_1
+};
+
+//////////////////////////////////////////////////////////
+
+static uint32_t revocation_get_u32(const uint8_t *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | buf[3];
+}
+
+// The token hash is uniformly distributed already, each 4 bytes of it select one bit
+static uint32_t revocation_bloom_bit(const uint8_t *token_hash, size_t index)
+{
+    return revocation_get_u32(&token_hash[index * 4]) & REVOCATION_BLOOM_MASK;
+}
+
+// Checks the size and the order of a list
+static bool revocation_list_validate(const uint8_t *list, size_t list_size)
+{
+    size_t count;
+
+    if ((list_size < SDA_REVOCATION_VERSION_SIZE) || (((list_size - SDA_REVOCATION_VERSION_SIZE) % SDA_REVOCATION_TOKEN_HASH_SIZE) != 0)) {
+        tr_error("Malformed revocation list (%u bytes)", (unsigned)list_size);
+        return false;
+    }
+
+    count = (list_size - SDA_REVOCATION_VERSION_SIZE) / SDA_REVOCATION_TOKEN_HASH_SIZE;
+    if (count > SDA_REVOCATION_MAX_COUNT) {
+        tr_error("Revocation list too long (%u)", (unsigned)count);
+        return false;
+    }
+
+    // Strictly ascending, the exact check binary searches
+    for (size_t i = 1; i < count; i++) {
+        const uint8_t *entry = &list[SDA_REVOCATION_VERSION_SIZE + i * SDA_REVOCATION_TOKEN_HASH_SIZE];
+
+        if (memcmp(entry - SDA_REVOCATION_TOKEN_HASH_SIZE, entry, SDA_REVOCATION_TOKEN_HASH_SIZE) >= 0) {
+            tr_error("Revocation list not sorted");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void revocation_build(revocation_s *revocation, const uint8_t *list, size_t list_size, size_t slot)
+{
+    memset(revocation, 0, sizeof(*revocation));
+    revocation->slot = slot;
+    if (list == NULL) {
+        return;
+    }
+
+    revocation->version = revocation_get_u32(list);
+    revocation->count = (list_size - SDA_REVOCATION_VERSION_SIZE) / SDA_REVOCATION_TOKEN_HASH_SIZE;
+
+    for (size_t i = 0; i < revocation->count; i++) {
+        const uint8_t *entry = &list[SDA_REVOCATION_VERSION_SIZE + i * SDA_REVOCATION_TOKEN_HASH_SIZE];
+
+        for (size_t k = 0; k < SDA_REVOCATION_BLOOM_HASHES; k++) {
+            uint32_t bit = revocation_bloom_bit(entry, k);
+
+            revocation->bloom[bit / 32] |= (1UL << (bit % 32));
+        }
+    }
+}
+
+// Reads the list of a slot into a buffer the caller frees, *list is NULL if there is none
+static bool revocation_list_read(size_t slot, uint8_t **list, size_t *list_size)
+{
+    const char *name = g_revocation_item_names[slot];
+    size_t item_size = 0;
+    kcm_status_e kcm_status;
+
+    *list = NULL;
+    *list_size = 0;
+
+    kcm_status = kcm_item_get_data_size((const uint8_t *)name, strlen(name), KCM_CONFIG_ITEM, &item_size);
+    if (kcm_status == KCM_STATUS_ITEM_NOT_FOUND) {
+        return true;
+    }
+    if (kcm_status != KCM_STATUS_SUCCESS) {
+        tr_error("Failed reading revocation list size (%u)", kcm_status);
+        return false;
+    }
+
+    *list = (uint8_t *)malloc(item_size);
+    if (*list == NULL) {
+        tr_error("Failed allocating revocation list (%u bytes)", (unsigned)item_size);
+        return false;
+    }
+
+    kcm_status = kcm_item_get_data((const uint8_t *)name, strlen(name), KCM_CONFIG_ITEM, *list, item_size, list_size);
+    if (kcm_status != KCM_STATUS_SUCCESS) {
+        tr_error("Failed reading revocation list (%u)", kcm_status);
+        free(*list);
+        *list = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+bool sda_revocation_load(void)
+{
+    uint8_t *lists[REVOCATION_SLOT_COUNT] = { NULL };
+    size_t list_sizes[REVOCATION_SLOT_COUNT] = { 0 };
+    size_t current = REVOCATION_SLOT_NONE;
+    bool success = true;
+
+    revocation_build(&g_revocation, NULL, 0, REVOCATION_SLOT_NONE);
+
+    for (size_t slot = 0; (slot < REVOCATION_SLOT_COUNT) && success; slot++) {
+        success = revocation_list_read(slot, &lists[slot], &list_sizes[slot]);
+        if (!success || (lists[slot] == NULL)) {
+            continue;
+        }
+
+        // Items are written whole, an invalid one is corrupted and may have been the current list
+        success = revocation_list_validate(lists[slot], list_sizes[slot]);
+        if (!success) {
+            continue;
+        }
+
+        if ((current == REVOCATION_SLOT_NONE) || (revocation_get_u32(lists[slot]) > revocation_get_u32(lists[current]))) {
+            current = slot;
+        }
+    }
+
+    if (success && (current != REVOCATION_SLOT_NONE)) {
+        revocation_build(&g_revocation, lists[current], list_sizes[current], current);
+    }
+
+    for (size_t slot = 0; slot < REVOCATION_SLOT_COUNT; slot++) {
+        free(lists[slot]);
+    }
+
+    if (!success) {
+        return false;
+    }
+
+    tr_info("Revocation list version %u, %u token(s)", (unsigned)g_revocation.version, (unsigned)g_revocation.count);
+    return true;
+}
+
+sda_status_e sda_revocation_update(const uint8_t *list, size_t list_size)
+{
+    // The item not holding the current list, it is stale or missing
+    size_t slot = (g_revocation.slot == 0) ? 1 : 0;
+    const char *name = g_revocation_item_names[slot];
+    kcm_status_e kcm_status;
+
+    if ((list == NULL) || !revocation_list_validate(list, list_size)) {
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    // A captured older list must not bring revoked tokens back
+    if (revocation_get_u32(list) <= g_revocation.version) {
+        tr_error("Revocation list version %u not newer than %u", (unsigned)revocation_get_u32(list), (unsigned)g_revocation.version);
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    // Write the new list next to the current one, a power loss at any point leaves the current list in place
+    kcm_status = kcm_item_delete((const uint8_t *)name, strlen(name), KCM_CONFIG_ITEM);
+    if ((kcm_status != KCM_STATUS_SUCCESS) && (kcm_status != KCM_STATUS_ITEM_NOT_FOUND)) {
+        tr_error("Failed deleting stale revocation list (%u)", kcm_status);
+        return SDA_STATUS_OPERATION_EXECUTION_ERROR;
+    }
+
+    kcm_status = kcm_item_store((const uint8_t *)name, strlen(name), KCM_CONFIG_ITEM, false, list, list_size, NULL);
+    if (kcm_status != KCM_STATUS_SUCCESS) {
+        tr_error("Failed storing revocation list (%u)", kcm_status);
+        return SDA_STATUS_OPERATION_EXECUTION_ERROR;
+    }
+
+    // The stored list is the greater version, it is the current one from here on
+    revocation_build(&g_revocation, list, list_size, slot);
+
+    tr_info("Revocation list updated to version %u, %u token(s)", (unsigned)g_revocation.version, (unsigned)g_revocation.count);
+    return SDA_STATUS_SUCCESS;
+}
+
+// Reads a CBOR head, indefinite lengths are not used by SDA messages
+static bool revocation_cbor_head(const uint8_t **p, const uint8_t *end, uint8_t *major, uint64_t *arg)
+{
+    uint8_t info;
+    size_t arg_size;
+
+    if (*p >= end) {
+        return false;
+    }
+
+    *major = **p >> 5;
+    info = **p & 0x1F;
+    (*p)++;
+
+    if (info < 24) {
+        *arg = info;
+        return true;
+    }
+    if (info > 27) {
+        return false;
+    }
+
+    arg_size = (size_t)1 << (info - 24);
+    if (arg_size > (size_t)(end - *p)) {
+        return false;
+    }
+
+    *arg = 0;
+    for (size_t i = 0; i < arg_size; i++) {
+        *arg = (*arg << 8) | *(*p)++;
+    }
+    return true;
+}
+
+// A COSE_Sign1, tagged or not: an array of 4 starting with the protected header byte string
+static bool revocation_is_cose_sign1(const uint8_t *data, size_t data_size)
+{
+    if ((data_size >= 2) && (data[0] == 0xD2)) {
+        return (data[1] == 0x84);
+    }
+    if ((data_size >= 3) && (data[0] == 0xD8) && (data[1] == REVOCATION_CBOR_TAG_CWT)) {
+        return true;
+    }
+    return (data_size >= 2) && (data[0] == 0x84) && ((data[1] >> 5) == REVOCATION_CBOR_MAJOR_BYTES);
+}
+
+// Checks one token candidate, one that cannot be hashed counts as revoked
+static void revocation_scan_token(revocation_scan_s *scan, const uint8_t *token, size_t token_size)
+{
+    uint8_t token_hash[SDA_REVOCATION_TOKEN_HASH_SIZE];
+
+    scan->count++;
+    if (!sda_revocation_token_hash(token, token_size, token_hash) || sda_revocation_is_revoked(token_hash)) {
+        scan->revoked = true;
+    }
+}
+
+// Skips one item, checking every token candidate in it
+static bool revocation_cbor_walk(const uint8_t **p, const uint8_t *end, size_t depth, revocation_scan_s *scan)
+{
+    const uint8_t *start = *p;
+    uint8_t major;
+    uint64_t arg;
+    uint64_t items;
+
+    if ((depth > REVOCATION_CBOR_MAX_DEPTH) || !revocation_cbor_head(p, end, &major, &arg)) {
+        return false;
+    }
+
+    switch (major) {
+        case REVOCATION_CBOR_MAJOR_BYTES:
+        case REVOCATION_CBOR_MAJOR_TEXT:
+            if (arg > (uint64_t)(end - *p)) {
+                return false;
+            }
+            if ((major == REVOCATION_CBOR_MAJOR_BYTES) && revocation_is_cose_sign1(*p, (size_t)arg)) {
+                revocation_scan_token(scan, *p, (size_t)arg);
+            }
+            *p += arg;
+            return true;
+
+        case REVOCATION_CBOR_MAJOR_ARRAY:
+        case REVOCATION_CBOR_MAJOR_MAP:
+            items = (major == REVOCATION_CBOR_MAJOR_MAP) ? (arg * 2) : arg;
+            for (uint64_t i = 0; (i < items) && !scan->revoked; i++) {
+                if (!revocation_cbor_walk(p, end, depth + 1, scan)) {
+                    return false;
+                }
+            }
+            return true;
+
+        case REVOCATION_CBOR_MAJOR_TAG:
+            if (!revocation_cbor_walk(p, end, depth + 1, scan)) {
+                return false;
+            }
+            if (!scan->revoked && ((arg == REVOCATION_CBOR_TAG_COSE_SIGN1) || (arg == REVOCATION_CBOR_TAG_CWT))) {
+                revocation_scan_token(scan, start, (size_t)(*p - start));
+            }
+            return true;
+
+        default: // integers and simple values, the head holds them
+            return true;
+    }
+}
+
+bool sda_revocation_request_is_revoked(const uint8_t *request, size_t request_size)
+{
+    revocation_scan_s scan = { 0, false };
+    const uint8_t *p = request;
+
+    if (request == NULL) {
+        return true;
+    }
+
+    // Which candidate the SDA library verified is not known here, so none may be revoked
+    if (!revocation_cbor_walk(&p, request + request_size, 0, &scan) && !scan.revoked) {
+        tr_warn("Request not decodable for the revocation check");
+        return true;
+    }
+    if (scan.count == 0) {
+        tr_warn("Access token not found in request");
+        return true;
+    }
+    return scan.revoked;
+}
+
+bool sda_revocation_token_hash(const uint8_t *token, size_t token_size, uint8_t *token_hash)
+{
+    uint8_t hash[32];
+
+    if (mbedtls_sha256_ret(token, token_size, hash, 0) != 0) {
+        return false;
+    }
+
+    memcpy(token_hash, hash, SDA_REVOCATION_TOKEN_HASH_SIZE);
+    return true;
+}
+
+// Exact confirmation of a filter hit
+static bool revocation_list_contains(const uint8_t *token_hash)
+{
+    uint8_t *list = NULL;
+    size_t list_size = 0;
+    size_t low = 0;
+    size_t high;
+    bool found = false;
+
+    // Cannot tell, reject
+    if ((g_revocation.slot == REVOCATION_SLOT_NONE) || !revocation_list_read(g_revocation.slot, &list, &list_size)) {
+        return true;
+    }
+    if ((list == NULL) || !revocation_list_validate(list, list_size)) {
+        free(list);
+        return true;
+    }
+
+    high = (list_size - SDA_REVOCATION_VERSION_SIZE) / SDA_REVOCATION_TOKEN_HASH_SIZE;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int diff = memcmp(&list[SDA_REVOCATION_VERSION_SIZE + middle * SDA_REVOCATION_TOKEN_HASH_SIZE], token_hash, SDA_REVOCATION_TOKEN_HASH_SIZE);
+
+        if (diff == 0) {
+            found = true;
+            break;
+        }
+        if (diff < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    free(list);
+    return found;
+}
+
+bool sda_revocation_is_revoked(const uint8_t *token_hash)
+{
+    uint32_t hit = 1;
+
+    // All bits are read, the time does not depend on the token
+    for (size_t k = 0; k < SDA_REVOCATION_BLOOM_HASHES; k++) {
+        uint32_t bit = revocation_bloom_bit(token_hash, k);
+
+        hit &= (g_revocation.bloom[bit / 32] >> (bit % 32));
+    }
+
+    if (!hit) {
+        return false;
+    }
+
+    return revocation_list_contains(token_hash);
+}
+
+uint32_t sda_revocation_version(void)
+{
+    return g_revocation.version;
+}
@@ -0,0 +1,145 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_REVOCATION_H__
+#define __SDA_REVOCATION_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "sda_status.h"
+
+/**
+* Access token revocation list.
+*
+* A token is identified by the first SDA_REVOCATION_TOKEN_HASH_SIZE bytes of the SHA-256
+* of the token as carried in the request. The list is stored in KCM as
+*
+*   version (4, big endian) | token hashes, sorted ascending
+*
+* and replaced by a list with a greater version only. The list is written alternately to
+* two items, the one holding the current list is never deleted: a new list goes to the
+* other item and the greater valid version of the two is the current list.
+* Only a Bloom filter of the list
+* is kept in RAM: a token is checked by reading SDA_REVOCATION_BLOOM_HASHES bits taken
+* straight from its hash, whatever the list size. The list itself is read from KCM and
+* binary searched only when all bits are set, so false positives never reject a token.
+*/
+
+/** Function a token must grant to update the list */
+#define SDA_REVOCATION_UPDATE_FUNC_NAME "update-revocation-list"
+
+/** KCM config items holding the list, see above */
+#define SDA_REVOCATION_ITEM_NAME_0 "sda_revoked.0"
+#define SDA_REVOCATION_ITEM_NAME_1 "sda_revoked.1"
+
+#define SDA_REVOCATION_TOKEN_HASH_SIZE  16
+#define SDA_REVOCATION_VERSION_SIZE     4
+
+/** Tokens in the list */
+#ifndef SDA_REVOCATION_MAX_COUNT
+#ifdef MBED_CONF_APP_REVOCATION_MAX_COUNT
+#define SDA_REVOCATION_MAX_COUNT MBED_CONF_APP_REVOCATION_MAX_COUNT
+#else
+#define SDA_REVOCATION_MAX_COUNT 256
+#endif
+#endif
+
+/** Bloom filter bits, power of 2. 8 bits per token keep false positives around 2% */
+#ifndef SDA_REVOCATION_BLOOM_BITS
+#ifdef MBED_CONF_APP_REVOCATION_BLOOM_BITS
+#define SDA_REVOCATION_BLOOM_BITS MBED_CONF_APP_REVOCATION_BLOOM_BITS
+#else
+#define SDA_REVOCATION_BLOOM_BITS 2048
+#endif
+#endif
+
+/** Bits set per token, each taken from 4 bytes of the token hash */
+#define SDA_REVOCATION_BLOOM_HASHES     (SDA_REVOCATION_TOKEN_HASH_SIZE / 4)
+
+#if ((SDA_REVOCATION_BLOOM_BITS & (SDA_REVOCATION_BLOOM_BITS - 1)) != 0) || (SDA_REVOCATION_BLOOM_BITS < 32)
+#error "SDA_REVOCATION_BLOOM_BITS must be a power of 2, at least 32"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* Loads the current list from KCM and builds its Bloom filter. A missing list is an empty one.
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_revocation_load(void);
+
+/**
+* Validates, stores and loads a new list. Call from the application callback of a
+* verified SDA_REVOCATION_UPDATE_FUNC_NAME request. A failure keeps the current list.
+*
+* @param list[in] - The list, see above
+* @param list_size[in] - List size
+*
+* @return SDA_STATUS_SUCCESS in case of success, SDA_STATUS_INVALID_REQUEST for a malformed
+*         or not newer list or one of sda_status_e otherwise.
+*/
+sda_status_e sda_revocation_update(const uint8_t *list, size_t list_size);
+
+/**
+* Checks the access token of a verified SDA request against the list. Every COSE_Sign1
+* in the CBOR message, tagged or wrapped in a byte string, is a candidate, and none of them
+* may be revoked: a byte string the client chose cannot stand in for the verified token.
+*
+* @param request[in] - The request
+* @param request_size[in] - Request size
+*
+* @return "true" if a candidate is revoked, or the request has none or cannot be decoded,
+*         "false" otherwise.
+*/
+bool sda_revocation_request_is_revoked(const uint8_t *request, size_t request_size);
+
+/**
+* Hashes a token.
+*
+* @param token[in] - The token
+* @param token_size[in] - Token size
+* @param token_hash[out] - SDA_REVOCATION_TOKEN_HASH_SIZE bytes
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_revocation_token_hash(const uint8_t *token, size_t token_size, uint8_t *token_hash);
+
+/**
+* Checks a token against the list.
+*
+* @param token_hash[in] - SDA_REVOCATION_TOKEN_HASH_SIZE bytes
+*
+* @return "true" if revoked, or if a Bloom filter hit cannot be confirmed from KCM, "false" otherwise.
+*/
+bool sda_revocation_is_revoked(const uint8_t *token_hash);
+
+/**
+* Returns the version of the loaded list, 0 for none.
+*/
+uint32_t sda_revocation_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_REVOCATION_H__
@@ -0,0 +1,164 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include <string.h>
+#include <atomic>
+
+#include "sda_ring.h"
+
+//////////////////////////////////////////////////////////
+
+bool sda_ring_init(sda_ring_s *ring, uint8_t *buffer, size_t buffer_size)
+{
+    if ((buffer == NULL) || (buffer_size == 0) || ((buffer_size & (buffer_size - 1)) != 0)) {
+        return false;
+    }
+
+    ring->buffer = buffer;
+    ring->mask = (uint32_t)(buffer_size - 1);
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    return true;
+}
+
+size_t sda_ring_push(sda_ring_s *ring, const uint8_t *data, size_t data_size)
+{
+    uint32_t head = ring->head;
+    uint32_t free_size = (ring->mask + 1) - (head - ring->tail);
+    uint32_t offset;
+    uint32_t first;
+
+    // Acquire: the consumer is done with the bytes before tail
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (data_size > free_size) {
+        ring->dropped += (uint32_t)(data_size - free_size);
+        data_size = free_size;
+    }
+
+    offset = head & ring->mask;
+    first = (ring->mask + 1) - offset;
+    if (first > data_size) {
+        first = (uint32_t)data_size;
+    }
+    memcpy(&ring->buffer[offset], data, first);
+    memcpy(ring->buffer, data + first, data_size - first);
+
+    // Release: the bytes are in place before the consumer sees head
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->head = head + (uint32_t)data_size;
+    return data_size;
+}
+
+size_t sda_ring_count(const sda_ring_s *ring)
+{
+    return (size_t)(ring->head - ring->tail);
+}
+
+size_t sda_ring_read(sda_ring_s *ring, uint8_t *data, size_t data_size)
+{
+    uint32_t tail = ring->tail;
+    uint32_t count = ring->head - tail;
+    uint32_t offset;
+    uint32_t first;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (data_size > count) {
+        data_size = count;
+    }
+
+    offset = tail & ring->mask;
+    first = (ring->mask + 1) - offset;
+    if (first > data_size) {
+        first = (uint32_t)data_size;
+    }
+    memcpy(data, &ring->buffer[offset], first);
+    memcpy(data + first, ring->buffer, data_size - first);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->tail = tail + (uint32_t)data_size;
+    return data_size;
+}
+
+void sda_ring_token_scan_init(sda_ring_token_scan_s *scan, const uint8_t *token, size_t token_size)
+{
+    scan->token = token;
+    scan->token_size = token_size;
+    scan->matched = 0;
+    scan->consumed = 0;
+}
+
+// Longest prefix of the token that ends the matched bytes followed by byte
+static size_t ring_token_rematch(const sda_ring_token_scan_s *scan, uint8_t byte)
+{
+    for (size_t candidate = scan->matched; candidate > 0; candidate--) {
+        // token[0..candidate-1] == token[matched-candidate+1..matched-1] + byte
+        if ((scan->token[candidate - 1] == byte) &&
+            (memcmp(scan->token, &scan->token[scan->matched - candidate + 1], candidate - 1) == 0)) {
+            return candidate;
+        }
+    }
+    return 0;
+}
+
+// Feeds one byte, returns "true" when it completes the token
+static bool ring_token_feed(sda_ring_token_scan_s *scan, uint8_t byte)
+{
+    if (byte == scan->token[scan->matched]) {
+        scan->matched++;
+    } else {
+        scan->matched = ring_token_rematch(scan, byte);
+    }
+    scan->consumed++;
+    return (scan->matched == scan->token_size);
+}
+
+int sda_ring_tokens_scan(sda_ring_s *ring, sda_ring_token_scan_s *scans, size_t scans_count)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = ring->head;
+    int found = -1;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // Walks the bytes in place, nothing is copied out
+    while ((tail != head) && (found < 0)) {
+        uint8_t byte = ring->buffer[tail & ring->mask];
+
+        for (size_t i = 0; i < scans_count; i++) {
+            if (ring_token_feed(&scans[i], byte) && (found < 0)) {
+                found = (int)i;
+            }
+        }
+        tail++;
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->tail = tail;
+    return found;
+}
+
+bool sda_ring_token_scan(sda_ring_s *ring, sda_ring_token_scan_s *scan)
+{
+    if (scan->matched == scan->token_size) {
+        return true;
+    }
+    return (sda_ring_tokens_scan(ring, scan, 1) == 0);
+}
@@ -0,0 +1,144 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_RING_H__
+#define __SDA_RING_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+* Lock-free single-producer/single-consumer byte ring.
+*
+* The producer, typically the UART RX interrupt or a DMA completion handler, only
+* writes head, the consumer only writes tail, so neither side masks interrupts.
+* Both sides move spans with memcpy rather than single bytes. Nothing here is
+* platform specific, any thread or a pty reader can act as the producer.
+*/
+
+/** Bytes of the serial transport ring, power of 2 */
+#ifndef SDA_RING_SIZE
+#ifdef MBED_CONF_APP_SERIAL_RING_SIZE
+#define SDA_RING_SIZE MBED_CONF_APP_SERIAL_RING_SIZE
+#else
+#define SDA_RING_SIZE 1024
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct sda_ring_ {
+    uint8_t *buffer;
+    uint32_t mask;              // size - 1
+    volatile uint32_t head;     // free running, written by the producer
+    volatile uint32_t tail;     // free running, written by the consumer
+    volatile uint32_t dropped;  // free running, bytes the producer found no room for
+} sda_ring_s;
+
+/** Incremental search of a header token, survives spans split across reads */
+typedef struct sda_ring_token_scan_ {
+    const uint8_t *token;
+    size_t token_size;
+    size_t matched;
+    size_t consumed;            // bytes consumed since init, consumed - matched were not part of a token
+} sda_ring_token_scan_s;
+
+/**
+* Initializes an empty ring.
+*
+* @param ring[in] - The ring
+* @param buffer[in] - Storage, buffer_size bytes
+* @param buffer_size[in] - Power of 2
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_ring_init(sda_ring_s *ring, uint8_t *buffer, size_t buffer_size);
+
+/**
+* Producer side, appends bytes. Bytes that do not fit are counted in dropped.
+*
+* @param ring[in] - The ring
+* @param data[in] - Received bytes
+* @param data_size[in] - Received bytes count
+*
+* @return Bytes appended.
+*/
+size_t sda_ring_push(sda_ring_s *ring, const uint8_t *data, size_t data_size);
+
+/**
+* Consumer side, bytes ready to read.
+*
+* @param ring[in] - The ring
+*
+* @return Bytes ready.
+*/
+size_t sda_ring_count(const sda_ring_s *ring);
+
+/**
+* Consumer side, moves out up to data_size bytes.
+*
+* @param ring[in] - The ring
+* @param data[out] - Destination
+* @param data_size[in] - Bytes wanted
+*
+* @return Bytes read, less than data_size if the ring ran empty.
+*/
+size_t sda_ring_read(sda_ring_s *ring, uint8_t *data, size_t data_size);
+
+/**
+* Consumer side, drops bytes until a complete token was consumed.
+*
+* @param ring[in] - The ring
+* @param scan[in] - Scan state, reset by sda_ring_token_scan_init()
+*
+* @return "true" once the token was consumed, "false" if the ring ran empty first.
+*/
+bool sda_ring_token_scan(sda_ring_s *ring, sda_ring_token_scan_s *scan);
+
+/**
+* Consumer side, drops bytes until one of several tokens was consumed. The scans
+* look at the same bytes, the first token to complete wins. Reset all scans before
+* the next search.
+*
+* @param ring[in] - The ring
+* @param scans[in] - Scan states, each reset by sda_ring_token_scan_init()
+* @param scans_count[in] - Number of scans
+*
+* @return Index of the scan whose token was consumed, -1 if the ring ran empty first.
+*/
+int sda_ring_tokens_scan(sda_ring_s *ring, sda_ring_token_scan_s *scans, size_t scans_count);
+
+/**
+* Starts a token search.
+*
+* @param scan[in] - Scan state
+* @param token[in] - The token
+* @param token_size[in] - Token size
+*/
+void sda_ring_token_scan_init(sda_ring_token_scan_s *scan, const uint8_t *token, size_t token_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_RING_H__
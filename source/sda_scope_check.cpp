@@ -0,0 +1,77 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include <string.h>
+
+#include "sda_scope_check.h"
+#include "mbed-trace/mbed_trace.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP           "sdae"
+
+//////////////////////////////////////////////////////////
+
+sda_status_e sda_scope_check(sda_scope_get_next_cb scope_get_next, void *scope_list, const uint8_t *func_name, size_t func_name_size)
+{
+    sda_status_e status;
+    const uint8_t *scope;
+    size_t scope_size;
+
+    do {
+
+        scope = NULL;
+        scope_size = 0;
+
+        // Get next available scope in list
+        status = scope_get_next(scope_list, &scope, &scope_size);
+
+        // Check if end of scope list reached
+        if (status == SDA_STATUS_NO_MORE_SCOPES) {
+            tr_error("No match found for operation, permission denied");
+            return status;
+        }
+
+        if (status != SDA_STATUS_SUCCESS) {
+            tr_error("Failed getting scope, permission denied");
+            return status;
+        }
+
+        if ((scope == NULL) || (scope_size == 0)) {
+            tr_warn("Got empty or invalid scope, skipping this scope");
+            continue;
+        }
+
+        // Check operation is in scope
+
+        // Check that function name has the exact scope size
+        if (scope_size != func_name_size) {
+            continue;
+        }
+
+        // Check that function name and scope are binary equal
+        if (memcmp(func_name, scope, func_name_size) != 0) {
+            continue;
+        }
+
+        tr_info("Operation in scope, access granted");
+
+        return SDA_STATUS_SUCCESS; // operation permitted
+
+    } while (true);
+}
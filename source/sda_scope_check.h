@@ -0,0 +1,60 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_SCOPE_CHECK_H__
+#define __SDA_SCOPE_CHECK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sda_status.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Fetches the next scope of a scope list.
+*
+* Has the same contract as sda_scope_get_next(): returns SDA_STATUS_NO_MORE_SCOPES
+* once the list is exhausted.
+*
+* @param scope_list[in] - The scope list (e.g. an SDA operation context)
+* @param scope_out[out] - The next scope
+* @param scope_size_out[out] - The next scope size in bytes
+*/
+typedef sda_status_e (*sda_scope_get_next_cb)(void *scope_list, const uint8_t **scope_out, size_t *scope_size_out);
+
+/** Checks whether a function name is one of the scopes in a scope list.
+*
+* This is the pure matching part of the permission check, it has no side effects
+* other than tracing, so it can be measured in isolation from the SDA library.
+*
+* @param scope_get_next[in] - Scope list iterator
+* @param scope_list[in] - The scope list passed to scope_get_next
+* @param func_name[in] - Function name in its string representation
+* @param func_name_size[in] - Function name length
+*
+* @return SDA_STATUS_SUCCESS if the function name is in scope,
+*         SDA_STATUS_NO_MORE_SCOPES if no scope matched or the iterator error otherwise.
+*/
+sda_status_e sda_scope_check(sda_scope_get_next_cb scope_get_next, void *scope_list, const uint8_t *func_name, size_t func_name_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_SCOPE_CHECK_H__
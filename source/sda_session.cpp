@@ -0,0 +1,452 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include <string.h>
+
+#include "sda_session.h"
+#include "sda_replay.h"
+#include "sda_macros.h"
+#include "pal.h"
+#include "mbed-trace/mbed_trace.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/md.h"
+#include "mbedtls/sha256.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP           "sdae"
+
+#define SESSION_MAGIC                   "SDAS"
+#define SESSION_MAGIC_SIZE              4
+#define SESSION_HEADER_SIZE             (SESSION_MAGIC_SIZE + 1 + SDA_SESSION_ID_SIZE + 4)
+#define SESSION_KDF_LABEL               "sda-session-v1"
+#define SESSION_SHARED_SECRET_SIZE      32
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct session_ {
+    bool open;
+    uint8_t id[SDA_SESSION_ID_SIZE];
+    uint8_t key[SDA_SESSION_KEY_SIZE];
+    sda_replay_window_s counters;       // Counters of accepted requests
+    uint64_t expiry_tick;
+    uint8_t scopes[SDA_SESSION_SCOPES_SIZE];
+    uint16_t scope_offsets[SDA_SESSION_MAX_SCOPES];
+    uint16_t scope_sizes[SDA_SESSION_MAX_SCOPES];
+    size_t scopes_count;
+} session_s;
+
+typedef struct session_scope_cursor_ {
+    const session_s *session;
+    size_t index;
+} session_scope_cursor_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+// SDA serves one client at a time, so does the session
+static session_s g_session;
+
+//////////////////////////////////////////////////////////
+
+static void session_put_u32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t)(value >> 24);
+    buffer[1] = (uint8_t)(value >> 16);
+    buffer[2] = (uint8_t)(value >> 8);
+    buffer[3] = (uint8_t)value;
+}
+
+static uint32_t session_get_u32(const uint8_t *buffer)
+{
+    return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | buffer[3];
+}
+
+// Wipes memory the compiler may not optimize away
+static void session_zeroize(void *buffer, size_t size)
+{
+    volatile uint8_t *p = (volatile uint8_t *)buffer;
+
+    while (size--) {
+        *p++ = 0;
+    }
+}
+
+// Constant time comparison, the time does not depend on the position of the first difference
+static bool session_tag_equal(const uint8_t *a, const uint8_t *b, size_t size)
+{
+    uint8_t diff = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return (diff == 0);
+}
+
+static bool session_tag_compute(const uint8_t *key, const uint8_t *data, size_t data_size, uint8_t *tag)
+{
+    uint8_t mac[32];
+    int mbedtls_status;
+
+    mbedtls_status = mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key, SDA_SESSION_KEY_SIZE, data, data_size, mac);
+    memcpy(tag, mac, SDA_SESSION_TAG_SIZE);
+    return (mbedtls_status == 0);
+}
+
+static int session_random(void *context, unsigned char *output, size_t output_size)
+{
+    SDA_UNUSED_PARAM(context);
+
+    return (pal_osRandomBuffer(output, output_size) == PAL_SUCCESS) ? 0 : MBEDTLS_ERR_ECP_RANDOM_FAILED;
+}
+
+static uint64_t session_now_tick(void)
+{
+    return pal_osKernelSysTick();
+}
+
+static sda_status_e session_scope_get_next(void *scope_list, const uint8_t **scope_out, size_t *scope_size_out)
+{
+    session_scope_cursor_s *cursor = (session_scope_cursor_s *)scope_list;
+    const session_s *session = cursor->session;
+
+    if (cursor->index >= session->scopes_count) {
+        return SDA_STATUS_NO_MORE_SCOPES;
+    }
+
+    *scope_out = &session->scopes[session->scope_offsets[cursor->index]];
+    *scope_size_out = session->scope_sizes[cursor->index];
+    cursor->index++;
+    return SDA_STATUS_SUCCESS;
+}
+
+// Copies all scopes of the token into the session and hashes them for the key derivation
+static sda_status_e session_scopes_capture(session_s *session, sda_scope_get_next_cb scope_get_next, void *scope_list, uint8_t *scopes_hash)
+{
+    mbedtls_sha256_context sha256;
+    const uint8_t *scope = NULL;
+    size_t scope_size = 0;
+    size_t offset = 0;
+    sda_status_e status = SDA_STATUS_SUCCESS;
+
+    mbedtls_sha256_init(&sha256);
+    mbedtls_sha256_starts_ret(&sha256, 0);
+
+    session->scopes_count = 0;
+    while ((status = scope_get_next(scope_list, &scope, &scope_size)) == SDA_STATUS_SUCCESS) {
+        uint8_t scope_size_be[2] = { (uint8_t)(scope_size >> 8), (uint8_t)scope_size };
+
+        if ((session->scopes_count == SDA_SESSION_MAX_SCOPES) || (scope_size > (sizeof(session->scopes) - offset))) {
+            tr_error("Token scopes do not fit a session (%u scopes, %u bytes max)",
+                     (unsigned)SDA_SESSION_MAX_SCOPES, (unsigned)sizeof(session->scopes));
+            status = SDA_STATUS_INVALID_REQUEST;
+            break;
+        }
+
+        memcpy(&session->scopes[offset], scope, scope_size);
+        session->scope_offsets[session->scopes_count] = (uint16_t)offset;
+        session->scope_sizes[session->scopes_count] = (uint16_t)scope_size;
+        session->scopes_count++;
+        offset += scope_size;
+
+        mbedtls_sha256_update_ret(&sha256, scope_size_be, sizeof(scope_size_be));
+        mbedtls_sha256_update_ret(&sha256, scope, scope_size);
+    }
+
+    if (status == SDA_STATUS_NO_MORE_SCOPES) {
+        status = SDA_STATUS_SUCCESS;
+        mbedtls_sha256_finish_ret(&sha256, scopes_hash);
+    }
+
+    mbedtls_sha256_free(&sha256);
+    return status;
+}
+
+bool sda_session_key_derive(const uint8_t *shared_secret, size_t shared_secret_size, const uint8_t *session_id,
+                            const uint8_t *scopes_hash, uint32_t lifetime_sec, uint8_t *key)
+{
+    uint8_t info[sizeof(SESSION_KDF_LABEL) - 1 + SDA_SESSION_ID_SIZE + 32 + 4];
+    uint8_t *p = info;
+    int mbedtls_status;
+
+    memcpy(p, SESSION_KDF_LABEL, sizeof(SESSION_KDF_LABEL) - 1);
+    p += sizeof(SESSION_KDF_LABEL) - 1;
+    memcpy(p, session_id, SDA_SESSION_ID_SIZE);
+    p += SDA_SESSION_ID_SIZE;
+    memcpy(p, scopes_hash, 32);
+    p += 32;
+    session_put_u32(p, lifetime_sec);
+
+    mbedtls_status = mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), shared_secret, shared_secret_size,
+                                     info, sizeof(info), key);
+    return (mbedtls_status == 0);
+}
+
+sda_status_e sda_session_open(sda_scope_get_next_cb scope_get_next, void *scope_list,
+                              const uint8_t *client_public_key, size_t client_public_key_size,
+                              uint32_t lifetime_sec, uint8_t *response_data)
+{
+    session_s *session = &g_session;
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point client_point, device_point;
+    mbedtls_mpi device_secret, shared;
+    uint8_t shared_secret[SESSION_SHARED_SECRET_SIZE];
+    uint8_t scopes_hash[32];
+    size_t device_public_key_size = 0;
+    sda_status_e status;
+    int mbedtls_status;
+
+    sda_session_close();
+
+    status = session_scopes_capture(session, scope_get_next, scope_list, scopes_hash);
+    if (status != SDA_STATUS_SUCCESS) {
+        return status;
+    }
+
+    // The scopes are all consumed from the token, check the permission on the copy
+    {
+        session_scope_cursor_s cursor = { session, 0 };
+
+        status = sda_scope_check(session_scope_get_next, &cursor, (const uint8_t *)SDA_SESSION_OPEN_FUNC_NAME,
+                                 sizeof(SDA_SESSION_OPEN_FUNC_NAME) - 1);
+        if (status != SDA_STATUS_SUCCESS) {
+            tr_error("Token does not grant %s", SDA_SESSION_OPEN_FUNC_NAME);
+            return status;
+        }
+    }
+
+    if (client_public_key_size != SDA_SESSION_PUBLIC_KEY_SIZE) {
+        tr_error("Invalid session public key size (%u)", (unsigned)client_public_key_size);
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    if ((lifetime_sec == 0) || (lifetime_sec > SDA_SESSION_MAX_LIFETIME_SEC)) {
+        lifetime_sec = SDA_SESSION_MAX_LIFETIME_SEC;
+    }
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&client_point);
+    mbedtls_ecp_point_init(&device_point);
+    mbedtls_mpi_init(&device_secret);
+    mbedtls_mpi_init(&shared);
+
+    mbedtls_status = mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1);
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_ecp_point_read_binary(&grp, &client_point, client_public_key, client_public_key_size);
+    }
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_ecp_check_pubkey(&grp, &client_point);
+    }
+    if (mbedtls_status != 0) {
+        tr_error("Invalid session public key (-0x%x)", (unsigned)-mbedtls_status);
+        status = SDA_STATUS_INVALID_REQUEST;
+        goto out;
+    }
+
+    mbedtls_status = mbedtls_ecdh_gen_public(&grp, &device_secret, &device_point, session_random, NULL);
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_ecdh_compute_shared(&grp, &shared, &client_point, &device_secret, session_random, NULL);
+    }
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_mpi_write_binary(&shared, shared_secret, sizeof(shared_secret));
+    }
+    if (mbedtls_status == 0) {
+        mbedtls_status = session_random(NULL, session->id, sizeof(session->id));
+    }
+    if (mbedtls_status == 0) {
+        memcpy(response_data, session->id, SDA_SESSION_ID_SIZE);
+        session_put_u32(&response_data[SDA_SESSION_ID_SIZE], lifetime_sec);
+        mbedtls_status = mbedtls_ecp_point_write_binary(&grp, &device_point, MBEDTLS_ECP_PF_UNCOMPRESSED, &device_public_key_size,
+                                                        &response_data[SDA_SESSION_ID_SIZE + 4], SDA_SESSION_PUBLIC_KEY_SIZE);
+    }
+    if (mbedtls_status != 0) {
+        tr_error("Failed establishing session key (-0x%x)", (unsigned)-mbedtls_status);
+        status = SDA_STATUS_OPERATION_EXECUTION_ERROR;
+        goto out;
+    }
+
+    if (!sda_session_key_derive(shared_secret, sizeof(shared_secret), session->id, scopes_hash, lifetime_sec, session->key)) {
+        tr_error("Failed deriving session key");
+        status = SDA_STATUS_OPERATION_EXECUTION_ERROR;
+        goto out;
+    }
+
+    sda_replay_window_init(&session->counters);
+    session->expiry_tick = session_now_tick() + pal_osKernelSysMilliSecTick((uint64_t)lifetime_sec * 1000);
+    session->open = true;
+
+    tr_info("Session opened, %u scopes for %u seconds", (unsigned)session->scopes_count, (unsigned)lifetime_sec);
+
+out:
+    session_zeroize(shared_secret, sizeof(shared_secret));
+    mbedtls_mpi_free(&shared);
+    mbedtls_mpi_free(&device_secret);
+    mbedtls_ecp_point_free(&device_point);
+    mbedtls_ecp_point_free(&client_point);
+    mbedtls_ecp_group_free(&grp);
+    return status;
+}
+
+sda_status_e sda_session_scope_check(const uint8_t *func_name, size_t func_name_size)
+{
+    session_scope_cursor_s cursor = { &g_session, 0 };
+
+    if (!g_session.open) {
+        return SDA_STATUS_NO_MORE_SCOPES;
+    }
+
+    return sda_scope_check(session_scope_get_next, &cursor, func_name, func_name_size);
+}
+
+void sda_session_close(void)
+{
+    session_zeroize(&g_session, sizeof(g_session));
+}
+
+bool sda_session_is_frame(const uint8_t *frame, size_t frame_size)
+{
+    // SDA messages are CBOR encoded and do not start with the magic
+    return (frame_size >= SESSION_HEADER_SIZE) && (memcmp(frame, SESSION_MAGIC, SESSION_MAGIC_SIZE) == 0);
+}
+
+sda_status_e sda_session_request_authenticate(const uint8_t *frame, size_t frame_size, sda_session_request_s *request)
+{
+    session_s *session = &g_session;
+    uint8_t tag[SDA_SESSION_TAG_SIZE];
+    const uint8_t *p;
+    const uint8_t *end;
+    uint32_t counter;
+
+    if (!sda_session_is_frame(frame, frame_size) || (frame_size < (SESSION_HEADER_SIZE + 2 + SDA_SESSION_TAG_SIZE)) ||
+            (frame[SESSION_MAGIC_SIZE] != SDA_SESSION_FRAME_TYPE_REQUEST)) {
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    if (!session->open || (memcmp(&frame[SESSION_MAGIC_SIZE + 1], session->id, SDA_SESSION_ID_SIZE) != 0)) {
+        tr_warn("Unknown session");
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    if (session_now_tick() >= session->expiry_tick) {
+        tr_warn("Session expired");
+        sda_session_close();
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    // Authenticate before looking at the body
+    end = frame + frame_size - SDA_SESSION_TAG_SIZE;
+    if (!session_tag_compute(session->key, frame, (size_t)(end - frame), tag) || !session_tag_equal(tag, end, SDA_SESSION_TAG_SIZE)) {
+        tr_warn("Session request authentication failed");
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    counter = session_get_u32(&frame[SESSION_MAGIC_SIZE + 1 + SDA_SESSION_ID_SIZE]);
+    if (!sda_replay_window_accept(&session->counters, counter)) {
+        tr_warn("Replayed session request (%u)", (unsigned)counter);
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    p = frame + SESSION_HEADER_SIZE;
+    request->counter = counter;
+    request->func_name_size = *p++;
+    request->func_name = p;
+    if (request->func_name_size > (size_t)(end - p - 1)) {
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+    p += request->func_name_size;
+
+    request->params_count = *p++;
+    if ((request->params_count > SDA_SESSION_MAX_PARAMS) || ((request->params_count * 8) != (size_t)(end - p))) {
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+    for (size_t i = 0; i < request->params_count; i++, p += 8) {
+        uint64_t value = ((uint64_t)session_get_u32(p) << 32) | session_get_u32(p + 4);
+
+        request->params[i] = (int64_t)value;
+    }
+
+    return SDA_STATUS_SUCCESS;
+}
+
+bool sda_session_response_write(uint32_t counter, sda_status_e status, const uint8_t *data, size_t data_size,
+                                uint8_t *frame, size_t frame_max_size, size_t *frame_size)
+{
+    session_s *session = &g_session;
+    uint8_t *p = frame;
+
+    if ((!session->open && (status == SDA_STATUS_SUCCESS)) || (data_size > 0xFFFF) ||
+            (frame_max_size < (SESSION_HEADER_SIZE + 3 + data_size + SDA_SESSION_TAG_SIZE))) {
+        return false;
+    }
+
+    memcpy(p, SESSION_MAGIC, SESSION_MAGIC_SIZE);
+    p += SESSION_MAGIC_SIZE;
+    *p++ = SDA_SESSION_FRAME_TYPE_RESPONSE;
+    memcpy(p, session->id, SDA_SESSION_ID_SIZE);   // zeros when closed
+    p += SDA_SESSION_ID_SIZE;
+    session_put_u32(p, counter);
+    p += 4;
+    *p++ = (uint8_t)status;
+    *p++ = (uint8_t)(data_size >> 8);
+    *p++ = (uint8_t)data_size;
+    if (data_size != 0) {
+        memcpy(p, data, data_size);
+        p += data_size;
+    }
+
+    if (!session->open) {
+        memset(p, 0, SDA_SESSION_TAG_SIZE);
+    } else if (!session_tag_compute(session->key, frame, (size_t)(p - frame), p)) {
+        return false;
+    }
+    *frame_size = (size_t)(p - frame) + SDA_SESSION_TAG_SIZE;
+    return true;
+}
+
+bool sda_session_request_write(const uint8_t *key, const uint8_t *session_id, uint32_t counter,
+                               const uint8_t *func_name, size_t func_name_size, const int64_t *params, size_t params_count,
+                               uint8_t *frame, size_t frame_max_size, size_t *frame_size)
+{
+    uint8_t *p = frame;
+
+    if ((func_name_size > 0xFF) || (params_count > SDA_SESSION_MAX_PARAMS) ||
+            (frame_max_size < (SESSION_HEADER_SIZE + 2 + func_name_size + (params_count * 8) + SDA_SESSION_TAG_SIZE))) {
+        return false;
+    }
+
+    memcpy(p, SESSION_MAGIC, SESSION_MAGIC_SIZE);
+    p += SESSION_MAGIC_SIZE;
+    *p++ = SDA_SESSION_FRAME_TYPE_REQUEST;
+    memcpy(p, session_id, SDA_SESSION_ID_SIZE);
+    p += SDA_SESSION_ID_SIZE;
+    session_put_u32(p, counter);
+    p += 4;
+    *p++ = (uint8_t)func_name_size;
+    memcpy(p, func_name, func_name_size);
+    p += func_name_size;
+    *p++ = (uint8_t)params_count;
+    for (size_t i = 0; i < params_count; i++, p += 8) {
+        session_put_u32(p, (uint32_t)((uint64_t)params[i] >> 32));
+        session_put_u32(p + 4, (uint32_t)params[i]);
+    }
+
+    if (!session_tag_compute(key, frame, (size_t)(p - frame), p)) {
+        return false;
+    }
+    *frame_size = (size_t)(p - frame) + SDA_SESSION_TAG_SIZE;
+    return true;
+}
@@ -0,0 +1,223 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_SESSION_H__
+#define __SDA_SESSION_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "sda_status.h"
+#include "sda_scope_check.h"
+
+/**
+* SDA session resumption.
+*
+* A session is opened by a regular SDA request calling "open-session", so the access
+* token and its proof of possession are verified once by the SDA library. The request
+* carries an ephemeral P-256 public key of the client, the device answers with the
+* session ID, the granted lifetime and its own ephemeral public key. Both sides derive
+* the session key:
+*
+*   key = HMAC-SHA256(ECDH shared secret, "sda-session-v1" || session ID ||
+*                     SHA-256(scopes) || lifetime)
+*
+* where SHA-256(scopes) runs over every token scope, in token order, as a 16 bit
+* big endian length followed by the scope. The session carries the scopes of the token
+* and expires after the lifetime, the client may only ask for a shorter lifetime than
+* SDA_SESSION_MAX_LIFETIME_SEC.
+*
+* Follow-up requests are session frames, all integers big endian:
+*
+*   "SDAS" | type (1) | session ID (8) | counter (4) | body | tag (SDA_SESSION_TAG_SIZE)
+*
+*   request body:  name size (1) | name | parameter count (1) | int64 parameters
+*   response body: sda_status_e (1) | data size (2) | data
+*
+* The tag is HMAC-SHA256 over all preceding bytes truncated to SDA_SESSION_TAG_SIZE.
+* Each request counter is accepted once, requests may arrive out of order by up to
+* SDA_REPLAY_WINDOW_SIZE counters. A response echoes the counter of its request.
+*/
+
+/** Function a token must grant to open a session */
+#define SDA_SESSION_OPEN_FUNC_NAME "open-session"
+
+/** Session lifetime upper bound in seconds */
+#ifndef SDA_SESSION_MAX_LIFETIME_SEC
+#ifdef MBED_CONF_APP_SDA_SESSION_LIFETIME
+#define SDA_SESSION_MAX_LIFETIME_SEC MBED_CONF_APP_SDA_SESSION_LIFETIME
+#else
+#define SDA_SESSION_MAX_LIFETIME_SEC 300
+#endif
+#endif
+
+/** Scopes kept for a session */
+#ifndef SDA_SESSION_MAX_SCOPES
+#define SDA_SESSION_MAX_SCOPES 8
+#endif
+
+/** Bytes of all scopes kept for a session */
+#ifndef SDA_SESSION_SCOPES_SIZE
+#define SDA_SESSION_SCOPES_SIZE 256
+#endif
+
+/** Numeric parameters of a session request */
+#ifndef SDA_SESSION_MAX_PARAMS
+#define SDA_SESSION_MAX_PARAMS 4
+#endif
+
+#define SDA_SESSION_ID_SIZE             8
+#define SDA_SESSION_KEY_SIZE            32
+#define SDA_SESSION_TAG_SIZE            16
+#define SDA_SESSION_PUBLIC_KEY_SIZE     65      // Uncompressed P-256 point
+
+/** "open-session" response data: session ID | lifetime in seconds (4) | device public key */
+#define SDA_SESSION_OPEN_RESPONSE_SIZE  (SDA_SESSION_ID_SIZE + 4 + SDA_SESSION_PUBLIC_KEY_SIZE)
+
+#define SDA_SESSION_FRAME_TYPE_REQUEST  0x01
+#define SDA_SESSION_FRAME_TYPE_RESPONSE 0x02
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/////////////////////// STRUCTURES ////////////////////////
+
+/** A decoded session request, name is a view into the frame */
+typedef struct sda_session_request_ {
+    uint32_t counter;
+    const uint8_t *func_name;
+    size_t func_name_size;
+    int64_t params[SDA_SESSION_MAX_PARAMS];
+    size_t params_count;
+} sda_session_request_s;
+
+/**
+* Opens a session, replacing the open one. Call from the application callback of a
+* verified "open-session" request. The token scopes must include SDA_SESSION_OPEN_FUNC_NAME.
+*
+* @param scope_get_next[in] - Iterator over the token scopes, all scopes are fetched
+* @param scope_list[in] - The scope list passed to scope_get_next
+* @param client_public_key[in] - Ephemeral client public key, uncompressed P-256 point
+* @param client_public_key_size[in] - SDA_SESSION_PUBLIC_KEY_SIZE
+* @param lifetime_sec[in] - Requested lifetime, 0 or more than SDA_SESSION_MAX_LIFETIME_SEC for the maximum
+* @param response_data[out] - SDA_SESSION_OPEN_RESPONSE_SIZE bytes to return to the client
+*
+* @return SDA_STATUS_SUCCESS in case of success, SDA_STATUS_NO_MORE_SCOPES if the token does not
+*         grant sessions or one of sda_status_e otherwise.
+*/
+sda_status_e sda_session_open(sda_scope_get_next_cb scope_get_next, void *scope_list,
+                              const uint8_t *client_public_key, size_t client_public_key_size,
+                              uint32_t lifetime_sec, uint8_t *response_data);
+
+/**
+* Checks whether the open session grants a function.
+*
+* @param func_name[in] - Function name in its string representation
+* @param func_name_size[in] - Function name length
+*
+* @return SDA_STATUS_SUCCESS if granted, SDA_STATUS_NO_MORE_SCOPES otherwise.
+*/
+sda_status_e sda_session_scope_check(const uint8_t *func_name, size_t func_name_size);
+
+/**
+* Closes the open session and wipes its key.
+*/
+void sda_session_close(void);
+
+/**
+* Tells session frames apart from SDA messages.
+*
+* @param frame[in] - Received message
+* @param frame_size[in] - Message size
+*
+* @return "true" if the message is a session frame.
+*/
+bool sda_session_is_frame(const uint8_t *frame, size_t frame_size);
+
+/**
+* Authenticates and decodes a session request frame with the open session.
+* Rejects unknown or expired sessions, bad tags and replayed counters.
+*
+* @param frame[in] - Received frame
+* @param frame_size[in] - Frame size
+* @param request[out] - The decoded request
+*
+* @return SDA_STATUS_SUCCESS in case of success or one of sda_status_e otherwise.
+*/
+sda_status_e sda_session_request_authenticate(const uint8_t *frame, size_t frame_size, sda_session_request_s *request);
+
+/**
+* Writes a response frame for a request of the open session. Without an open session,
+* e.g. after expiry, an error status is answered with a zero session ID and tag, the
+* client then falls back to a request with its access token.
+*
+* @param counter[in] - Counter of the request
+* @param status[in] - Request status
+* @param data[in] - Response data, may be NULL
+* @param data_size[in] - Response data size
+* @param frame[out] - Response frame
+* @param frame_max_size[in] - Response frame buffer size
+* @param frame_size[out] - Response frame size
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_session_response_write(uint32_t counter, sda_status_e status, const uint8_t *data, size_t data_size,
+                                uint8_t *frame, size_t frame_max_size, size_t *frame_size);
+
+/**
+* Derives the session key, exposed for client implementations.
+*
+* @param shared_secret[in] - ECDH shared secret (X coordinate)
+* @param shared_secret_size[in] - Shared secret size
+* @param session_id[in] - SDA_SESSION_ID_SIZE bytes
+* @param scopes_hash[in] - SHA-256 of the scopes
+* @param lifetime_sec[in] - Session lifetime
+* @param key[out] - SDA_SESSION_KEY_SIZE bytes
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_session_key_derive(const uint8_t *shared_secret, size_t shared_secret_size, const uint8_t *session_id,
+                            const uint8_t *scopes_hash, uint32_t lifetime_sec, uint8_t *key);
+
+/**
+* Writes a request frame, exposed for client implementations.
+*
+* @param key[in] - Session key
+* @param session_id[in] - Session ID
+* @param counter[in] - Request counter, unique within the session
+* @param func_name[in] - Function name
+* @param func_name_size[in] - Function name length, up to 255
+* @param params[in] - Numeric parameters
+* @param params_count[in] - Up to SDA_SESSION_MAX_PARAMS
+* @param frame[out] - Request frame
+* @param frame_max_size[in] - Request frame buffer size
+* @param frame_size[out] - Request frame size
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_session_request_write(const uint8_t *key, const uint8_t *session_id, uint32_t counter,
+                               const uint8_t *func_name, size_t func_name_size, const int64_t *params, size_t params_count,
+                               uint8_t *frame, size_t frame_max_size, size_t *frame_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_SESSION_H__
@@ -0,0 +1,152 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#if MBED_CONF_APP_TRACE_EVENTS == 1
+
+// Note: this macro is needed on armcc to get the the PRI*32 macros
+// from inttypes.h in a C++ code.
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "sda_trace_event.h"
+
+#if defined(__MBED__)
+#include "mbed.h"
+#else
+#include <time.h>
+#include <pthread.h>
+#endif
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct sda_trace_event_ {
+    const char *name;
+    const char *cat;
+    uint64_t ts_us;
+    uint32_t tid;
+    char phase;
+} sda_trace_event_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static sda_trace_event_s g_trace_events[SDA_TRACE_EVENT_BUFFER_SIZE];
+static uint32_t g_trace_event_next = 0;   // next slot to write
+static uint32_t g_trace_event_count = 0;  // valid events in ring
+
+//////////////////////////////////////////////////////////
+
+static uint64_t trace_event_time_us(void)
+{
+#if defined(__MBED__)
+    return (uint64_t)ticker_read_us(get_us_ticker_data());
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000ULL) + ((uint64_t)ts.tv_nsec / 1000);
+#endif
+}
+
+static uint32_t trace_event_thread_id(void)
+{
+#if defined(__MBED__)
+    return (uint32_t)(uintptr_t)ThisThread::get_id();
+#else
+    return (uint32_t)(uintptr_t)pthread_self();
+#endif
+}
+
+static void trace_event_record(char phase, const char *cat, const char *name)
+{
+    uint64_t ts_us = trace_event_time_us();
+    uint32_t tid = trace_event_thread_id();
+
+#if defined(__MBED__)
+    core_util_critical_section_enter();
+#endif
+
+    sda_trace_event_s *event = &g_trace_events[g_trace_event_next];
+    event->name = name;
+    event->cat = cat;
+    event->ts_us = ts_us;
+    event->tid = tid;
+    event->phase = phase;
+
+    g_trace_event_next = (g_trace_event_next + 1) % SDA_TRACE_EVENT_BUFFER_SIZE;
+    if (g_trace_event_count < SDA_TRACE_EVENT_BUFFER_SIZE) {
+        g_trace_event_count++;
+    }
+
+#if defined(__MBED__)
+    core_util_critical_section_exit();
+#endif
+}
+
+void sda_trace_event_begin(const char *cat, const char *name)
+{
+    trace_event_record('B', cat, name);
+}
+
+void sda_trace_event_end(const char *cat, const char *name)
+{
+    trace_event_record('E', cat, name);
+}
+
+void sda_trace_event_instant(const char *cat, const char *name)
+{
+    trace_event_record('i', cat, name);
+}
+
+void sda_trace_event_dump(FILE *out)
+{
+    uint32_t first = (g_trace_event_next + SDA_TRACE_EVENT_BUFFER_SIZE - g_trace_event_count) % SDA_TRACE_EVENT_BUFFER_SIZE;
+    uint32_t count = g_trace_event_count;
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    for (uint32_t i = 0; i < count; i++) {
+        const sda_trace_event_s *event = &g_trace_events[(first + i) % SDA_TRACE_EVENT_BUFFER_SIZE];
+
+        fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRIu64 ",\"pid\":1,\"tid\":%" PRIu32 "%s}",
+                (i == 0) ? "" : ",",
+                event->name, event->cat, event->phase,
+                event->ts_us,
+                event->tid,
+                // instant events are thread scoped
+                (event->phase == 'i') ? ",\"s\":\"t\"" : "");
+    }
+
+    fprintf(out, "\n]}\n");
+}
+
+int sda_trace_event_write_file(const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        return -1;
+    }
+
+    sda_trace_event_dump(out);
+
+    return (fclose(out) == 0) ? 0 : -1;
+}
+
+#endif // MBED_CONF_APP_TRACE_EVENTS == 1
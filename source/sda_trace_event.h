@@ -0,0 +1,116 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_TRACE_EVENT_H__
+#define __SDA_TRACE_EVENT_H__
+
+#include <stdio.h>
+
+/**
+* Records boot and request timelines as Chrome trace-event JSON
+* (loadable in chrome://tracing or https://ui.perfetto.dev).
+*
+* Events are kept in a fixed size ring, the oldest events are overwritten once
+* the ring is full. Event names and categories must be string literals, only the
+* pointers are stored.
+*
+* Enabled with the "trace-events" application config, otherwise all the macros
+* below compile to nothing.
+*/
+
+/** Number of events kept in the ring */
+#ifndef SDA_TRACE_EVENT_BUFFER_SIZE
+#define SDA_TRACE_EVENT_BUFFER_SIZE 256
+#endif
+
+/** Output file used by host builds */
+#ifndef SDA_TRACE_EVENT_FILE
+#define SDA_TRACE_EVENT_FILE "sda_trace_events.json"
+#endif
+
+/** The dump is printed between these markers when written to stdout */
+#define SDA_TRACE_EVENT_DUMP_BEGIN_MARKER "---- sda-trace-events-begin ----"
+#define SDA_TRACE_EVENT_DUMP_END_MARKER   "---- sda-trace-events-end ----"
+
+/**
+* Set when the serial SDA transport runs on the console, stdout then carries the
+* request and response frames and the dump must not be written there.
+*/
+#if defined(SDA_SERIAL_INTERFACE) && (MBED_CONF_APP_SDA_COAP != 1) && \
+    !((MBED_CONF_APP_SERIAL_RING == 1) && defined(MBED_CONF_APP_SDA_SERIAL_TX) && defined(MBED_CONF_APP_SDA_SERIAL_RX))
+#define SDA_TRACE_EVENT_STDOUT_IS_LINK 1
+#else
+#define SDA_TRACE_EVENT_STDOUT_IS_LINK 0
+#endif
+
+/** Event categories */
+#define SDA_TRACE_EVENT_CAT_BOOT    "boot"
+#define SDA_TRACE_EVENT_CAT_REQUEST "request"
+#define SDA_TRACE_EVENT_CAT_LED     "led"
+#define SDA_TRACE_EVENT_CAT_NET     "net"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* Opens a duration span on the calling thread.
+*/
+void sda_trace_event_begin(const char *cat, const char *name);
+
+/**
+* Closes the innermost span on the calling thread.
+*/
+void sda_trace_event_end(const char *cat, const char *name);
+
+/**
+* Records an instant event, e.g. a network status change.
+*/
+void sda_trace_event_instant(const char *cat, const char *name);
+
+/**
+* Writes the recorded events as a trace-event JSON object.
+*
+* @param out[in] - Destination stream, not stdout when SDA_TRACE_EVENT_STDOUT_IS_LINK
+*/
+void sda_trace_event_dump(FILE *out);
+
+/**
+* Writes the recorded events to a file (host builds).
+*
+* @param path[in] - Output file path
+*
+* @return 0 in case of success, -1 otherwise.
+*/
+int sda_trace_event_write_file(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if MBED_CONF_APP_TRACE_EVENTS == 1
+#define SDA_TRACE_EVENT_BEGIN(cat, name)   sda_trace_event_begin(cat, name)
+#define SDA_TRACE_EVENT_END(cat, name)     sda_trace_event_end(cat, name)
+#define SDA_TRACE_EVENT_INSTANT(cat, name) sda_trace_event_instant(cat, name)
+#else
+#define SDA_TRACE_EVENT_BEGIN(cat, name)
+#define SDA_TRACE_EVENT_END(cat, name)
+#define SDA_TRACE_EVENT_INSTANT(cat, name)
+#endif
+
+#endif //__SDA_TRACE_EVENT_H__
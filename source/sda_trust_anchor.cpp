@@ -0,0 +1,405 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include <string.h>
+
+#include "sda_trust_anchor.h"
+#include "key_config_manager.h"
+#include "mbed-trace/mbed_trace.h"
+#include "mbedtls/sha256.h"
+
+#if MBED_CONF_APP_BENCHMARK == 1
+#include "mbedtls/pk.h"
+#endif
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TRACE_GROUP           "sdae"
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+/////////////////////// STRUCTURES ////////////////////////
+
+typedef struct trust_anchor_set_entry_ {
+    uint8_t key_id[SDA_TRUST_ANCHOR_KEY_ID_SIZE];
+    mbedtls_ecp_point Q;
+} trust_anchor_set_entry_s;
+
+// Entries are kept sorted by key ID and share the curve, and so the comb table, of grp
+typedef struct trust_anchor_set_ {
+    mbedtls_ecp_group grp;
+    trust_anchor_set_entry_s entries[SDA_TRUST_ANCHOR_MAX_COUNT];
+    size_t count;
+} trust_anchor_set_s;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static trust_anchor_set_s g_trust_anchor_set;
+static bool g_trust_anchor_set_initialized = false;
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
+
+//////////////////////////////////////////////////////////
+
+bool sda_trust_anchor_key_id(const uint8_t *der, size_t der_size, uint8_t *key_id)
+{
+    return (mbedtls_sha256_ret(der, der_size, key_id, 0) == 0);
+}
+
+void sda_trust_anchor_name(const uint8_t *key_id, char *name)
+{
+    static const char hex_digits[] = "0123456789ABCDEF";
+    const char prefix[] = "mbed.ta.";
+
+    memcpy(name, prefix, sizeof(prefix) - 1);
+    name += sizeof(prefix) - 1;
+
+    for (size_t i = 0; i < SDA_TRUST_ANCHOR_KEY_ID_SIZE; i++) {
+        *name++ = hex_digits[key_id[i] >> 4];
+        *name++ = hex_digits[key_id[i] & 0x0F];
+    }
+    *name = '\0';
+}
+
+bool sda_trust_anchor_set_store(const uint8_t *const *ders, const uint32_t *der_sizes, size_t count)
+{
+    uint8_t key_id[SDA_TRUST_ANCHOR_KEY_ID_SIZE];
+    char name[SDA_TRUST_ANCHOR_NAME_SIZE];
+    kcm_status_e kcm_status;
+
+    if ((count == 0) || (count > SDA_TRUST_ANCHOR_MAX_COUNT)) {
+        tr_error("Invalid trust anchor count (%u, max %u)", (unsigned)count, (unsigned)SDA_TRUST_ANCHOR_MAX_COUNT);
+        return false;
+    }
+
+    // Every anchor is a new item under a name derived from its key, nothing stored is deleted or rewritten
+    for (size_t i = 0; i < count; i++) {
+        if (!sda_trust_anchor_key_id(ders[i], der_sizes[i], key_id)) {
+            return false;
+        }
+        sda_trust_anchor_name(key_id, name);
+
+        kcm_status = kcm_item_store((const uint8_t *)name, strlen(name), KCM_PUBLIC_KEY_ITEM, true, ders[i], der_sizes[i], NULL);
+        if (kcm_status == KCM_STATUS_FILE_EXIST) {
+            // Same name, same key
+            continue;
+        }
+        if (kcm_status != KCM_STATUS_SUCCESS) {
+            tr_error("Failed storing trust anchor %s (%u)", name, kcm_status);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+// Verification contexts, only the trust anchor benchmarks use them
+
+void sda_trust_anchor_init(sda_trust_anchor_s *trust_anchor)
+{
+    mbedtls_ecdsa_init(&trust_anchor->ecdsa);
+    trust_anchor->loaded = false;
+}
+
+// Multiplies the generator once, mbedtls keeps the comb table it builds on the way in grp.T
+static int trust_anchor_precompute(mbedtls_ecp_group *grp)
+{
+    mbedtls_ecp_point point;
+    mbedtls_mpi one;
+    int mbedtls_status;
+
+    mbedtls_ecp_point_init(&point);
+    mbedtls_mpi_init(&one);
+
+    mbedtls_status = mbedtls_mpi_lset(&one, 1);
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_ecp_mul(grp, &point, &one, &grp->G, NULL, NULL);
+    }
+
+    mbedtls_mpi_free(&one);
+    mbedtls_ecp_point_free(&point);
+    return mbedtls_status;
+}
+
+// Parses a SubjectPublicKeyInfo that must hold an EC key
+static int trust_anchor_parse(mbedtls_pk_context *pk, const uint8_t *der, size_t der_size)
+{
+    int mbedtls_status;
+
+    mbedtls_status = mbedtls_pk_parse_public_key(pk, der, der_size);
+    if (mbedtls_status != 0) {
+        tr_error("Failed parsing trust anchor (-0x%x)", (unsigned)-mbedtls_status);
+        return mbedtls_status;
+    }
+
+    if (!mbedtls_pk_can_do(pk, MBEDTLS_PK_ECDSA)) {
+        tr_error("Trust anchor is not an EC key");
+        return MBEDTLS_ERR_PK_TYPE_MISMATCH;
+    }
+
+    return 0;
+}
+
+// Verifies a raw (r || s) signature with the public point Q of grp
+static bool trust_anchor_verify_point(mbedtls_ecp_group *grp, const mbedtls_ecp_point *Q, const uint8_t *hash, size_t hash_size,
+                                      const uint8_t *signature, size_t signature_size)
+{
+    size_t order_size = mbedtls_mpi_size(&grp->N);
+    mbedtls_mpi r, s;
+    int mbedtls_status;
+
+    if (signature_size != (2 * order_size)) {
+        return false;
+    }
+
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    mbedtls_status = mbedtls_mpi_read_binary(&r, signature, order_size);
+    if (mbedtls_status == 0) {
+        mbedtls_status = mbedtls_mpi_read_binary(&s, signature + order_size, order_size);
+    }
+    if (mbedtls_status == 0) {
+        // Reuses grp.T for the generator, only the trust anchor point is multiplied from scratch
+        mbedtls_status = mbedtls_ecdsa_verify(grp, hash, hash_size, Q, &r, &s);
+    }
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    return (mbedtls_status == 0);
+}
+
+bool sda_trust_anchor_load_der(sda_trust_anchor_s *trust_anchor, const uint8_t *der, size_t der_size)
+{
+    mbedtls_pk_context pk;
+    int mbedtls_status;
+
+    mbedtls_pk_init(&pk);
+
+    mbedtls_status = trust_anchor_parse(&pk, der, der_size);
+    if (mbedtls_status != 0) {
+        goto out;
+    }
+
+    mbedtls_ecdsa_free(&trust_anchor->ecdsa);
+    mbedtls_ecdsa_init(&trust_anchor->ecdsa);
+
+    mbedtls_status = mbedtls_ecdsa_from_keypair(&trust_anchor->ecdsa, mbedtls_pk_ec(pk));
+    if (mbedtls_status != 0) {
+        tr_error("Failed loading trust anchor key (-0x%x)", (unsigned)-mbedtls_status);
+        goto out;
+    }
+
+    mbedtls_status = trust_anchor_precompute(&trust_anchor->ecdsa.grp);
+    if (mbedtls_status != 0) {
+        tr_error("Failed precomputing trust anchor tables (-0x%x)", (unsigned)-mbedtls_status);
+        goto out;
+    }
+
+    trust_anchor->loaded = true;
+
+out:
+    mbedtls_pk_free(&pk);
+    return (mbedtls_status == 0);
+}
+
+bool sda_trust_anchor_load(sda_trust_anchor_s *trust_anchor, const char *name)
+{
+    kcm_status_e kcm_status;
+    uint8_t der[SDA_TRUST_ANCHOR_MAX_DER_SIZE];
+    size_t der_size = 0;
+
+    kcm_status = kcm_item_get_data((const uint8_t *)name, strlen(name), KCM_PUBLIC_KEY_ITEM, der, sizeof(der), &der_size);
+    if (kcm_status != KCM_STATUS_SUCCESS) {
+        tr_error("Failed reading trust anchor (%u)", kcm_status);
+        return false;
+    }
+
+    return sda_trust_anchor_load_der(trust_anchor, der, der_size);
+}
+
+bool sda_trust_anchor_verify(sda_trust_anchor_s *trust_anchor, const uint8_t *hash, size_t hash_size,
+                             const uint8_t *signature, size_t signature_size)
+{
+    if (!trust_anchor->loaded) {
+        return false;
+    }
+
+    return trust_anchor_verify_point(&trust_anchor->ecdsa.grp, &trust_anchor->ecdsa.Q, hash, hash_size, signature, signature_size);
+}
+
+void sda_trust_anchor_free(sda_trust_anchor_s *trust_anchor)
+{
+    mbedtls_ecdsa_free(&trust_anchor->ecdsa);
+    trust_anchor->loaded = false;
+}
+
+static void trust_anchor_set_init(trust_anchor_set_s *set)
+{
+    mbedtls_ecp_group_init(&set->grp);
+    for (size_t i = 0; i < SDA_TRUST_ANCHOR_MAX_COUNT; i++) {
+        mbedtls_ecp_point_init(&set->entries[i].Q);
+    }
+    set->count = 0;
+}
+
+// Binary search, returns the index of key_id or the index it would be inserted at
+static size_t trust_anchor_set_search(const trust_anchor_set_s *set, const uint8_t *key_id, bool *found)
+{
+    size_t low = 0;
+    size_t high = set->count;
+
+    *found = false;
+    while (low < high) {
+        size_t middle = low + ((high - low) / 2);
+        int cmp = memcmp(key_id, set->entries[middle].key_id, SDA_TRUST_ANCHOR_KEY_ID_SIZE);
+
+        if (cmp == 0) {
+            *found = true;
+            return middle;
+        }
+        if (cmp < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    return low;
+}
+
+bool sda_trust_anchor_set_add_der(const uint8_t *der, size_t der_size)
+{
+    trust_anchor_set_s *set = &g_trust_anchor_set;
+    uint8_t key_id[SDA_TRUST_ANCHOR_KEY_ID_SIZE];
+    mbedtls_pk_context pk;
+    mbedtls_ecp_keypair *key;
+    size_t index;
+    bool found;
+    int mbedtls_status;
+
+    if (!g_trust_anchor_set_initialized) {
+        trust_anchor_set_init(set);
+        g_trust_anchor_set_initialized = true;
+    }
+
+    if (!sda_trust_anchor_key_id(der, der_size, key_id)) {
+        return false;
+    }
+
+    index = trust_anchor_set_search(set, key_id, &found);
+    if (found) {
+        return true;
+    }
+
+    if (set->count == SDA_TRUST_ANCHOR_MAX_COUNT) {
+        tr_error("Trust anchor set is full (%u)", (unsigned)SDA_TRUST_ANCHOR_MAX_COUNT);
+        return false;
+    }
+
+    mbedtls_pk_init(&pk);
+
+    mbedtls_status = trust_anchor_parse(&pk, der, der_size);
+    if (mbedtls_status != 0) {
+        goto out;
+    }
+    key = mbedtls_pk_ec(pk);
+
+    if (set->count == 0) {
+        mbedtls_status = mbedtls_ecp_group_copy(&set->grp, &key->grp);
+        if (mbedtls_status == 0) {
+            mbedtls_status = trust_anchor_precompute(&set->grp);
+        }
+        if (mbedtls_status != 0) {
+            tr_error("Failed precomputing trust anchor tables (-0x%x)", (unsigned)-mbedtls_status);
+            goto out;
+        }
+    } else if (key->grp.id != set->grp.id) {
+        tr_error("Trust anchor curve differs from the set");
+        mbedtls_status = MBEDTLS_ERR_PK_TYPE_MISMATCH;
+        goto out;
+    }
+
+    // The last entry is free, its point is moved to the insertion slot
+    {
+        trust_anchor_set_entry_s spare = set->entries[set->count];
+
+        memmove(&set->entries[index + 1], &set->entries[index], (set->count - index) * sizeof(set->entries[0]));
+        set->entries[index] = spare;
+    }
+
+    mbedtls_status = mbedtls_ecp_copy(&set->entries[index].Q, &key->Q);
+    if (mbedtls_status != 0) {
+        // Put the spare entry back at the end
+        trust_anchor_set_entry_s spare = set->entries[index];
+
+        memmove(&set->entries[index], &set->entries[index + 1], (set->count - index) * sizeof(set->entries[0]));
+        set->entries[set->count] = spare;
+        goto out;
+    }
+    memcpy(set->entries[index].key_id, key_id, sizeof(key_id));
+    set->count++;
+
+out:
+    mbedtls_pk_free(&pk);
+    return (mbedtls_status == 0);
+}
+
+size_t sda_trust_anchor_set_count(void)
+{
+    return g_trust_anchor_set_initialized ? g_trust_anchor_set.count : 0;
+}
+
+bool sda_trust_anchor_set_verify(const uint8_t *key_id, size_t key_id_size, const uint8_t *hash, size_t hash_size,
+                                 const uint8_t *signature, size_t signature_size)
+{
+    trust_anchor_set_s *set = &g_trust_anchor_set;
+    size_t index;
+    bool found;
+
+    if (!g_trust_anchor_set_initialized || (key_id_size != SDA_TRUST_ANCHOR_KEY_ID_SIZE)) {
+        return false;
+    }
+
+    index = trust_anchor_set_search(set, key_id, &found);
+    if (!found) {
+        tr_warn("Unknown trust anchor key ID");
+        return false;
+    }
+
+    return trust_anchor_verify_point(&set->grp, &set->entries[index].Q, hash, hash_size, signature, signature_size);
+}
+
+void sda_trust_anchor_set_free(void)
+{
+    trust_anchor_set_s *set = &g_trust_anchor_set;
+
+    if (!g_trust_anchor_set_initialized) {
+        return;
+    }
+
+    for (size_t i = 0; i < SDA_TRUST_ANCHOR_MAX_COUNT; i++) {
+        mbedtls_ecp_point_free(&set->entries[i].Q);
+    }
+    mbedtls_ecp_group_free(&set->grp);
+    g_trust_anchor_set_initialized = false;
+}
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
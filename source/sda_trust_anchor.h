@@ -0,0 +1,208 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __SDA_TRUST_ANCHOR_H__
+#define __SDA_TRUST_ANCHOR_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#if MBED_CONF_APP_BENCHMARK == 1
+#include "mbedtls/ecdsa.h"
+#endif
+
+/**
+* Trust anchor naming and storage.
+*
+* Access tokens are verified inside the SDA library, which reads the trust anchor
+* named by the token from KCM itself. factory_setup() stores every trust anchor of
+* the set under the name the library looks it up by.
+*/
+
+/** Largest trust anchor SubjectPublicKeyInfo accepted */
+#ifndef SDA_TRUST_ANCHOR_MAX_DER_SIZE
+#define SDA_TRUST_ANCHOR_MAX_DER_SIZE 160
+#endif
+
+/** Key ID size, SHA-256 of the SubjectPublicKeyInfo */
+#define SDA_TRUST_ANCHOR_KEY_ID_SIZE 32
+
+/** "mbed.ta." followed by the hex key ID and a terminating NUL */
+#define SDA_TRUST_ANCHOR_NAME_SIZE (8 + (2 * SDA_TRUST_ANCHOR_KEY_ID_SIZE) + 1)
+
+/** Trust anchors accepted at the same time, e.g. the old and the new authority during rotation */
+#ifndef SDA_TRUST_ANCHOR_MAX_COUNT
+#ifdef MBED_CONF_APP_TRUST_ANCHOR_MAX_COUNT
+#define SDA_TRUST_ANCHOR_MAX_COUNT MBED_CONF_APP_TRUST_ANCHOR_MAX_COUNT
+#else
+#define SDA_TRUST_ANCHOR_MAX_COUNT 4
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* Computes the key ID of a trust anchor, the SHA-256 of its DER SubjectPublicKeyInfo.
+* This is the hash create_trust_anchor_dev_cred.py puts in the "mbed.ta.<key ID>" name.
+*
+* @param der[in] - SubjectPublicKeyInfo
+* @param der_size[in] - SubjectPublicKeyInfo size
+* @param key_id[out] - SDA_TRUST_ANCHOR_KEY_ID_SIZE bytes
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_trust_anchor_key_id(const uint8_t *der, size_t der_size, uint8_t *key_id);
+
+/**
+* Formats the KCM item name of a trust anchor, "mbed.ta." followed by the upper case hex key ID.
+*
+* @param key_id[in] - SDA_TRUST_ANCHOR_KEY_ID_SIZE bytes
+* @param name[out] - At least SDA_TRUST_ANCHOR_NAME_SIZE bytes
+*/
+void sda_trust_anchor_name(const uint8_t *key_id, char *name);
+
+/**
+* Stores a trust anchor set: every key as KCM public key item under its "mbed.ta.<key ID>"
+* name, the name the SDA library looks the trust anchor of a token up by. Items are only
+* added, an interrupted store leaves the anchors stored so far and the previous ones valid.
+*
+* @param ders[in] - SubjectPublicKeyInfo of every trust anchor
+* @param der_sizes[in] - SubjectPublicKeyInfo sizes
+* @param count[in] - Number of trust anchors, up to SDA_TRUST_ANCHOR_MAX_COUNT
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_trust_anchor_set_store(const uint8_t *const *ders, const uint32_t *der_sizes, size_t count);
+
+#if MBED_CONF_APP_BENCHMARK == 1
+
+/**
+* Trust anchor verification context.
+*
+* Holds the parsed trust anchor public key together with its curve, including the
+* fixed-base comb table mbedtls caches for the generator point on first use
+* (MBEDTLS_ECP_FIXED_POINT_OPTIM). Verifying with a loaded context skips the
+* storage read, the SubjectPublicKeyInfo parsing and the table precomputation.
+*
+* The table has up to 2^(MBEDTLS_ECP_WINDOW_SIZE - 1) points, set the
+* "ecp-window-size" application option to trade its RAM against verify time.
+*
+* The contexts are not on the token verification path, they back the
+* BM_TrustAnchorVerify and BM_TrustAnchorSet benchmarks and are only built with them.
+*/
+typedef struct sda_trust_anchor_ {
+    mbedtls_ecdsa_context ecdsa;
+    bool loaded;
+} sda_trust_anchor_s;
+
+/**
+* Initializes an empty context.
+*
+* @param trust_anchor[in] - The context
+*/
+void sda_trust_anchor_init(sda_trust_anchor_s *trust_anchor);
+
+/**
+* Loads a trust anchor from its DER SubjectPublicKeyInfo and precomputes the comb table.
+*
+* @param trust_anchor[in] - The context
+* @param der[in] - SubjectPublicKeyInfo of an EC key
+* @param der_size[in] - SubjectPublicKeyInfo size
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_trust_anchor_load_der(sda_trust_anchor_s *trust_anchor, const uint8_t *der, size_t der_size);
+
+/**
+* Loads a trust anchor stored as KCM public key item.
+*
+* @param trust_anchor[in] - The context
+* @param name[in] - KCM item name, e.g. MBED_CLOUD_TRUST_ANCHOR_PK_NAME
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_trust_anchor_load(sda_trust_anchor_s *trust_anchor, const char *name);
+
+/**
+* Verifies a raw (r || s) ECDSA signature over a hash.
+*
+* @param trust_anchor[in] - A loaded context
+* @param hash[in] - The signed hash
+* @param hash_size[in] - Hash size
+* @param signature[in] - r and s, each the size of the curve order
+* @param signature_size[in] - Signature size
+*
+* @return "true" if the signature is valid "false" otherwise.
+*/
+bool sda_trust_anchor_verify(sda_trust_anchor_s *trust_anchor, const uint8_t *hash, size_t hash_size,
+                             const uint8_t *signature, size_t signature_size);
+
+/**
+* Releases a context.
+*
+* @param trust_anchor[in] - The context
+*/
+void sda_trust_anchor_free(sda_trust_anchor_s *trust_anchor);
+
+/**
+* Adds a trust anchor to the in-memory set. All anchors of the set share one curve
+* and one comb table.
+*
+* @param der[in] - SubjectPublicKeyInfo of an EC key on the curve of the set
+* @param der_size[in] - SubjectPublicKeyInfo size
+*
+* @return "true" in case of success "false" otherwise.
+*/
+bool sda_trust_anchor_set_add_der(const uint8_t *der, size_t der_size);
+
+/**
+* Number of trust anchors in the in-memory set.
+*/
+size_t sda_trust_anchor_set_count(void);
+
+/**
+* Verifies a raw (r || s) ECDSA signature with the trust anchor of the in-memory set
+* the key ID points to. The anchor is found by binary search, no other key is tried.
+*
+* @param key_id[in] - Key ID of the signing trust anchor
+* @param key_id_size[in] - Key ID size
+* @param hash[in] - The signed hash
+* @param hash_size[in] - Hash size
+* @param signature[in] - r and s, each the size of the curve order
+* @param signature_size[in] - Signature size
+*
+* @return "true" if the key ID is known and the signature is valid "false" otherwise.
+*/
+bool sda_trust_anchor_set_verify(const uint8_t *key_id, size_t key_id_size, const uint8_t *hash, size_t hash_size,
+                                 const uint8_t *signature, size_t signature_size);
+
+/**
+* Releases the in-memory set.
+*/
+void sda_trust_anchor_set_free(void);
+
+#endif // MBED_CONF_APP_BENCHMARK == 1
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__SDA_TRUST_ANCHOR_H__
@@ -40,6 +40,15 @@
 #include "mbed-trace-helper.h"
 #include "mbed_stats_helper.h"
 #include "sda_demo.h"
+#include "sda_scope_check.h"
+#include "sda_dispatch.h"
+#include "sda_bench.h"
+#include "sda_trace_event.h"
+#include "sda_mem_stats.h"
+#include "sda_trust_anchor.h"
+#include "sda_session.h"
+#include "sda_replay.h"
+#include "sda_revocation.h"
 
 /////////////////////// DEFINITIONS ///////////////////////
 
@@ -49,14 +58,43 @@
 
 static int g_demo_main_status = EXIT_FAILURE;   // holds the demo main task return code
 
-extern const uint8_t MBED_CLOUD_TRUST_ANCHOR_PK[];
-extern const uint32_t MBED_CLOUD_TRUST_ANCHOR_PK_SIZE;
-extern const char MBED_CLOUD_TRUST_ANCHOR_PK_NAME[];
+extern const uint8_t *const MBED_CLOUD_TRUST_ANCHOR_PKS[];
+extern const uint32_t MBED_CLOUD_TRUST_ANCHOR_PK_SIZES[];
+extern const uint32_t MBED_CLOUD_TRUST_ANCHOR_COUNT;
 
 char *g_endpoint_name = NULL;
 
 static uint8_t g_app_user_response_buff[] = "This is app data buffer";
 
+#if MBED_CONF_APP_SDA_SESSION == 1
+static uint8_t g_session_open_response[SDA_SESSION_OPEN_RESPONSE_SIZE];
+#endif
+
+#if MBED_CONF_APP_REPLAY_PROTECTION == 1
+static sda_replay_filter_s g_replay_filter;     // recently executed requests
+static uint64_t g_request_digest;               // digest of the request being processed
+#endif
+
+#if MBED_CONF_APP_TOKEN_REVOCATION == 1
+static const uint8_t *g_request;                // request being processed, checked once verified
+static size_t g_request_size;
+#endif
+
+/** Adapts sda_scope_get_next() to the sda_scope_check() iterator signature */
+static sda_status_e operation_scope_get_next(void *scope_list, const uint8_t **scope_out, size_t *scope_size_out)
+{
+    return sda_scope_get_next((sda_operation_ctx_h)scope_list, scope_out, scope_size_out);
+}
+
+/** Fetches a numeric parameter of the requested function, same contract as sda_func_call_numeric_parameter_get() */
+typedef sda_status_e (*numeric_param_get_cb)(void *param_list, uint32_t index, int64_t *param_out);
+
+/** Adapts sda_func_call_numeric_parameter_get() to numeric_param_get_cb */
+static sda_status_e operation_numeric_param_get(void *param_list, uint32_t index, int64_t *param_out)
+{
+    return sda_func_call_numeric_parameter_get((sda_operation_ctx_h)param_list, index, param_out);
+}
+
 /** Checks if access allowed for the target operation
 *
 * @param operation_context[in] - The operation context
@@ -68,52 +106,11 @@ static uint8_t g_app_user_response_buff[] = "This is app data buffer";
 static sda_status_e is_operation_permitted(sda_operation_ctx_h operation_context, const uint8_t *func_name, size_t func_name_size)
 {
     sda_status_e status;
-    const uint8_t *scope;
-    size_t scope_size;
-
-    do {
-
-        scope = NULL;
-        scope_size = 0;
-
-        // Get next available scope in list
-        status = sda_scope_get_next(operation_context, &scope, &scope_size);
-
-        // Check if end of scope list reached
-        if (status == SDA_STATUS_NO_MORE_SCOPES) {
-            tr_error("No match found for operation, permission denied");
-            goto access_denied;
-        }
-
-        if (status != SDA_STATUS_SUCCESS) {
-            tr_error("Failed getting scope, permission denied");
-            goto access_denied;
-        }
-
-        if ((scope == NULL) || (scope_size == 0)) {
-            tr_warn("Got empty or invalid scope, skipping this scope");
-            continue;
-        }
-
-        // Check operation is in scope
-
-        // Check that function name has the exact scope size
-        if (scope_size != func_name_size) {
-            continue;
-        }
-
-        // Check that function name and scope are binary equal
-        if (memcmp(func_name, scope, func_name_size) != 0) {
-            continue;
-        }
-
-        tr_info("Operation in scope, access granted");
 
+    status = sda_scope_check(operation_scope_get_next, (void *)operation_context, func_name, func_name_size);
+    if (status == SDA_STATUS_SUCCESS) {
         return SDA_STATUS_SUCCESS; // operation permitted
-
-    } while (true);
-
-access_denied:
+    }
 
     // Access denied
 
@@ -125,51 +122,22 @@ access_denied:
 }
 
 
-sda_status_e application_callback(sda_operation_ctx_h handle, void *callback_param)
+/** Executes a demo operation
+*
+* @param operation[in] - The operation
+* @param func_callback_name[in] - Function name in its string representation
+* @param func_callback_name_size[in] - Function name length
+* @param numeric_param_get[in] - Getter of the operation numeric parameters
+* @param param_list[in] - The parameter list passed to numeric_param_get
+*
+* @return SDA_STATUS_SUCCESS in case of success or one of sda_status_e otherwise.
+*/
+static sda_status_e demo_operation_execute(sda_demo_operation_e operation, const uint8_t *func_callback_name, size_t func_callback_name_size,
+                                           numeric_param_get_cb numeric_param_get, void *param_list)
 {
     sda_status_e sda_status = SDA_STATUS_SUCCESS;
-    sda_status_e sda_status_for_response = SDA_STATUS_SUCCESS;
-    sda_command_type_e command_type = SDA_OPERATION_NONE;
-    const uint8_t *func_callback_name;
-    size_t func_callback_name_size;
     bool success = false; // assume error
 
-    SDA_UNUSED_PARAM(callback_param);
-
-    sda_status = sda_command_type_get(handle, &command_type);
-    if (sda_status != SDA_STATUS_SUCCESS) {
-        tr_error("Secure-Device-Access failed getting command type (%u)", sda_status);
-        sda_status_for_response = sda_status;
-        goto out;
-    }
-
-    // Currently only SDA_OPERATION_FUNC_CALL is supported
-    if (command_type != SDA_OPERATION_FUNC_CALL) {
-        tr_error("Got invalid command-type (%u)", command_type);
-        sda_status_for_response = SDA_STATUS_INVALID_REQUEST;
-        goto out;
-    }
-
-    func_callback_name = NULL;
-    func_callback_name_size = 0;
-
-    sda_status = sda_func_call_name_get(handle, &func_callback_name, &func_callback_name_size);
-    if (sda_status != SDA_STATUS_SUCCESS) {
-        tr_error("Secure-Device-Access failed getting function callback name (%u)", sda_status);
-        sda_status_for_response = sda_status;
-        goto out;
-    }
-
-    tr_info("Function callback is %.*s", (int)func_callback_name_size, func_callback_name);
-
-    // Check permission
-    sda_status = is_operation_permitted(handle, func_callback_name, func_callback_name_size);
-    if (sda_status != SDA_STATUS_SUCCESS) {
-        tr_error("%.*s operation not permitted (%u)", (int)func_callback_name_size, func_callback_name, sda_status);
-        sda_status_for_response = sda_status;
-        goto out;
-    }
-
     /***
     * The following commands represents two demos as listed below:
     *   - MWC (Mobile World Congress):
@@ -185,7 +153,9 @@ sda_status_e application_callback(sda_operation_ctx_h handle, void *callback_par
     *   - Note that "update" is a common command for both.
     */
 
-    if (memcmp(func_callback_name, "configure", func_callback_name_size) == 0) {
+    switch (operation) {
+
+    case SDA_DEMO_OPERATION_CONFIGURE: {
 
         /***
         * This function accesses the LCD peripheral and sets the current outside temperature.
@@ -196,23 +166,22 @@ sda_status_e application_callback(sda_operation_ctx_h handle, void *callback_par
         int64_t temperature = 0;
 
         // Get the temperature to display
-        sda_status = sda_func_call_numeric_parameter_get(handle, 0, &temperature);
+        sda_status = numeric_param_get(param_list, 0, &temperature);
         if (sda_status != SDA_STATUS_SUCCESS) {
             tr_error("Failed getting demo_callback_configure() numeric param[0] (%u)", sda_status);
-            sda_status_for_response = sda_status;
-            goto out;
+            return sda_status;
         }
 
         // Dispatch function callback
         success = demo_callback_configure(temperature);
         if (!success) {
             tr_error("demo_callback_configure() failed");
-            sda_status_for_response = SDA_STATUS_OPERATION_EXECUTION_ERROR;
-            goto out;
+            return SDA_STATUS_OPERATION_EXECUTION_ERROR;
         }
 
+        break;
     }
-    else if (memcmp(func_callback_name, "read-data", func_callback_name_size) == 0) {
+    case SDA_DEMO_OPERATION_READ_DATA:
 
         /***
         * This function accesses the TEMPERATURE peripheral and query current outside temperature,
@@ -224,12 +193,12 @@ sda_status_e application_callback(sda_operation_ctx_h handle, void *callback_par
         success = demo_callback_read_data();
         if (!success) {
             tr_error("demo_callback_read_data() failed");
-            sda_status_for_response = SDA_STATUS_OPERATION_EXECUTION_ERROR;
-            goto out;
+            return SDA_STATUS_OPERATION_EXECUTION_ERROR;
         }
 
-    }
-    else if (memcmp(func_callback_name, "update", func_callback_name_size) == 0) {
+        break;
+
+    case SDA_DEMO_OPERATION_UPDATE:
 
         /***
         * Shows progress indicator on the LCD with percentages, and after a few seconds displays
@@ -240,8 +209,9 @@ sda_status_e application_callback(sda_operation_ctx_h handle, void *callback_par
         // Dispatch function callback
         demo_callback_update();
 
-    }
-    else if (memcmp(func_callback_name, "diagnostics", func_callback_name_size) == 0) {
+        break;
+
+    case SDA_DEMO_OPERATION_DIAGNOSTICS:
 
         /***
         * This function accesses the TEMPERATURE peripheral and query current outside temperature,
@@ -253,12 +223,12 @@ sda_status_e application_callback(sda_operation_ctx_h handle, void *callback_par
         success = demo_callback_diagnostics();
         if (!success) {
             tr_error("demo_callback_diagnostics() failed");
-            sda_status_for_response = SDA_STATUS_OPERATION_EXECUTION_ERROR;
-            goto out;
+            return SDA_STATUS_OPERATION_EXECUTION_ERROR;
         }
 
-    }
-    else if (memcmp(func_callback_name, "restart", func_callback_name_size) == 0) {
+        break;
+
+    case SDA_DEMO_OPERATION_RESTART:
 
         /***
         * This function accesses the LCD peripheral and sets the current outside temperature.
@@ -269,12 +239,211 @@ sda_status_e application_callback(sda_operation_ctx_h handle, void *callback_par
         // Dispatch function callback
         demo_callback_restart();
 
-    }
-    else {
+        break;
+
+    default:
         tr_error("Unsupported callback function name (%.*s)", (int)func_callback_name_size, func_callback_name);
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    return SDA_STATUS_SUCCESS;
+}
+
+#if MBED_CONF_APP_SDA_SESSION == 1
+/** Adapts a session request to numeric_param_get_cb */
+static sda_status_e session_numeric_param_get(void *param_list, uint32_t index, int64_t *param_out)
+{
+    const sda_session_request_s *session_request = (const sda_session_request_s *)param_list;
+
+    if (index >= session_request->params_count) {
+        return SDA_STATUS_INVALID_REQUEST;
+    }
+
+    *param_out = session_request->params[index];
+    return SDA_STATUS_SUCCESS;
+}
+
+/** Opens a session for the verified "open-session" request
+*
+* Data parameter 0 is the client ephemeral public key, the optional numeric parameter 1
+* a lifetime in seconds shorter than the configured one.
+*
+* @param handle[in] - The operation context
+*
+* @return SDA_STATUS_SUCCESS in case of success or one of sda_status_e otherwise.
+*/
+static sda_status_e demo_session_open(sda_operation_ctx_h handle)
+{
+    const uint8_t *client_public_key = NULL;
+    size_t client_public_key_size = 0;
+    int64_t lifetime = 0;
+    sda_status_e sda_status;
+
+    sda_status = sda_func_call_data_parameter_get(handle, 0, &client_public_key, &client_public_key_size);
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        tr_error("Failed getting open-session data param[0] (%u)", sda_status);
+        return sda_status;
+    }
+
+    if ((sda_func_call_numeric_parameter_get(handle, 1, &lifetime) != SDA_STATUS_SUCCESS) || (lifetime < 0) || (lifetime > UINT32_MAX)) {
+        lifetime = 0; // the configured lifetime
+    }
+
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_REQUEST, "session_open");
+    sda_status = sda_session_open(operation_scope_get_next, (void *)handle, client_public_key, client_public_key_size,
+                                  (uint32_t)lifetime, g_session_open_response);
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_REQUEST, "session_open");
+    if (sda_status == SDA_STATUS_NO_MORE_SCOPES) {
+        display_faulty_message("Access Denied");
+        return sda_status;
+    }
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        tr_error("sda_session_open failed (%u)", sda_status);
+        return sda_status;
+    }
+
+    sda_status = sda_response_data_set(handle, g_session_open_response, sizeof(g_session_open_response));
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        tr_error("sda_response_data_set failed (%u)", sda_status);
+        sda_session_close();
+    }
+
+    return sda_status;
+}
+#endif
+
+#if MBED_CONF_APP_TOKEN_REVOCATION == 1
+/** Replaces the token revocation list with data parameter 0
+*
+* @param handle[in] - The operation context
+*
+* @return SDA_STATUS_SUCCESS in case of success or one of sda_status_e otherwise.
+*/
+static sda_status_e demo_revocation_update(sda_operation_ctx_h handle)
+{
+    const uint8_t *list = NULL;
+    size_t list_size = 0;
+    sda_status_e sda_status;
+
+    sda_status = sda_func_call_data_parameter_get(handle, 0, &list, &list_size);
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        tr_error("Failed getting %s data param[0] (%u)", SDA_REVOCATION_UPDATE_FUNC_NAME, sda_status);
+        return sda_status;
+    }
+
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_REQUEST, "revocation_update");
+    sda_status = sda_revocation_update(list, list_size);
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_REQUEST, "revocation_update");
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        return sda_status;
+    }
+
+#if MBED_CONF_APP_SDA_SESSION == 1
+    // The open session may belong to a token revoked now
+    sda_session_close();
+#endif
+
+    return SDA_STATUS_SUCCESS;
+}
+#endif
+
+sda_status_e application_callback(sda_operation_ctx_h handle, void *callback_param)
+{
+    sda_status_e sda_status = SDA_STATUS_SUCCESS;
+    sda_status_e sda_status_for_response = SDA_STATUS_SUCCESS;
+    sda_command_type_e command_type = SDA_OPERATION_NONE;
+    const uint8_t *func_callback_name = NULL;
+    size_t func_callback_name_size = 0;
+    sda_demo_operation_e operation = SDA_DEMO_OPERATION_UNKNOWN;
+#if SDA_MEM_STATS_ENABLED
+    sda_mem_snapshot_s mem_snapshot;
+#endif
+
+    SDA_UNUSED_PARAM(callback_param);
+
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_REQUEST, "application_callback");
+
+#if SDA_MEM_STATS_ENABLED
+    sda_mem_stats_snapshot(&mem_snapshot);
+#endif
+
+#if MBED_CONF_APP_TOKEN_REVOCATION == 1
+    // Also rejects a request whose token cannot be found rather than skip the check
+    if (sda_revocation_request_is_revoked(g_request, g_request_size)) {
+        tr_warn("Access token revoked");
         sda_status_for_response = SDA_STATUS_INVALID_REQUEST;
         goto out;
     }
+#endif
+
+#if MBED_CONF_APP_REPLAY_PROTECTION == 1
+    // The SDA library verified the request, refuse it if it was executed before
+    if (sda_replay_filter_contains(&g_replay_filter, g_request_digest)) {
+        tr_warn("Replayed request");
+        sda_status_for_response = SDA_STATUS_INVALID_REQUEST;
+        goto out;
+    }
+    sda_replay_filter_insert(&g_replay_filter, g_request_digest);
+#endif
+
+    sda_status = sda_command_type_get(handle, &command_type);
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        tr_error("Secure-Device-Access failed getting command type (%u)", sda_status);
+        sda_status_for_response = sda_status;
+        goto out;
+    }
+
+    // Currently only SDA_OPERATION_FUNC_CALL is supported
+    if (command_type != SDA_OPERATION_FUNC_CALL) {
+        tr_error("Got invalid command-type (%u)", command_type);
+        sda_status_for_response = SDA_STATUS_INVALID_REQUEST;
+        goto out;
+    }
+
+    func_callback_name = NULL;
+    func_callback_name_size = 0;
+
+    sda_status = sda_func_call_name_get(handle, &func_callback_name, &func_callback_name_size);
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        tr_error("Secure-Device-Access failed getting function callback name (%u)", sda_status);
+        sda_status_for_response = sda_status;
+        goto out;
+    }
+
+    tr_info("Function callback is %.*s", (int)func_callback_name_size, func_callback_name);
+
+    operation = sda_demo_operation_lookup(func_callback_name, func_callback_name_size);
+
+#if MBED_CONF_APP_SDA_SESSION == 1
+    if (operation == SDA_DEMO_OPERATION_OPEN_SESSION) {
+        // Consumes all scopes of the token and checks the permission on its copy
+        sda_status_for_response = demo_session_open(handle);
+        goto out;
+    }
+#endif
+
+    // Check permission
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_REQUEST, "scope_check");
+    sda_status = is_operation_permitted(handle, func_callback_name, func_callback_name_size);
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_REQUEST, "scope_check");
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        tr_error("%.*s operation not permitted (%u)", (int)func_callback_name_size, func_callback_name, sda_status);
+        sda_status_for_response = sda_status;
+        goto out;
+    }
+
+#if MBED_CONF_APP_TOKEN_REVOCATION == 1
+    if (operation == SDA_DEMO_OPERATION_UPDATE_REVOCATION) {
+        sda_status_for_response = demo_revocation_update(handle);
+        goto out;
+    }
+#endif
+
+    sda_status = demo_operation_execute(operation, func_callback_name, func_callback_name_size, operation_numeric_param_get, (void *)handle);
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        sda_status_for_response = sda_status;
+        goto out;
+    }
 
     sda_status = sda_response_data_set(handle, g_app_user_response_buff, sizeof(g_app_user_response_buff));
     if (sda_status != SDA_STATUS_SUCCESS) {
@@ -292,9 +461,80 @@ out:
         display_faulty_message("Bad Request");
     }
 
+#if SDA_MEM_STATS_ENABLED
+    // Charge the dispatch to the requested operation, names outside the dispatch table share "unknown"
+    if (operation != SDA_DEMO_OPERATION_UNKNOWN) {
+        sda_mem_stats_record(func_callback_name, func_callback_name_size, &mem_snapshot);
+    } else {
+        sda_mem_stats_record(NULL, 0, &mem_snapshot);
+    }
+#endif
+
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_REQUEST, "application_callback");
+
     return sda_status_for_response;
 
 }
+
+#if MBED_CONF_APP_SDA_SESSION == 1
+/** Processes a session request, authenticated with the session key instead of an access token.
+*
+* Same parameters as process_request_fetch_response().
+*
+* @return "true" if a response was written "false" otherwise.
+*/
+static bool process_session_request_fetch_response(
+    const uint8_t *request,
+    uint32_t request_size,
+    uint8_t *response,
+    size_t response_max_size,
+    size_t *response_actual_size)
+{
+    sda_session_request_s session_request;
+    sda_status_e sda_status;
+    bool success;
+
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_REQUEST, "session_request");
+
+    session_request.counter = 0;
+    *response_actual_size = 0;
+
+    sda_status = sda_session_request_authenticate(request, request_size, &session_request);
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        // The client falls back to a request with its access token
+        tr_error("Session request rejected (%u)", sda_status);
+        goto out;
+    }
+
+    tr_info("Session function callback is %.*s", (int)session_request.func_name_size, session_request.func_name);
+
+    sda_status = sda_session_scope_check(session_request.func_name, session_request.func_name_size);
+    if (sda_status != SDA_STATUS_SUCCESS) {
+        tr_error("Operation not in session scope, access denied");
+        display_faulty_message("Access Denied");
+        goto out;
+    }
+
+    sda_status = demo_operation_execute(sda_demo_operation_lookup(session_request.func_name, session_request.func_name_size),
+                                        session_request.func_name, session_request.func_name_size,
+                                        session_numeric_param_get, &session_request);
+
+out:
+    if ((sda_status != SDA_STATUS_SUCCESS) && (sda_status != SDA_STATUS_NO_MORE_SCOPES)) {
+        display_faulty_message("Bad Request");
+    }
+
+    success = sda_session_response_write(session_request.counter, sda_status,
+                                         (sda_status == SDA_STATUS_SUCCESS) ? g_app_user_response_buff : NULL,
+                                         (sda_status == SDA_STATUS_SUCCESS) ? sizeof(g_app_user_response_buff) : 0,
+                                         response, response_max_size, response_actual_size);
+
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_REQUEST, "session_request");
+
+    return success;
+}
+#endif
+
 /** Processes a request fetched from the communication line medium and
 * returns the corresponding response message to be fed into the communication
 * line medium back.
@@ -317,9 +557,35 @@ static bool process_request_fetch_response(
 {
 
     sda_status_e sda_status = SDA_STATUS_SUCCESS;
+#if SDA_MEM_STATS_ENABLED
+    sda_mem_snapshot_s mem_snapshot;
+
+    sda_mem_stats_snapshot(&mem_snapshot);
+#endif
+
+#if MBED_CONF_APP_SDA_SESSION == 1
+    if (sda_session_is_frame(request, request_size)) {
+        return process_session_request_fetch_response(request, request_size, response, response_max_size, response_actual_size);
+    }
+#endif
+
+#if MBED_CONF_APP_REPLAY_PROTECTION == 1
+    g_request_digest = sda_replay_filter_digest(&g_replay_filter, request, request_size);
+#endif
+
+#if MBED_CONF_APP_TOKEN_REVOCATION == 1
+    // Only looked up once the token is verified, see application_callback()
+    g_request = request;
+    g_request_size = request_size;
+#endif
 
     //Call to sda_operation_process to process current message, the response message will be returned as output.
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_REQUEST, "sda_operation_process");
     sda_status = sda_operation_process(request, request_size, *application_callback, NULL, response, response_max_size, response_actual_size);
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_REQUEST, "sda_operation_process");
+#if SDA_MEM_STATS_ENABLED
+    sda_mem_stats_record((const uint8_t *)"sda_operation_process", strlen("sda_operation_process"), &mem_snapshot);
+#endif
     if (sda_status != SDA_STATUS_SUCCESS) {
         tr_error("Secure-Device-Access operation process failed (%u)", sda_status);
     }
@@ -376,9 +642,6 @@ static bool get_endpoint_name()
 
 static bool factory_setup(void)
 {
-#if MBED_CONF_APP_DEVELOPER_MODE == 1
-    kcm_status_e kcm_status = KCM_STATUS_SUCCESS;
-#endif
     fcc_status_e fcc_status = FCC_STATUS_SUCCESS;
     bool status = true;
 
@@ -386,7 +649,9 @@ static bool factory_setup(void)
 
     // Initializes FCC to be able to call FCC APIs
     // TBD: SDA should be able to run without FCC init
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "fcc_init");
     fcc_status = fcc_init();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "fcc_init");
     if (fcc_status != FCC_STATUS_SUCCESS) {
         status = false;
         tr_error("Failed to initialize Factory-Configurator-Client (%u)", fcc_status);
@@ -395,7 +660,9 @@ static bool factory_setup(void)
 
 #if MBED_CONF_APP_DEVELOPER_MODE == 1
     // Storage delete
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "fcc_storage_delete");
     fcc_status = fcc_storage_delete();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "fcc_storage_delete");
     if (fcc_status != FCC_STATUS_SUCCESS) {
         tr_error("Storage format failed (%u)", fcc_status);
         status = false;
@@ -403,39 +670,48 @@ static bool factory_setup(void)
     }
     // Call developer flow
     tr_cmdline("Start developer flow");
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "fcc_developer_flow");
     fcc_status = fcc_developer_flow();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "fcc_developer_flow");
     if (fcc_status != FCC_STATUS_SUCCESS) {
         tr_error("fcc_developer_flow failed (%u)", fcc_status);
         status = false;
         goto out;
     }
 
-    // Store trust anchor
+    // Store trust anchors
     // Note: Until TA will be part of the developer flow.
-    tr_info("Store trust anchor");
-    kcm_status = kcm_item_store((const uint8_t*)MBED_CLOUD_TRUST_ANCHOR_PK_NAME, strlen(MBED_CLOUD_TRUST_ANCHOR_PK_NAME), KCM_PUBLIC_KEY_ITEM, true, MBED_CLOUD_TRUST_ANCHOR_PK, MBED_CLOUD_TRUST_ANCHOR_PK_SIZE, NULL);
-    if (kcm_status != KCM_STATUS_SUCCESS) {
-        tr_error("kcm_item_store failed (%u)", kcm_status);
-        status = false;
+    tr_info("Store %" PRIu32 " trust anchor(s)", MBED_CLOUD_TRUST_ANCHOR_COUNT);
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "store_trust_anchor");
+    status = sda_trust_anchor_set_store(MBED_CLOUD_TRUST_ANCHOR_PKS, MBED_CLOUD_TRUST_ANCHOR_PK_SIZES, MBED_CLOUD_TRUST_ANCHOR_COUNT);
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "store_trust_anchor");
+    if (status != true) {
+        tr_error("sda_trust_anchor_set_store failed");
         goto out;
     }
 #endif
 
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "fcc_verify_device_configured");
     fcc_status = fcc_verify_device_configured_4mbed_cloud();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "fcc_verify_device_configured");
     if (fcc_status != FCC_STATUS_SUCCESS) {
         status = false;
         goto out;
     }
 
     //Get endpoint name
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "get_endpoint_name");
     status = get_endpoint_name();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "get_endpoint_name");
     if (status != true) {
         tr_error("get_endpoint_name failed");
     }
 
 out:
     // Finalize FFC
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "fcc_finalize");
     fcc_status = fcc_finalize();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "fcc_finalize");
     if (status == false) {
         return false;
     } else {
@@ -448,6 +724,33 @@ out:
     return status;
 }
 
+/**
+* Gets a network transport going again after wait_for_message() or send_response() failed.
+* SDA, its session and caches are left alone, the host retries the lost request.
+* Only a lost network is recovered, other failures end the demo as before.
+* @return true if the demo loop can go on with the same comm object
+*/
+static bool comm_recover(FtcdCommBase *comm, ftcd_comm_status_e ftcd_status)
+{
+#if MBED_CONF_APP_SDA_COAP == 1
+    bool success;
+
+    if (ftcd_status != FTCD_COMM_NETWORK_CONNECTION_ERROR) {
+        return false;
+    }
+
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_NET, "comm_recover");
+    success = sda_recover_comm_interface(comm);
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_NET, "comm_recover");
+    return success;
+#else
+    // A serial link does not drop, a failure there is a protocol error
+    (void)comm;
+    (void)ftcd_status;
+    return false;
+#endif
+}
+
 /**
 * Main demo task
 */
@@ -459,16 +762,26 @@ static void demo_main()
     FtcdCommBase *comm = NULL;
     uint8_t *request = NULL;
     uint32_t request_size = 0;
+#if MBED_CONF_APP_SDA_SESSION == 1
+    // Also fits the "open-session" response data and session response frames
+    uint8_t response[SDA_RESPONSE_HEADER_SIZE + sizeof(g_app_user_response_buff) + SDA_SESSION_OPEN_RESPONSE_SIZE];
+#else
     uint8_t response[SDA_RESPONSE_HEADER_SIZE + sizeof(g_app_user_response_buff)];
+#endif
     size_t response_max_size = sizeof(response);
     size_t response_actual_size;
+#if MBED_CONF_APP_REPLAY_PROTECTION == 1
+    uint32_t replay_seed = 0;
+#endif
 
     mcc_platform_sw_build_info();
 
     tr_cmdline("Secure-Device-Access initialization");
 
     // Initialize storage
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "storage_init");
     success = mcc_platform_storage_init() == 0;
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "storage_init");
     if (success != true) {
         tr_error("Failed initializing mcc platform storage\n");
         return;
@@ -477,14 +790,10 @@ static void demo_main()
     // Avoid standard output buffering
     setvbuf(stdout, (char *)NULL, _IONBF, 0);
 
-    success = factory_setup();
-    if (success != true) {
-        tr_error("Demo setup failed");
-        goto out;
-    }
-
     // Create communication interface object
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "comm_create");
     comm = sda_create_comm_interface();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "comm_create");
     if (comm == NULL) {
         tr_error("Failed creating communication object");
         display_faulty_message("Init. failed");
@@ -492,14 +801,36 @@ static void demo_main()
     }
 
     //init sda_comm object
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "comm_init");
     success = comm->init();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "comm_init");
     if (success != true) {
         tr_error("Failed instantiating communication object");
         display_faulty_message("Init. failed");
         goto out;
     }
 
+    // The storage may still be coming up in the background, the steps above do not use it
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "storage_wait");
+    success = mcc_platform_storage_wait() == 0;
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "storage_wait");
+    if (success != true) {
+        tr_error("Failed waiting for mcc platform storage");
+        display_faulty_message("Init. failed");
+        goto out;
+    }
+
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "factory_setup");
+    success = factory_setup();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "factory_setup");
+    if (success != true) {
+        tr_error("Demo setup failed");
+        goto out;
+    }
+
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "sda_init");
     sda_status = sda_init();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "sda_init");
     if (sda_status != SDA_STATUS_SUCCESS) {
         tr_error("Failed initializing Secure-Device-Access");
         display_faulty_message("Init. failed");
@@ -516,16 +847,48 @@ static void demo_main()
         pal_osSetTime(0);
     }
 
+#if MBED_CONF_APP_REPLAY_PROTECTION == 1
+    // A per boot seed, so digests of recorded requests cannot be predicted
+    if (pal_osRandomBuffer((uint8_t *)&replay_seed, sizeof(replay_seed)) != PAL_SUCCESS) {
+        tr_error("Failed seeding replay filter");
+        display_faulty_message("Init. failed");
+        goto out;
+    }
+    sda_replay_filter_init(&g_replay_filter, replay_seed);
+#endif
+
+#if MBED_CONF_APP_TOKEN_REVOCATION == 1
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "revocation_load");
+    success = sda_revocation_load();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "revocation_load");
+    if (success != true) {
+        tr_error("Failed loading token revocation list");
+        display_faulty_message("Init. failed");
+        goto out;
+    }
+#endif
+
     // demo setup
+    SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_BOOT, "demo_setup");
     demo_setup();
+    SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_BOOT, "demo_setup");
+
+#if MBED_CONF_APP_BENCHMARK == 1
+    sda_bench_main();
+#endif
 
     tr_cmdline("Secure-Device-Access demo start");
 
     do { // loop forever
 
+        SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_REQUEST, "wait_for_message");
         ftcd_status = comm->wait_for_message(&request, &request_size);
+        SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_REQUEST, "wait_for_message");
         if (ftcd_status != FTCD_COMM_STATUS_SUCCESS) {
             tr_error("Failed receiving Secure-Device-Access message (%u)", ftcd_status);
+            if (comm_recover(comm, ftcd_status)) {
+                continue;
+            }
             display_faulty_message("Bad Request");
             goto out;
         }
@@ -541,11 +904,17 @@ static void demo_main()
             goto out;
         }
 
+        SDA_TRACE_EVENT_BEGIN(SDA_TRACE_EVENT_CAT_REQUEST, "send_response");
         ftcd_status = comm->send_response(response, response_actual_size);
+        SDA_TRACE_EVENT_END(SDA_TRACE_EVENT_CAT_REQUEST, "send_response");
         if (ftcd_status != FTCD_COMM_STATUS_SUCCESS) {
             tr_error("Failed sending Secure-Device-Access response message (%u)", ftcd_status);
-            display_faulty_message("Failed to respond");
             free(request);
+            request = NULL;
+            if (comm_recover(comm, ftcd_status)) {
+                continue;
+            }
+            display_faulty_message("Failed to respond");
             goto out;
         }
 
@@ -574,6 +943,9 @@ out:
     }
 
     // Finalize SDA
+#if MBED_CONF_APP_SDA_SESSION == 1
+    sda_session_close();
+#endif
     sda_status = sda_finalize();
     if (sda_status != SDA_STATUS_SUCCESS) {
         tr_error("Failed finalizing Secure-Device-Access");
@@ -586,6 +958,17 @@ out:
         sda_destroy_comm_interface();
     }
 
+#if MBED_CONF_APP_TRACE_EVENTS == 1
+    // Keep the timeline that led to the failure, unless the host may still be reading frames from stdout
+#if defined(__MBED__)
+#if SDA_TRACE_EVENT_STDOUT_IS_LINK != 1
+    sda_trace_event_dump(stdout);
+#endif
+#else
+    sda_trace_event_write_file(SDA_TRACE_EVENT_FILE);
+#endif
+#endif
+
     // Flush standard output leftovers
     fflush(stdout);
 }
@@ -0,0 +1,103 @@
+#!/bin/sh
+# ----------------------------------------------------------------------------
+# Copyright 2021 ARM Ltd.
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ----------------------------------------------------------------------------
+
+# Builds and runs the host tests of the platform independent parts of the example.
+# They need a host C/C++ compiler only, Mbed OS and the client are replaced by the stubs/ headers.
+# test_atca_emu also needs cryptoauthlib and Mbed TLS, it is skipped without them.
+#
+# usage: test/host/run_host_tests.sh [build directory]
+
+set -e
+
+HOST_DIR=$(cd "$(dirname "$0")" && pwd)
+ROOT_DIR=$(cd "$HOST_DIR/../.." && pwd)
+BUILD_DIR=${1:-$ROOT_DIR/_host_tests}
+CC=${CC:-cc}
+CXX=${CXX:-c++}
+CFLAGS="-Wall -Wextra -Werror -g -I$HOST_DIR/stubs -I$ROOT_DIR/source -I$ROOT_DIR/source/platform/include"
+
+mkdir -p "$BUILD_DIR"
+FAILED=0
+
+# run_test <name> <compiler> <extra flags> <sources...>
+run_test()
+{
+    name=$1
+    compiler=$2
+    flags=$3
+    shift 3
+    echo "=== $name"
+    # shellcheck disable=SC2086
+    if ! $compiler $CFLAGS $flags -o "$BUILD_DIR/$name" "$@"; then
+        echo "=== $name: BUILD FAILED"
+        FAILED=1
+        return
+    fi
+    if ! "$BUILD_DIR/$name"; then
+        echo "=== $name: FAILED"
+        FAILED=1
+    fi
+}
+
+run_test test_atca_write_set "$CC" "-DMBED_CONF_APP_SECURE_ELEMENT_ATCA_SUPPORT" \
+    "$HOST_DIR/test_atca_write_set.c" \
+    "$ROOT_DIR/source/platform/mbed-os/mcc_atca_write_set.c"
+
+run_test test_replay_filter "$CXX" "" \
+    "$HOST_DIR/test_replay_filter.cpp" \
+    "$ROOT_DIR/source/sda_replay.cpp"
+
+run_test test_revocation "$CXX" "" \
+    "$HOST_DIR/test_revocation.cpp" \
+    "$ROOT_DIR/source/sda_revocation.cpp"
+
+run_test test_ring "$CXX" "-pthread" \
+    "$HOST_DIR/test_ring.cpp" \
+    "$ROOT_DIR/source/sda_ring.cpp"
+
+# The ATCA credential path on the emulated ATECC608A needs a cryptoauthlib source tree and an
+# Mbed TLS 2.x tree built with "make lib", e.g.
+#   CRYPTOAUTHLIB_DIR=~/cryptoauthlib MBEDTLS_DIR=~/mbedtls test/host/run_host_tests.sh
+# cryptoauthlib is built with its own CMake files and the custom HAL the emulator plugs into.
+if [ -n "$CRYPTOAUTHLIB_DIR" ] && [ -n "$MBEDTLS_DIR" ]; then
+    CAL_BUILD_DIR=$BUILD_DIR/cryptoauthlib
+    if cmake -S "$CRYPTOAUTHLIB_DIR" -B "$CAL_BUILD_DIR" -DATCA_HAL_CUSTOM=ON -DATCA_TNGTLS_SUPPORT=ON \
+            -DATCA_TNGLORA_SUPPORT=ON -DATCA_BUILD_SHARED_LIBS=OFF > /dev/null &&
+            cmake --build "$CAL_BUILD_DIR" > /dev/null; then
+        # Traces are compiled out on the host, values that are only traced are set but never read
+        run_test test_atca_emu "$CC" "-DMBED_CONF_APP_SECURE_ELEMENT_ATCA_SUPPORT -DMBED_CONF_APP_SECURE_ELEMENT_ATCA_EMULATOR \
+            -Wno-unused-but-set-variable -I$CAL_BUILD_DIR/lib -I$CRYPTOAUTHLIB_DIR/lib -I$CRYPTOAUTHLIB_DIR/lib/atcacert \
+            -I$CRYPTOAUTHLIB_DIR/app/tng -I$MBEDTLS_DIR/include -I$ROOT_DIR/source/platform/secure_element/se_atmel_credentials" \
+            "$HOST_DIR/test_atca_emu.c" \
+            "$ROOT_DIR/source/platform/mbed-os/mcc_atca_credentials_init.c" \
+            "$ROOT_DIR/source/platform/mbed-os/mcc_atca_write_set.c" \
+            "$ROOT_DIR/source/platform/secure_element/mcc_atca_emu.c" \
+            "$ROOT_DIR/source/platform/secure_element/se_atmel_credentials/cust_def_1_signer.c" \
+            "$ROOT_DIR/source/platform/secure_element/se_atmel_credentials/cust_def_2_device.c" \
+            "$CAL_BUILD_DIR/lib/libcryptoauth.a" \
+            "$MBEDTLS_DIR/library/libmbedx509.a" "$MBEDTLS_DIR/library/libmbedcrypto.a" -pthread
+    else
+        echo "=== test_atca_emu: cryptoauthlib BUILD FAILED"
+        FAILED=1
+    fi
+else
+    echo "=== test_atca_emu: skipped, set CRYPTOAUTHLIB_DIR and MBEDTLS_DIR to run it"
+fi
+
+exit $FAILED
@@ -0,0 +1,48 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __HOST_KEY_CONFIG_MANAGER_H__
+#define __HOST_KEY_CONFIG_MANAGER_H__
+
+/* Host test stand-in of the KCM API, only the item calls the revocation list makes.
+The tests implement these on top of an in-memory store.*/
+
+#include "storage_kcm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *kcm_security_desc_s;
+
+kcm_status_e kcm_item_store(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type, bool kcm_item_is_factory,
+                            const uint8_t *kcm_item_data, size_t kcm_item_data_size, const kcm_security_desc_s security_desc);
+
+kcm_status_e kcm_item_get_data_size(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type,
+                                    size_t *kcm_item_data_size_out);
+
+kcm_status_e kcm_item_get_data(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type,
+                               uint8_t *kcm_item_data_out, size_t kcm_item_data_max_size, size_t *kcm_item_data_act_size_out);
+
+kcm_status_e kcm_item_delete(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_KEY_CONFIG_MANAGER_H__
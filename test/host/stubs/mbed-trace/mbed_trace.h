@@ -0,0 +1,35 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __HOST_MBED_TRACE_H__
+#define __HOST_MBED_TRACE_H__
+
+/* Host test stand-in of mbed-trace: traces are compiled out */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define TRACE_ACTIVE_LEVEL_ALL  0x1f
+#define TRACE_ACTIVE_LEVEL_NONE 0x00
+
+#define tr_error(...)   ((void)0)
+#define tr_warn(...)    ((void)0)
+#define tr_info(...)    ((void)0)
+#define tr_debug(...)   ((void)0)
+
+#endif // __HOST_MBED_TRACE_H__
@@ -0,0 +1,30 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __HOST_SDA_STATUS_H__
+#define __HOST_SDA_STATUS_H__
+
+/* Host test stand-in of the SDA library status codes the tested sources return */
+
+typedef enum {
+    SDA_STATUS_SUCCESS = 0,
+    SDA_STATUS_INVALID_REQUEST,
+    SDA_STATUS_OPERATION_EXECUTION_ERROR,
+} sda_status_e;
+
+#endif // __HOST_SDA_STATUS_H__
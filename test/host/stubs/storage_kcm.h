@@ -0,0 +1,85 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __HOST_STORAGE_KCM_H__
+#define __HOST_STORAGE_KCM_H__
+
+/* Host test stand-in of the KCM storage layer, only the calls the ATCA write-set makes.
+The tests implement these on top of an in-memory store that can lose power after any write.*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    KCM_STATUS_SUCCESS = 0,
+    KCM_STATUS_ERROR,
+    KCM_STATUS_INVALID_PARAMETER,
+    KCM_STATUS_FILE_EXIST,
+    KCM_STATUS_ITEM_NOT_FOUND,
+    KCM_STATUS_ITEM_IS_NOT_DELETABLE,
+    KCM_STATUS_STORAGE_ERROR,
+} kcm_status_e;
+
+typedef enum {
+    KCM_PRIVATE_KEY_ITEM,
+    KCM_PUBLIC_KEY_ITEM,
+    KCM_SYMMETRIC_KEY_ITEM,
+    KCM_CERTIFICATE_ITEM,
+    KCM_CONFIG_ITEM,
+} kcm_item_type_e;
+
+typedef enum {
+    STORAGE_ITEM_PREFIX_KCM,
+    STORAGE_ITEM_PREFIX_CE,
+} storage_item_prefix_type_e;
+
+typedef void *kcm_cert_chain_handle;
+
+kcm_status_e storage_item_store(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type, bool kcm_item_is_factory,
+                                storage_item_prefix_type_e item_prefix_type, const uint8_t *kcm_item_data, size_t kcm_item_data_size,
+                                bool is_delete_allowed);
+
+kcm_status_e storage_item_get_data_size(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type,
+                                        storage_item_prefix_type_e item_prefix_type, size_t *kcm_item_data_size_out);
+
+kcm_status_e storage_cert_chain_create(kcm_cert_chain_handle *kcm_chain_handle, const uint8_t *kcm_chain_name, size_t kcm_chain_name_len,
+                                       size_t kcm_chain_len, bool kcm_chain_is_factory, storage_item_prefix_type_e item_prefix_type);
+
+kcm_status_e storage_cert_chain_add_next(kcm_cert_chain_handle kcm_chain_handle, const uint8_t *kcm_cert_data, size_t kcm_cert_data_size,
+                                         storage_item_prefix_type_e item_prefix_type, bool is_delete_allowed);
+
+kcm_status_e storage_cert_chain_open(kcm_cert_chain_handle *kcm_chain_handle, const uint8_t *kcm_chain_name, size_t kcm_chain_name_len,
+                                     storage_item_prefix_type_e item_prefix_type, size_t *kcm_chain_len_out);
+
+kcm_status_e storage_cert_chain_get_next_size(kcm_cert_chain_handle *kcm_chain_handle, storage_item_prefix_type_e item_prefix_type,
+                                              size_t *kcm_cert_data_size);
+
+kcm_status_e storage_cert_chain_close(kcm_cert_chain_handle kcm_chain_handle, storage_item_prefix_type_e item_prefix_type);
+
+kcm_status_e storage_cert_chain_delete(const uint8_t *kcm_chain_name, size_t kcm_chain_name_len, storage_item_prefix_type_e item_prefix_type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HOST_STORAGE_KCM_H__
@@ -0,0 +1,340 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+/* Host run of the ATCA credential path on the emulated ATECC608A. The device certificate chain is
+decompressed through the host cryptoauthlib exactly as on a board, the SE round trips and the time
+they take under the latency model are printed, and the stored chain is checked with Mbed TLS.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "storage_kcm.h"
+#include "fcc_defs.h"
+#include "us_ticker_api.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/oid.h"
+#include "mbedtls/sha256.h"
+#include "mcc_atca_credentials_init.h"
+#include "mcc_atca_write_set.h"
+#include "mcc_atca_emu.h"
+
+/*******************************************************************************
+* Definitions
+******************************************************************************/
+#define STORE_MAX_ITEMS         4
+#define STORE_MAX_NAME_SIZE     64
+#define STORE_MAX_DATA_SIZE     1024
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+/*******************************************************************************
+* Fake storage
+******************************************************************************/
+typedef struct store_item_ {
+    bool used;
+    char name[STORE_MAX_NAME_SIZE];
+    uint8_t data[STORE_MAX_DATA_SIZE];
+    size_t size;
+    size_t chain_len;
+} store_item_s;
+
+typedef struct store_chain_ {
+    char name[STORE_MAX_NAME_SIZE];
+    size_t index;
+    size_t depth;
+} store_chain_s;
+
+const char g_fcc_bootstrap_device_certificate_name[] = "mbed.BootstrapDeviceCert";
+const char g_fcc_endpoint_parameter_name[] = "mbed.EndpointName";
+
+static store_item_s g_store[STORE_MAX_ITEMS];
+static store_chain_s g_chain;
+static store_chain_s g_chain_reader;
+
+static store_item_s *store_find(const char *name)
+{
+    for (size_t i = 0; i < STORE_MAX_ITEMS; i++) {
+        if (g_store[i].used && (strcmp(g_store[i].name, name) == 0)) {
+            return &g_store[i];
+        }
+    }
+    return NULL;
+}
+
+static kcm_status_e store_put(const char *name, const uint8_t *data, size_t size)
+{
+    if (size > STORE_MAX_DATA_SIZE) {
+        return KCM_STATUS_INVALID_PARAMETER;
+    }
+    if (store_find(name) != NULL) {
+        return KCM_STATUS_FILE_EXIST;
+    }
+    for (size_t i = 0; i < STORE_MAX_ITEMS; i++) {
+        if (!g_store[i].used) {
+            g_store[i].used = true;
+            snprintf(g_store[i].name, sizeof(g_store[i].name), "%s", name);
+            memcpy(g_store[i].data, data, size);
+            g_store[i].size = size;
+            g_store[i].chain_len = 0;
+            return KCM_STATUS_SUCCESS;
+        }
+    }
+    return KCM_STATUS_STORAGE_ERROR;
+}
+
+static void store_chain_entry_name(const char *chain_name, size_t index, char *name_out)
+{
+    if (index == 0) {
+        snprintf(name_out, STORE_MAX_NAME_SIZE, "%s", chain_name);
+    } else {
+        snprintf(name_out, STORE_MAX_NAME_SIZE, "%s_%u", chain_name, (unsigned)index);
+    }
+}
+
+static void store_name_copy(const uint8_t *name, size_t name_len, char *name_out)
+{
+    CHECK(name_len < STORE_MAX_NAME_SIZE);
+    memcpy(name_out, name, name_len);
+    name_out[name_len] = '\0';
+}
+
+kcm_status_e storage_item_store(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type, bool kcm_item_is_factory,
+                                storage_item_prefix_type_e item_prefix_type, const uint8_t *kcm_item_data, size_t kcm_item_data_size,
+                                bool is_delete_allowed)
+{
+    char name[STORE_MAX_NAME_SIZE];
+
+    (void)kcm_item_type;
+    (void)kcm_item_is_factory;
+    (void)item_prefix_type;
+    (void)is_delete_allowed;
+    store_name_copy(kcm_item_name, kcm_item_name_len, name);
+    return store_put(name, kcm_item_data, kcm_item_data_size);
+}
+
+kcm_status_e storage_item_get_data_size(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type,
+                                        storage_item_prefix_type_e item_prefix_type, size_t *kcm_item_data_size_out)
+{
+    char name[STORE_MAX_NAME_SIZE];
+    store_item_s *item;
+
+    (void)kcm_item_type;
+    (void)item_prefix_type;
+    store_name_copy(kcm_item_name, kcm_item_name_len, name);
+    item = store_find(name);
+    if (item == NULL) {
+        return KCM_STATUS_ITEM_NOT_FOUND;
+    }
+    *kcm_item_data_size_out = item->size;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_create(kcm_cert_chain_handle *kcm_chain_handle, const uint8_t *kcm_chain_name, size_t kcm_chain_name_len,
+                                       size_t kcm_chain_len, bool kcm_chain_is_factory, storage_item_prefix_type_e item_prefix_type)
+{
+    (void)kcm_chain_is_factory;
+    (void)item_prefix_type;
+    store_name_copy(kcm_chain_name, kcm_chain_name_len, g_chain.name);
+    if (store_find(g_chain.name) != NULL) {
+        return KCM_STATUS_FILE_EXIST;
+    }
+    g_chain.index = 0;
+    g_chain.depth = kcm_chain_len;
+    *kcm_chain_handle = &g_chain;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_add_next(kcm_cert_chain_handle kcm_chain_handle, const uint8_t *kcm_cert_data, size_t kcm_cert_data_size,
+                                         storage_item_prefix_type_e item_prefix_type, bool is_delete_allowed)
+{
+    store_chain_s *chain = (store_chain_s *)kcm_chain_handle;
+    char name[STORE_MAX_NAME_SIZE];
+    kcm_status_e kcm_status;
+
+    (void)item_prefix_type;
+    (void)is_delete_allowed;
+    if (chain->index >= chain->depth) {
+        return KCM_STATUS_INVALID_PARAMETER;
+    }
+    store_chain_entry_name(chain->name, chain->index, name);
+    kcm_status = store_put(name, kcm_cert_data, kcm_cert_data_size);
+    if (kcm_status == KCM_STATUS_SUCCESS) {
+        store_find(name)->chain_len = chain->depth;
+        chain->index++;
+    }
+    return kcm_status;
+}
+
+kcm_status_e storage_cert_chain_open(kcm_cert_chain_handle *kcm_chain_handle, const uint8_t *kcm_chain_name, size_t kcm_chain_name_len,
+                                     storage_item_prefix_type_e item_prefix_type, size_t *kcm_chain_len_out)
+{
+    store_item_s *first;
+
+    (void)item_prefix_type;
+    store_name_copy(kcm_chain_name, kcm_chain_name_len, g_chain_reader.name);
+    first = store_find(g_chain_reader.name);
+    if (first == NULL) {
+        return KCM_STATUS_ITEM_NOT_FOUND;
+    }
+    g_chain_reader.index = 0;
+    g_chain_reader.depth = first->chain_len;
+    *kcm_chain_len_out = first->chain_len;
+    *kcm_chain_handle = &g_chain_reader;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_get_next_size(kcm_cert_chain_handle *kcm_chain_handle, storage_item_prefix_type_e item_prefix_type,
+                                              size_t *kcm_cert_data_size)
+{
+    store_chain_s *chain = (store_chain_s *)*kcm_chain_handle;
+    char name[STORE_MAX_NAME_SIZE];
+    store_item_s *item;
+
+    (void)item_prefix_type;
+    if (chain->index >= chain->depth) {
+        return KCM_STATUS_INVALID_PARAMETER;
+    }
+    store_chain_entry_name(chain->name, chain->index, name);
+    item = store_find(name);
+    if (item == NULL) {
+        return KCM_STATUS_ITEM_NOT_FOUND;
+    }
+    *kcm_cert_data_size = item->size;
+    chain->index++;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_close(kcm_cert_chain_handle kcm_chain_handle, storage_item_prefix_type_e item_prefix_type)
+{
+    (void)kcm_chain_handle;
+    (void)item_prefix_type;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_delete(const uint8_t *kcm_chain_name, size_t kcm_chain_name_len, storage_item_prefix_type_e item_prefix_type)
+{
+    char chain_name[STORE_MAX_NAME_SIZE], name[STORE_MAX_NAME_SIZE];
+    bool found = false;
+
+    (void)item_prefix_type;
+    store_name_copy(kcm_chain_name, kcm_chain_name_len, chain_name);
+    for (size_t i = 0; i < STORE_MAX_ITEMS; i++) {
+        store_item_s *item;
+
+        store_chain_entry_name(chain_name, i, name);
+        item = store_find(name);
+        if (item != NULL) {
+            item->used = false;
+            found = true;
+        }
+    }
+    return found ? KCM_STATUS_SUCCESS : KCM_STATUS_ITEM_NOT_FOUND;
+}
+
+/*******************************************************************************
+* Test
+******************************************************************************/
+static const store_item_s *chain_entry_get(size_t index)
+{
+    char name[STORE_MAX_NAME_SIZE];
+    const store_item_s *item;
+
+    store_chain_entry_name(g_fcc_bootstrap_device_certificate_name, index, name);
+    item = store_find(name);
+    CHECK(item != NULL);
+    return item;
+}
+
+/*The stored device certificate is signed by the stored signer certificate, the endpoint name is its CN*/
+static void check_stored_chain(void)
+{
+    const store_item_s *device_item = chain_entry_get(0);
+    const store_item_s *signer_item = chain_entry_get(1);
+    const store_item_s *endpoint_item = store_find(g_fcc_endpoint_parameter_name);
+    const mbedtls_x509_name *name;
+    mbedtls_x509_crt device, signer;
+    uint8_t tbs_digest[32];
+    bool cn_found = false;
+
+    CHECK(endpoint_item != NULL);
+    CHECK(device_item->chain_len == MCC_ATCA_SIGNER_CHAIN_DEPTH);
+
+    mbedtls_x509_crt_init(&device);
+    mbedtls_x509_crt_init(&signer);
+    CHECK(mbedtls_x509_crt_parse_der(&device, device_item->data, device_item->size) == 0);
+    CHECK(mbedtls_x509_crt_parse_der(&signer, signer_item->data, signer_item->size) == 0);
+
+    CHECK(mbedtls_sha256_ret(device.tbs.p, device.tbs.len, tbs_digest, 0) == 0);
+    CHECK(mbedtls_pk_verify(&signer.pk, MBEDTLS_MD_SHA256, tbs_digest, sizeof(tbs_digest), device.sig.p, device.sig.len) == 0);
+
+    for (name = &device.subject; name != NULL; name = name->next) {
+        if (MBEDTLS_OID_CMP(MBEDTLS_OID_AT_CN, &name->oid) == 0) {
+            CHECK(name->val.len == endpoint_item->size);
+            CHECK(memcmp(name->val.p, endpoint_item->data, endpoint_item->size) == 0);
+            cn_found = true;
+        }
+    }
+    CHECK(cn_found);
+
+    mbedtls_x509_crt_free(&signer);
+    mbedtls_x509_crt_free(&device);
+}
+
+static void test_first_boot(void)
+{
+    mcc_atca_emu_stats_s stats;
+    uint32_t start_us;
+
+    memset(g_store, 0, sizeof(g_store));
+
+    start_us = us_ticker_read();
+    CHECK(mcc_atca_credentials_init() == 0);
+    printf("first boot: credential path took %u us\n", (unsigned)(us_ticker_read() - start_us));
+
+    mcc_atca_emu_stats_get(&stats);
+    CHECK(stats.round_trips > 0);
+    CHECK(stats.genkey_commands > 0);
+    check_stored_chain();
+}
+
+/*A committed chain is used as is, the SE is not touched*/
+static void test_next_boot(void)
+{
+    mcc_atca_emu_stats_s stats;
+
+    mcc_atca_emu_stats_reset();
+    CHECK(mcc_atca_credentials_init() == 0);
+
+    mcc_atca_emu_stats_get(&stats);
+    CHECK(stats.round_trips == 0);
+    CHECK(stats.wakes == 0);
+    check_stored_chain();
+}
+
+int main(void)
+{
+    test_first_boot();
+    test_next_boot();
+    printf("test_atca_emu: OK\n");
+    return 0;
+}
@@ -0,0 +1,451 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+/* Host test of the ATCA first boot write-set: power is cut after every possible storage write of a
+commit, and of the rollback that follows it, then the device boots again. Every boot sequence has
+to end with the complete certificate chain and the endpoint name in the storage.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "storage_kcm.h"
+#include "fcc_defs.h"
+#include "mcc_atca_write_set.h"
+
+/*******************************************************************************
+* Definitions
+******************************************************************************/
+#define STORE_MAX_ITEMS         8
+#define STORE_MAX_NAME_SIZE     64
+#define STORE_MAX_DATA_SIZE     64
+/*Writes of one complete commit on an empty store: two chain entries and the endpoint name*/
+#define COMMIT_WRITES           3
+/*Writes of a commit that finds the endpoint name already stored*/
+#define CHAIN_WRITES            2
+/*No power cut*/
+#define BUDGET_UNLIMITED        (-1)
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+/*******************************************************************************
+* Fake storage
+******************************************************************************/
+typedef struct store_item_ {
+    bool used;
+    bool deletable;
+    char name[STORE_MAX_NAME_SIZE];
+    uint8_t data[STORE_MAX_DATA_SIZE];
+    size_t size;
+    // Chain length, kept with the first certificate of a chain like KCM does
+    size_t chain_len;
+} store_item_s;
+
+typedef struct store_chain_ {
+    char name[STORE_MAX_NAME_SIZE];
+    size_t index;
+    size_t depth;
+} store_chain_s;
+
+const char g_fcc_bootstrap_device_certificate_name[] = "mbed.BootstrapDeviceCert";
+const char g_fcc_endpoint_parameter_name[] = "mbed.EndpointName";
+
+static store_item_s g_store[STORE_MAX_ITEMS];
+static store_chain_s g_chain;
+static store_chain_s g_chain_reader;
+// Writes left before the power is cut, BUDGET_UNLIMITED for none
+static int g_write_budget = BUDGET_UNLIMITED;
+static bool g_power_lost = false;
+static int g_writes = 0;
+
+static store_item_s *store_find(const char *name)
+{
+    for (size_t i = 0; i < STORE_MAX_ITEMS; i++) {
+        if (g_store[i].used && (strcmp(g_store[i].name, name) == 0)) {
+            return &g_store[i];
+        }
+    }
+    return NULL;
+}
+
+/*Accounts one flash write, false once the power is gone*/
+static bool store_write_begin(void)
+{
+    if (g_power_lost) {
+        return false;
+    }
+    if (g_write_budget == 0) {
+        g_power_lost = true;
+        return false;
+    }
+    if (g_write_budget > 0) {
+        g_write_budget--;
+    }
+    g_writes++;
+    return true;
+}
+
+static kcm_status_e store_put(const char *name, const uint8_t *data, size_t size, bool deletable)
+{
+    if (size > STORE_MAX_DATA_SIZE) {
+        return KCM_STATUS_INVALID_PARAMETER;
+    }
+    if (store_find(name) != NULL) {
+        return KCM_STATUS_FILE_EXIST;
+    }
+    if (!store_write_begin()) {
+        return KCM_STATUS_STORAGE_ERROR;
+    }
+    for (size_t i = 0; i < STORE_MAX_ITEMS; i++) {
+        if (!g_store[i].used) {
+            g_store[i].used = true;
+            g_store[i].deletable = deletable;
+            snprintf(g_store[i].name, sizeof(g_store[i].name), "%s", name);
+            memcpy(g_store[i].data, data, size);
+            g_store[i].size = size;
+            return KCM_STATUS_SUCCESS;
+        }
+    }
+    return KCM_STATUS_STORAGE_ERROR;
+}
+
+static void store_chain_entry_name(const char *chain_name, size_t index, char *name_out)
+{
+    if (index == 0) {
+        snprintf(name_out, STORE_MAX_NAME_SIZE, "%s", chain_name);
+    } else {
+        snprintf(name_out, STORE_MAX_NAME_SIZE, "%s_%u", chain_name, (unsigned)index);
+    }
+}
+
+static void store_name_copy(const uint8_t *name, size_t name_len, char *name_out)
+{
+    CHECK(name_len < STORE_MAX_NAME_SIZE);
+    memcpy(name_out, name, name_len);
+    name_out[name_len] = '\0';
+}
+
+kcm_status_e storage_item_store(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type, bool kcm_item_is_factory,
+                                storage_item_prefix_type_e item_prefix_type, const uint8_t *kcm_item_data, size_t kcm_item_data_size,
+                                bool is_delete_allowed)
+{
+    char name[STORE_MAX_NAME_SIZE];
+
+    (void)kcm_item_type;
+    (void)kcm_item_is_factory;
+    (void)item_prefix_type;
+    store_name_copy(kcm_item_name, kcm_item_name_len, name);
+    return store_put(name, kcm_item_data, kcm_item_data_size, is_delete_allowed);
+}
+
+kcm_status_e storage_item_get_data_size(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type,
+                                        storage_item_prefix_type_e item_prefix_type, size_t *kcm_item_data_size_out)
+{
+    char name[STORE_MAX_NAME_SIZE];
+    store_item_s *item;
+
+    (void)kcm_item_type;
+    (void)item_prefix_type;
+    if (g_power_lost) {
+        return KCM_STATUS_STORAGE_ERROR;
+    }
+    store_name_copy(kcm_item_name, kcm_item_name_len, name);
+    item = store_find(name);
+    if (item == NULL) {
+        return KCM_STATUS_ITEM_NOT_FOUND;
+    }
+    *kcm_item_data_size_out = item->size;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_create(kcm_cert_chain_handle *kcm_chain_handle, const uint8_t *kcm_chain_name, size_t kcm_chain_name_len,
+                                       size_t kcm_chain_len, bool kcm_chain_is_factory, storage_item_prefix_type_e item_prefix_type)
+{
+    (void)kcm_chain_is_factory;
+    (void)item_prefix_type;
+    if (g_power_lost) {
+        return KCM_STATUS_STORAGE_ERROR;
+    }
+    store_name_copy(kcm_chain_name, kcm_chain_name_len, g_chain.name);
+    // Like KCM, an existing chain is not overwritten
+    if (store_find(g_chain.name) != NULL) {
+        return KCM_STATUS_FILE_EXIST;
+    }
+    g_chain.index = 0;
+    g_chain.depth = kcm_chain_len;
+    *kcm_chain_handle = &g_chain;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_add_next(kcm_cert_chain_handle kcm_chain_handle, const uint8_t *kcm_cert_data, size_t kcm_cert_data_size,
+                                         storage_item_prefix_type_e item_prefix_type, bool is_delete_allowed)
+{
+    store_chain_s *chain = (store_chain_s *)kcm_chain_handle;
+    char name[STORE_MAX_NAME_SIZE];
+    kcm_status_e kcm_status;
+
+    (void)item_prefix_type;
+    if (chain->index >= chain->depth) {
+        return KCM_STATUS_INVALID_PARAMETER;
+    }
+    store_chain_entry_name(chain->name, chain->index, name);
+    kcm_status = store_put(name, kcm_cert_data, kcm_cert_data_size, is_delete_allowed);
+    if (kcm_status == KCM_STATUS_SUCCESS) {
+        store_find(name)->chain_len = chain->depth;
+        chain->index++;
+    }
+    return kcm_status;
+}
+
+kcm_status_e storage_cert_chain_open(kcm_cert_chain_handle *kcm_chain_handle, const uint8_t *kcm_chain_name, size_t kcm_chain_name_len,
+                                     storage_item_prefix_type_e item_prefix_type, size_t *kcm_chain_len_out)
+{
+    store_item_s *first;
+
+    (void)item_prefix_type;
+    if (g_power_lost) {
+        return KCM_STATUS_STORAGE_ERROR;
+    }
+    store_name_copy(kcm_chain_name, kcm_chain_name_len, g_chain_reader.name);
+    first = store_find(g_chain_reader.name);
+    if (first == NULL) {
+        return KCM_STATUS_ITEM_NOT_FOUND;
+    }
+    g_chain_reader.index = 0;
+    g_chain_reader.depth = first->chain_len;
+    *kcm_chain_len_out = first->chain_len;
+    *kcm_chain_handle = &g_chain_reader;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_get_next_size(kcm_cert_chain_handle *kcm_chain_handle, storage_item_prefix_type_e item_prefix_type,
+                                              size_t *kcm_cert_data_size)
+{
+    store_chain_s *chain = (store_chain_s *)*kcm_chain_handle;
+    char name[STORE_MAX_NAME_SIZE];
+    store_item_s *item;
+
+    (void)item_prefix_type;
+    if (chain->index >= chain->depth) {
+        return KCM_STATUS_INVALID_PARAMETER;
+    }
+    store_chain_entry_name(chain->name, chain->index, name);
+    item = store_find(name);
+    if (item == NULL) {
+        return KCM_STATUS_ITEM_NOT_FOUND;
+    }
+    *kcm_cert_data_size = item->size;
+    chain->index++;
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_close(kcm_cert_chain_handle kcm_chain_handle, storage_item_prefix_type_e item_prefix_type)
+{
+    (void)kcm_chain_handle;
+    (void)item_prefix_type;
+    return g_power_lost ? KCM_STATUS_STORAGE_ERROR : KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e storage_cert_chain_delete(const uint8_t *kcm_chain_name, size_t kcm_chain_name_len, storage_item_prefix_type_e item_prefix_type)
+{
+    char chain_name[STORE_MAX_NAME_SIZE], name[STORE_MAX_NAME_SIZE];
+    bool found = false;
+
+    (void)item_prefix_type;
+    store_name_copy(kcm_chain_name, kcm_chain_name_len, chain_name);
+    for (size_t i = 0; i < STORE_MAX_ITEMS; i++) {
+        store_item_s *item;
+
+        store_chain_entry_name(chain_name, i, name);
+        item = store_find(name);
+        if (item == NULL) {
+            continue;
+        }
+        found = true;
+        if (!item->deletable) {
+            return KCM_STATUS_ITEM_IS_NOT_DELETABLE;
+        }
+        if (!store_write_begin()) {
+            return KCM_STATUS_STORAGE_ERROR;
+        }
+        item->used = false;
+    }
+    return found ? KCM_STATUS_SUCCESS : KCM_STATUS_ITEM_NOT_FOUND;
+}
+
+/*******************************************************************************
+* Test
+******************************************************************************/
+static const uint8_t g_device_certificate[] = "device certificate";
+static const uint8_t g_signer_certificate[] = "signer certificate";
+static const uint8_t g_endpoint_name[] = "0123456789abcdef";
+
+static void store_reset(void)
+{
+    memset(g_store, 0, sizeof(g_store));
+    g_power_lost = false;
+    g_write_budget = BUDGET_UNLIMITED;
+}
+
+/*Powers the device up with the given write budget*/
+static void power_up(int write_budget)
+{
+    g_power_lost = false;
+    g_write_budget = write_budget;
+    g_writes = 0;
+}
+
+/*The storage part of mcc_decompress_device_cert_chain()*/
+static int boot(void)
+{
+    mcc_atca_write_set_s write_set = { 0 };
+
+    if (mcc_atca_write_set_is_committed()) {
+        return 0;
+    }
+    write_set.device_certificate = g_device_certificate;
+    write_set.device_certificate_size = sizeof(g_device_certificate);
+    write_set.signer_certificate = g_signer_certificate;
+    write_set.signer_certificate_size = sizeof(g_signer_certificate);
+    write_set.endpoint_name = g_endpoint_name;
+    write_set.endpoint_name_size = sizeof(g_endpoint_name);
+    return mcc_atca_write_set_commit(&write_set);
+}
+
+static void check_item(const char *name, const uint8_t *data, size_t size)
+{
+    store_item_s *item = store_find(name);
+
+    CHECK(item != NULL);
+    CHECK(item->size == size);
+    CHECK(memcmp(item->data, data, size) == 0);
+}
+
+/*The complete write-set and nothing else*/
+static void check_committed(void)
+{
+    char name[STORE_MAX_NAME_SIZE];
+    size_t used = 0;
+
+    store_chain_entry_name(g_fcc_bootstrap_device_certificate_name, 0, name);
+    check_item(name, g_device_certificate, sizeof(g_device_certificate));
+    store_chain_entry_name(g_fcc_bootstrap_device_certificate_name, 1, name);
+    check_item(name, g_signer_certificate, sizeof(g_signer_certificate));
+    check_item(g_fcc_endpoint_parameter_name, g_endpoint_name, sizeof(g_endpoint_name));
+    CHECK(!store_find(g_fcc_endpoint_parameter_name)->deletable);
+    for (size_t i = 0; i < STORE_MAX_ITEMS; i++) {
+        used += g_store[i].used ? 1 : 0;
+    }
+    CHECK(used == MCC_ATCA_SIGNER_CHAIN_DEPTH + 1);
+}
+
+static void test_clean_boot(void)
+{
+    store_reset();
+    power_up(BUDGET_UNLIMITED);
+    CHECK(!mcc_atca_write_set_is_committed());
+    CHECK(boot() == 0);
+    CHECK(g_writes == COMMIT_WRITES);
+    check_committed();
+
+    // The next boot finds the commit record and writes nothing
+    power_up(BUDGET_UNLIMITED);
+    CHECK(boot() == 0);
+    CHECK(g_writes == 0);
+    check_committed();
+}
+
+static void test_interrupted_commit(void)
+{
+    int runs = 0;
+
+    // Cut the power after every write of the first boot, and after every write of the second boot
+    // that rolls the leftovers back, then boot once more with stable power
+    for (int first = 0; first < COMMIT_WRITES; first++) {
+        for (int second = 0; second <= 2 * COMMIT_WRITES; second++) {
+            store_reset();
+
+            power_up(first);
+            CHECK(boot() != 0);
+            CHECK(!mcc_atca_write_set_is_committed() || g_power_lost);
+
+            power_up(second);
+            (void)boot();
+
+            power_up(BUDGET_UNLIMITED);
+            CHECK(boot() == 0);
+            check_committed();
+
+            power_up(BUDGET_UNLIMITED);
+            CHECK(boot() == 0);
+            CHECK(g_writes == 0);
+            runs++;
+        }
+    }
+    printf("interrupted commit: %d power cut sequences recovered\n", runs);
+}
+
+/*The chain stays deletable after the commit, a later boot has to notice it is gone*/
+static void test_deleted_chain(void)
+{
+    char name[STORE_MAX_NAME_SIZE];
+
+    for (size_t deleted = 0; deleted <= MCC_ATCA_SIGNER_CHAIN_DEPTH; deleted++) {
+        store_reset();
+        power_up(BUDGET_UNLIMITED);
+        CHECK(boot() == 0);
+
+        if (deleted == MCC_ATCA_SIGNER_CHAIN_DEPTH) {
+            // The whole chain
+            CHECK(storage_cert_chain_delete((const uint8_t *)g_fcc_bootstrap_device_certificate_name,
+                                            strlen(g_fcc_bootstrap_device_certificate_name), STORAGE_ITEM_PREFIX_KCM) == KCM_STATUS_SUCCESS);
+        } else {
+            store_chain_entry_name(g_fcc_bootstrap_device_certificate_name, deleted, name);
+            store_find(name)->used = false;
+        }
+        CHECK(!mcc_atca_write_set_is_committed());
+
+        // Cut the power during the rewrite as well
+        for (int budget = 0; budget < CHAIN_WRITES; budget++) {
+            power_up(budget);
+            CHECK(boot() != 0);
+        }
+
+        power_up(BUDGET_UNLIMITED);
+        CHECK(boot() == 0);
+        check_committed();
+
+        power_up(BUDGET_UNLIMITED);
+        CHECK(boot() == 0);
+        CHECK(g_writes == 0);
+    }
+    printf("deleted chain: rewritten from the SE\n");
+}
+
+int main(void)
+{
+    test_clean_boot();
+    test_interrupted_commit();
+    test_deleted_chain();
+    printf("test_atca_write_set: OK\n");
+    return 0;
+}
@@ -0,0 +1,139 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+/* Host test of the replay filter. Digests are picked so that their buckets and the buckets their
+fingerprints move to all lie in buckets 0 to 3: those 16 slots fill up long before the generation is
+half full, and the cuckoo insertion runs out of kicks. Every request recorded since the previous
+generation started has to be found after every insert, including the fingerprint left in hand when
+the kicks run out.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sda_replay.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TEST_FILTER_ROUNDS      64
+#define TEST_FILTER_INSERTS     256
+/*Buckets the digests are picked from*/
+#define TEST_FILTER_GROUP_MASK  0x3
+/*Same partial-key step as replay_filter_alt_bucket()*/
+#define TEST_FILTER_ALT_STEP    0x9E3779B1UL
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+//////////////////////////////////////////////////////////
+
+// Deterministic digests (xorshift64) whose two buckets are both in the group
+static uint64_t test_filter_next_digest(uint64_t *state)
+{
+    for (;;) {
+        uint64_t digest;
+        uint32_t fingerprint, step;
+
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+        digest = *state;
+
+        fingerprint = (uint32_t)(digest >> 32);
+        step = (uint32_t)(fingerprint * TEST_FILTER_ALT_STEP) & (SDA_REPLAY_FILTER_BUCKETS - 1);
+        if ((fingerprint != 0) && ((digest & (SDA_REPLAY_FILTER_BUCKETS - 1)) <= TEST_FILTER_GROUP_MASK) &&
+                (step != 0) && (step <= TEST_FILTER_GROUP_MASK)) {
+            return digest;
+        }
+    }
+}
+
+static void test_filter_kicks(void)
+{
+    static uint64_t digests[TEST_FILTER_INSERTS];
+    uint32_t kick_rotations = 0;
+
+    for (uint32_t round = 1; round <= TEST_FILTER_ROUNDS; round++) {
+        sda_replay_filter_s filter;
+        uint64_t state = 0x5DA0000000000000ULL + round;
+        // First insert of the previous generation, everything recorded from there on is remembered
+        size_t previous_start = 0, current_start = 0;
+
+        sda_replay_filter_init(&filter, round);
+
+        for (size_t i = 0; i < TEST_FILTER_INSERTS; i++) {
+            uint8_t current = filter.current;
+            uint16_t count = filter.generations[current].count;
+
+            digests[i] = test_filter_next_digest(&state);
+            if (sda_replay_filter_contains(&filter, digests[i])) {
+                // Fingerprint collision, the request would be rejected and not recorded
+                digests[i] = digests[previous_start];
+                continue;
+            }
+
+            sda_replay_filter_insert(&filter, digests[i]);
+
+            if (filter.current != current) {
+                previous_start = current_start;
+                current_start = i;
+                // A rotation before the current generation is half full ran out of kicks. The request
+                // went to the generation that is now the previous one, only the last victim moved on
+                if (count < (SDA_REPLAY_FILTER_BUCKETS * SDA_REPLAY_FILTER_SLOTS / 2)) {
+                    kick_rotations++;
+                    current_start = i + 1;
+                }
+            }
+
+            for (size_t j = previous_start; j <= i; j++) {
+                if (!sda_replay_filter_contains(&filter, digests[j])) {
+                    printf("round %u: request %u not found after inserting request %u\n", (unsigned)round, (unsigned)j, (unsigned)i);
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    printf("replay filter: %u inserts ran out of kicks\n", (unsigned)kick_rotations);
+    CHECK(kick_rotations > 0);
+}
+
+static void test_window(void)
+{
+    sda_replay_window_s window;
+
+    sda_replay_window_init(&window);
+    CHECK(sda_replay_window_accept(&window, 100));
+    CHECK(!sda_replay_window_accept(&window, 100));
+    CHECK(sda_replay_window_accept(&window, 98));
+    CHECK(sda_replay_window_accept(&window, 100 + SDA_REPLAY_WINDOW_SIZE));
+    CHECK(!sda_replay_window_accept(&window, 100));
+    CHECK(sda_replay_window_accept(&window, 101));
+    CHECK(!sda_replay_window_accept(&window, 101));
+}
+
+int main(void)
+{
+    test_window();
+    test_filter_kicks();
+    printf("test_replay_filter: OK\n");
+    return 0;
+}
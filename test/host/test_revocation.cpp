@@ -0,0 +1,208 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+/* Host test of the revocation check of a request. The request carries a byte string shaped like
+an untagged COSE_Sign1 ahead of the tagged access token: revoking the token has to reject the
+request whichever candidate comes first, and so has revoking any other candidate. A request
+without a candidate, or one that cannot be decoded, is rejected as well.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "sda_revocation.h"
+#include "key_config_manager.h"
+#include "mbedtls/sha256.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+typedef std::vector<uint8_t> bytes_t;
+
+///////////////////////// GLOBALS /////////////////////////
+
+static std::map<std::string, bytes_t> g_test_store;
+
+// Tagged COSE_Sign1: 18([h'A10126', {}, h'C0FFEE', h'5167'])
+static const bytes_t g_test_token = { 0xD2, 0x84, 0x43, 0xA1, 0x01, 0x26, 0xA0, 0x43, 0xC0, 0xFF, 0xEE, 0x42, 0x51, 0x67 };
+
+// Untagged COSE_Sign1 shape: [h'', {}, h'', h'']
+static const bytes_t g_test_decoy = { 0x84, 0x40, 0xA0, 0x40, 0x40 };
+
+//////////////////////////////////////////////////////////
+
+// Any digest the list and the check agree on will do, FNV-1a spread over 32 bytes
+int mbedtls_sha256_ret(const unsigned char *input, size_t ilen, unsigned char output[32], int is224)
+{
+    (void)is224;
+    for (size_t chunk = 0; chunk < 4; chunk++) {
+        uint64_t hash = 0xCBF29CE484222325ULL ^ chunk;
+
+        for (size_t i = 0; i < ilen; i++) {
+            hash = (hash ^ input[i]) * 0x100000001B3ULL;
+        }
+        for (size_t i = 0; i < 8; i++) {
+            output[(chunk * 8) + i] = (uint8_t)(hash >> (56 - (i * 8)));
+        }
+    }
+    return 0;
+}
+
+kcm_status_e kcm_item_store(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type, bool kcm_item_is_factory,
+                            const uint8_t *kcm_item_data, size_t kcm_item_data_size, const kcm_security_desc_s security_desc)
+{
+    std::string name((const char *)kcm_item_name, kcm_item_name_len);
+
+    (void)kcm_item_type;
+    (void)kcm_item_is_factory;
+    (void)security_desc;
+    if (g_test_store.count(name) != 0) {
+        return KCM_STATUS_FILE_EXIST;
+    }
+    g_test_store[name] = bytes_t(kcm_item_data, kcm_item_data + kcm_item_data_size);
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e kcm_item_get_data_size(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type,
+                                    size_t *kcm_item_data_size_out)
+{
+    std::map<std::string, bytes_t>::const_iterator item = g_test_store.find(std::string((const char *)kcm_item_name, kcm_item_name_len));
+
+    (void)kcm_item_type;
+    if (item == g_test_store.end()) {
+        return KCM_STATUS_ITEM_NOT_FOUND;
+    }
+    *kcm_item_data_size_out = item->second.size();
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e kcm_item_get_data(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type,
+                               uint8_t *kcm_item_data_out, size_t kcm_item_data_max_size, size_t *kcm_item_data_act_size_out)
+{
+    std::map<std::string, bytes_t>::const_iterator item = g_test_store.find(std::string((const char *)kcm_item_name, kcm_item_name_len));
+
+    (void)kcm_item_type;
+    if (item == g_test_store.end()) {
+        return KCM_STATUS_ITEM_NOT_FOUND;
+    }
+    if (item->second.size() > kcm_item_data_max_size) {
+        return KCM_STATUS_INVALID_PARAMETER;
+    }
+    memcpy(kcm_item_data_out, item->second.data(), item->second.size());
+    *kcm_item_data_act_size_out = item->second.size();
+    return KCM_STATUS_SUCCESS;
+}
+
+kcm_status_e kcm_item_delete(const uint8_t *kcm_item_name, size_t kcm_item_name_len, kcm_item_type_e kcm_item_type)
+{
+    (void)kcm_item_type;
+    return (g_test_store.erase(std::string((const char *)kcm_item_name, kcm_item_name_len)) != 0) ? KCM_STATUS_SUCCESS : KCM_STATUS_ITEM_NOT_FOUND;
+}
+
+static bytes_t test_revocation_bstr(const bytes_t &content)
+{
+    bytes_t item = { (uint8_t)(0x40 | content.size()) };
+
+    CHECK(content.size() < 24);
+    item.insert(item.end(), content.begin(), content.end());
+    return item;
+}
+
+// An SDA-like request: [1, <items>...]
+static bytes_t test_revocation_request(const std::vector<bytes_t> &items)
+{
+    bytes_t request = { (uint8_t)(0x80 | (items.size() + 1)), 0x01 };
+
+    for (size_t i = 0; i < items.size(); i++) {
+        request.insert(request.end(), items[i].begin(), items[i].end());
+    }
+    return request;
+}
+
+// Replaces the list with one holding the hashes of the given candidates
+static void test_revocation_revoke(uint32_t version, const std::vector<bytes_t> &tokens)
+{
+    std::vector<bytes_t> hashes;
+    bytes_t list = { (uint8_t)(version >> 24), (uint8_t)(version >> 16), (uint8_t)(version >> 8), (uint8_t)version };
+
+    for (size_t i = 0; i < tokens.size(); i++) {
+        bytes_t hash(SDA_REVOCATION_TOKEN_HASH_SIZE);
+
+        CHECK(sda_revocation_token_hash(tokens[i].data(), tokens[i].size(), hash.data()));
+        hashes.push_back(hash);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    for (size_t i = 0; i < hashes.size(); i++) {
+        list.insert(list.end(), hashes[i].begin(), hashes[i].end());
+    }
+
+    CHECK(sda_revocation_update(list.data(), list.size()) == SDA_STATUS_SUCCESS);
+}
+
+static bool test_revocation_check(const bytes_t &request)
+{
+    return sda_revocation_request_is_revoked(request.data(), request.size());
+}
+
+int main(void)
+{
+    bytes_t untagged_token(g_test_token.begin() + 1, g_test_token.end());
+    bytes_t decoy_first = test_revocation_request({ test_revocation_bstr(g_test_decoy), g_test_token });
+    bytes_t wrapped = test_revocation_request({ test_revocation_bstr(untagged_token) });
+    bytes_t truncated(decoy_first.begin(), decoy_first.end() - 1);
+
+    CHECK(sda_revocation_load());
+    CHECK(!test_revocation_check(decoy_first));
+    CHECK(!test_revocation_check(wrapped));
+
+    // Without candidates, or undecodable, the token cannot be checked
+    CHECK(test_revocation_check(test_revocation_request({ test_revocation_bstr({ 0x01, 0x02 }) })));
+    CHECK(test_revocation_check(truncated));
+
+    // The tagged token is revoked, the decoy ahead of it must not hide it
+    test_revocation_revoke(1, { g_test_token });
+    CHECK(test_revocation_check(decoy_first));
+    CHECK(!test_revocation_check(wrapped));
+
+    // Revoking a candidate anywhere in the request rejects it
+    test_revocation_revoke(2, { g_test_decoy });
+    CHECK(test_revocation_check(decoy_first));
+    CHECK(!test_revocation_check(test_revocation_request({ g_test_token })));
+
+    test_revocation_revoke(3, { untagged_token });
+    CHECK(test_revocation_check(wrapped));
+
+    // The list survives a reboot
+    CHECK(sda_revocation_load());
+    CHECK(sda_revocation_version() == 3);
+    CHECK(test_revocation_check(wrapped));
+    CHECK(!test_revocation_check(decoy_first));
+
+    printf("revocation: decoy candidates checked\n");
+    printf("test_revocation: OK\n");
+    return 0;
+}
@@ -0,0 +1,228 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+/* Host test of the serial transport ring: wrap-around and overflow accounting, a producer thread
+racing the consumer the way the UART interrupt does, and the incremental token scan against a
+plain search for every way a stream can be split across pushes.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include "sda_ring.h"
+
+/////////////////////// DEFINITIONS ///////////////////////
+
+#define TEST_RING_SIZE          64
+#define TEST_STREAM_SIZE        (1024 * 1024)
+#define TEST_SCAN_STREAMS       2000
+#define TEST_SCAN_STREAM_SIZE   48
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+//////////////////////////////////////////////////////////
+
+// Deterministic byte source (xorshift32)
+static uint32_t test_rand(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void test_ring_wrap(void)
+{
+    uint8_t buffer[TEST_RING_SIZE];
+    uint8_t data[TEST_RING_SIZE + 8];
+    uint8_t out[TEST_RING_SIZE + 8];
+    sda_ring_s ring;
+
+    CHECK(!sda_ring_init(&ring, buffer, 48));
+    CHECK(sda_ring_init(&ring, buffer, sizeof(buffer)));
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+
+    // Move head and tail close to the end of the buffer, then push across it
+    CHECK(sda_ring_push(&ring, data, TEST_RING_SIZE - 3) == TEST_RING_SIZE - 3);
+    CHECK(sda_ring_read(&ring, out, TEST_RING_SIZE - 3) == TEST_RING_SIZE - 3);
+    CHECK(sda_ring_push(&ring, data, 10) == 10);
+    CHECK(sda_ring_count(&ring) == 10);
+    CHECK(sda_ring_read(&ring, out, sizeof(out)) == 10);
+    CHECK(memcmp(out, data, 10) == 0);
+
+    // Overflow: what fits is kept, the rest is counted
+    CHECK(sda_ring_push(&ring, data, sizeof(data)) == TEST_RING_SIZE);
+    CHECK(ring.dropped == sizeof(data) - TEST_RING_SIZE);
+    CHECK(sda_ring_push(&ring, data, 1) == 0);
+    CHECK(sda_ring_read(&ring, out, sizeof(out)) == TEST_RING_SIZE);
+    CHECK(memcmp(out, data, TEST_RING_SIZE) == 0);
+    CHECK(sda_ring_count(&ring) == 0);
+}
+
+// One thread pushes a numbered stream in random spans, the other reads it in random spans
+static void test_ring_threads(void)
+{
+    static uint8_t buffer[TEST_RING_SIZE];
+    sda_ring_s ring;
+    size_t received = 0;
+
+    CHECK(sda_ring_init(&ring, buffer, sizeof(buffer)));
+
+    std::thread producer([&ring]() {
+        uint32_t state = 0x5DA01;
+        uint8_t span[TEST_RING_SIZE];
+        size_t sent = 0;
+
+        while (sent < TEST_STREAM_SIZE) {
+            size_t span_size = std::min((size_t)(test_rand(&state) % 24) + 1, (size_t)TEST_STREAM_SIZE - sent);
+
+            // Like the UART FIFO drain, only push what fits so nothing is dropped
+            if ((TEST_RING_SIZE - sda_ring_count(&ring)) < span_size) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (size_t i = 0; i < span_size; i++) {
+                span[i] = (uint8_t)((sent + i) * 31);
+            }
+            sent += sda_ring_push(&ring, span, span_size);
+        }
+    });
+
+    uint32_t state = 0x5DA02;
+    while (received < TEST_STREAM_SIZE) {
+        uint8_t span[TEST_RING_SIZE];
+        size_t span_size = sda_ring_read(&ring, span, (test_rand(&state) % 24) + 1);
+
+        for (size_t i = 0; i < span_size; i++) {
+            if (span[i] != (uint8_t)((received + i) * 31)) {
+                printf("stream byte %u corrupted\n", (unsigned)(received + i));
+                exit(1);
+            }
+        }
+        received += span_size;
+        if (span_size == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    CHECK(ring.dropped == 0);
+    CHECK(sda_ring_count(&ring) == 0);
+}
+
+// Scans a stream pushed in spans of span_size and checks where the token scan stopped
+static void test_scan_stream(const uint8_t *stream, size_t stream_size, const uint8_t *token, size_t token_size, size_t span_size)
+{
+    uint8_t buffer[TEST_RING_SIZE];
+    sda_ring_s ring;
+    sda_ring_token_scan_s scan;
+    const uint8_t *match = std::search(stream, stream + stream_size, token, token + token_size);
+    size_t expected_end = (match == stream + stream_size) ? 0 : (size_t)(match - stream) + token_size;
+    size_t pushed = 0;
+    bool found = false;
+
+    CHECK(sda_ring_init(&ring, buffer, sizeof(buffer)));
+    sda_ring_token_scan_init(&scan, token, token_size);
+
+    while ((pushed < stream_size) && !found) {
+        size_t size = std::min(span_size, stream_size - pushed);
+
+        CHECK(sda_ring_push(&ring, stream + pushed, size) == size);
+        pushed += size;
+        found = sda_ring_token_scan(&ring, &scan);
+    }
+
+    if (expected_end == 0) {
+        CHECK(!found);
+        CHECK(scan.consumed == stream_size);
+        return;
+    }
+    CHECK(found);
+    // Exactly the bytes up to the end of the first occurrence were consumed, the rest is left
+    CHECK(scan.consumed == expected_end);
+    CHECK(sda_ring_count(&ring) == pushed - expected_end);
+    CHECK(sda_ring_token_scan(&ring, &scan));
+}
+
+static void test_token_scan(void)
+{
+    // Self-overlapping tokens exercise the rematch after a partial match
+    static const char *const tokens[] = { "mbed.sda", "aab", "abab", "aaaa", "abcabd" };
+    uint32_t state = 0x5DA03;
+    uint8_t stream[TEST_SCAN_STREAM_SIZE];
+
+    for (size_t t = 0; t < sizeof(tokens) / sizeof(tokens[0]); t++) {
+        const uint8_t *token = (const uint8_t *)tokens[t];
+        size_t token_size = strlen(tokens[t]);
+
+        for (size_t n = 0; n < TEST_SCAN_STREAMS; n++) {
+            // Bytes from the token alphabet plus one other, so partial matches are frequent
+            for (size_t i = 0; i < sizeof(stream); i++) {
+                uint32_t pick = test_rand(&state) % (token_size + 1);
+                stream[i] = (pick < token_size) ? token[pick] : (uint8_t)'x';
+            }
+            for (size_t span_size = 1; span_size <= token_size + 1; span_size++) {
+                test_scan_stream(stream, sizeof(stream), token, token_size, span_size);
+            }
+        }
+    }
+}
+
+// Several tokens over the same bytes, the first to complete wins
+static void test_tokens_scan(void)
+{
+    static const uint8_t stream[] = "xxsda-linkxxmbed.sda";
+    static const uint8_t header[] = "mbed.sda";
+    static const uint8_t link[] = "sda-link";
+    uint8_t buffer[TEST_RING_SIZE];
+    sda_ring_s ring;
+    sda_ring_token_scan_s scans[2];
+
+    CHECK(sda_ring_init(&ring, buffer, sizeof(buffer)));
+    CHECK(sda_ring_push(&ring, stream, sizeof(stream) - 1) == sizeof(stream) - 1);
+
+    sda_ring_token_scan_init(&scans[0], header, sizeof(header) - 1);
+    sda_ring_token_scan_init(&scans[1], link, sizeof(link) - 1);
+    CHECK(sda_ring_tokens_scan(&ring, scans, 2) == 1);
+    CHECK(sda_ring_count(&ring) == 10);
+
+    sda_ring_token_scan_init(&scans[0], header, sizeof(header) - 1);
+    sda_ring_token_scan_init(&scans[1], link, sizeof(link) - 1);
+    CHECK(sda_ring_tokens_scan(&ring, scans, 2) == 0);
+    CHECK(sda_ring_count(&ring) == 0);
+    CHECK(sda_ring_tokens_scan(&ring, scans, 2) == -1);
+}
+
+int main(void)
+{
+    test_ring_wrap();
+    test_ring_threads();
+    test_token_scan();
+    test_tokens_scan();
+    printf("test_ring: OK\n");
+    return 0;
+}